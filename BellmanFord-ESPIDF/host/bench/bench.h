@@ -0,0 +1,28 @@
+#pragma once
+// bench.h — kontrol backend host untuk lora_bench (satu node, tanpa simulator).
+#include <cstdint>
+#include <cstddef>
+
+namespace bench {
+
+// jam node (esp_timer_get_time); hanya maju lewat advance()/vTaskDelay()
+void     setTimeUs(int64_t t);
+void     advanceUs(int64_t us);
+
+// MAC yang dibaca firmware lewat esp_read_mac()
+void     setMac(const uint8_t mac[6]);
+
+// Frame berikutnya untuk sx1276_wait_packet()/sx1276_rx_view(): disalin ke
+// buffer RX backend (cermin slot pool driver) dan dikembalikan sekali.
+void     setRx(const uint8_t* data, size_t len, int rssi, int snr_x4 = 40);
+
+// frame yang dikirim firmware sejak resetTx() (sx1276_end_packet)
+struct TxCapture {
+    uint64_t frames;
+    uint64_t bytes;
+    uint64_t airtime_us;
+};
+void      resetTx();
+TxCapture tx();
+
+} // namespace bench
@@ -0,0 +1,186 @@
+// bench_backend.cpp — implementasi host untuk API yang dipanggil firmware
+// (driver sx1276_* dan shim ESP-IDF) dalam lora_bench: satu node, radio
+// palsu yang menangkap frame TX dan menyuapkan frame RX yang sudah disiapkan.
+
+#include "bench.h"
+#include "lora_sx1276.h"
+#include "lora_airtime.h"
+
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+int64_t  g_now_us = 0;
+uint8_t  g_mac[6] = { 0x02, 0x4C, 0x52, 0x00, 0x00, 0x00 };
+uint32_t g_rng = 0x12345678u;
+
+// radio
+uint8_t  g_txbuf[256];
+size_t   g_txlen = 0;
+uint8_t  g_txdr = 0;
+bench::TxCapture g_tx{};
+
+uint8_t  g_rxbuf[256];
+size_t   g_rxlen = 0;
+int      g_rxrssi = 0, g_rxsnr = 0;
+bool     g_rxready = false;   // setRx() belum diambil wait_packet()
+bool     g_rxheld = false;    // paket sedang dipegang aplikasi
+size_t   g_rxidx = 0;
+
+const LoraModemConfig& modem() {
+    static const LoraModemConfig cfg = loraModemConfigForDr(0);
+    return cfg;
+}
+
+} // namespace
+
+namespace bench {
+
+void setTimeUs(int64_t t)   { g_now_us = t; }
+void advanceUs(int64_t us)  { g_now_us += us; }
+void setMac(const uint8_t mac[6]) { std::memcpy(g_mac, mac, 6); }
+
+void setRx(const uint8_t* data, size_t len, int rssi, int snr_x4) {
+    if (len > sizeof(g_rxbuf)) len = sizeof(g_rxbuf);
+    std::memcpy(g_rxbuf, data, len);
+    g_rxlen   = len;
+    g_rxrssi  = rssi;
+    g_rxsnr   = snr_x4;
+    g_rxready = true;
+}
+
+void resetTx()   { g_tx = TxCapture{}; }
+TxCapture tx()   { return g_tx; }
+
+} // namespace bench
+
+// ====== Driver SX1276 palsu ======
+bool sx1276_begin() {
+    return true;
+}
+
+void sx1276_begin_packet(uint8_t dr, TxPrio) {
+    g_txdr  = dr;
+    g_txlen = 0;
+}
+
+void sx1276_write(const char* data, size_t len) {
+    if (!data || len == 0) return;
+    size_t space = sizeof(g_txbuf) - g_txlen;
+    if (len > space) len = space;
+    std::memcpy(&g_txbuf[g_txlen], data, len);
+    g_txlen += len;
+}
+
+bool sx1276_end_packet() {
+    if (g_txlen == 0) return false;
+    g_tx.frames++;
+    g_tx.bytes += g_txlen;
+    g_tx.airtime_us += loraTimeOnAirUs(loraModemConfigForDr(g_txdr), g_txlen);
+    return true;
+}
+
+void sx1276_on_tx_done(sx1276_tx_done_cb_t, void*) {}
+
+uint32_t sx1276_tx_room(TxPrio prio) {
+    return sx1276_tx_depth(prio);   // antrean selalu kosong
+}
+
+uint32_t sx1276_tx_free(TxPrio prio) {
+    return sx1276_tx_depth(prio);
+}
+
+uint32_t sx1276_tx_pending() {
+    return 0;   // frame dianggap langsung terkirim
+}
+
+int sx1276_wait_packet(uint32_t) {
+    g_rxheld = false;
+    if (!g_rxready) return 0;
+    g_rxready = false;
+    g_rxheld  = true;
+    g_rxidx   = 0;
+    return (int)g_rxlen;
+}
+
+int sx1276_parse_packet() {
+    return sx1276_wait_packet(0);
+}
+
+Sx1276RxView sx1276_rx_view() {
+    Sx1276RxView v{};
+    if (!g_rxheld) return v;
+    v.data    = g_rxbuf;
+    v.len     = g_rxlen;
+    v.rssi    = g_rxrssi;
+    v.snr_x4  = g_rxsnr;
+    v.time_us = g_now_us;
+    return v;
+}
+
+int sx1276_read_byte() {
+    if (!g_rxheld || g_rxidx >= g_rxlen) return -1;
+    return g_rxbuf[g_rxidx++];
+}
+
+int sx1276_packet_rssi() {
+    return g_rxheld ? g_rxrssi : -127;
+}
+
+int64_t sx1276_packet_time_us() {
+    return g_now_us;
+}
+
+uint32_t sx1276_rx_dropped() {
+    return 0;
+}
+
+const LoraModemConfig& sx1276_modem_config() {
+    return modem();
+}
+
+// ====== Shim ESP-IDF ======
+extern "C" {
+
+esp_log_level_t esp_log_host_level = ESP_LOG_NONE;
+
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...) {
+    static const char letters[] = "NEWIDV";
+    char msg[512];
+    va_list ap;
+    va_start(ap, format);
+    std::vsnprintf(msg, sizeof(msg), format, ap);
+    va_end(ap);
+    std::fprintf(stderr, "%c (%s) %s\n", letters[level], tag, msg);
+}
+
+int64_t esp_timer_get_time(void) {
+    return g_now_us;
+}
+
+esp_err_t esp_read_mac(uint8_t* mac, esp_mac_type_t) {
+    std::memcpy(mac, g_mac, 6);
+    return ESP_OK;
+}
+
+uint32_t esp_random(void) {
+    // xorshift32: deterministik, hasil benchmark bisa diulang
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    g_now_us += (int64_t)ticks * 1000;
+}
+
+} // extern "C"
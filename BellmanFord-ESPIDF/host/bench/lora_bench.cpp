@@ -0,0 +1,487 @@
+// lora_bench.cpp — benchmark hot path routing di host (satu node).
+//
+// Firmware (LoRaRouting.cpp, distance_vector.cpp, node.cpp, ...) di-link
+// apa adanya dengan backend radio palsu (bench_backend.cpp). Tiap kasus
+// diukur ns/op (putaran tercepat dari beberapa), alokasi heap/op (operator
+// new dihitung) dan, untuk iklan routing, byte + airtime di udara.
+//
+// Contoh:
+//   lora_bench
+//   lora_bench --json bench.json               # satu hasil per baris, mudah di-diff
+//   lora_bench --baseline old.json             # bandingkan dengan rilis sebelumnya
+//   lora_bench --filter rx_ --min-ms 300
+
+#include "bench.h"
+
+#include "LoRaRouting.h"
+#include "node.h"
+#include "node_registry.h"
+#include "routing_wire.h"
+#include "lora_airtime.h"
+#include "lora_frag.h"
+#include "airtime_scheduler.h"
+#include "lora_sx1276.h"
+#include "spsc_ring.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ====== Penghitung alokasi heap ======
+static uint64_t g_allocs = 0;
+static uint64_t g_alloc_bytes = 0;
+
+void* operator new(size_t n) {
+    g_allocs++;
+    g_alloc_bytes += n;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t n) { return operator new(n); }
+void  operator delete(void* p) noexcept { std::free(p); }
+void  operator delete[](void* p) noexcept { std::free(p); }
+void  operator delete(void* p, size_t) noexcept { std::free(p); }
+void  operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+// ====== Pengukuran ======
+struct Result {
+    std::string name;
+    int         n;
+    double      ns_per_op;
+    double      allocs_per_op;
+    double      alloc_bytes_per_op;
+};
+
+struct AirResult {
+    int      n;
+    size_t   text_bytes, text_frames;   double text_ms;
+    size_t   v1_bytes,   v1_frames;     double v1_ms;
+    size_t   full_bytes, full_frames;   double full_ms;
+    size_t   delta_bytes;               double delta_ms;
+};
+
+static double             g_min_ms = 100.0;   // waktu ukur minimum per kasus
+static std::string        g_filter;
+static std::vector<Result> g_results;
+static volatile uint64_t  g_sink = 0;         // cegah hasil dioptimasi habis
+
+using Clock = std::chrono::steady_clock;
+
+template <class F>
+static double runOps(F& op, uint64_t iters, uint64_t& counter) {
+    auto t0 = Clock::now();
+    for (uint64_t i = 0; i < iters; i++) op(counter++);
+    return std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+}
+
+// op(i) dipanggil berulang; i naik terus (untuk frame bernomor urut, dsb.)
+template <class F>
+static void measure(const char* name, int n, F op) {
+    if (!g_filter.empty() && std::strstr(name, g_filter.c_str()) == nullptr) return;
+
+    constexpr int ROUNDS = 5;
+    uint64_t counter = 0;
+    uint64_t iters = 1;
+    // kalibrasi (sekaligus warm-up): satu putaran >= min_ms / ROUNDS
+    const double target_ns = g_min_ms * 1e6 / ROUNDS;
+    while (runOps(op, iters, counter) < target_ns && iters < (1ull << 40)) iters *= 2;
+
+    double best = std::numeric_limits<double>::max();
+    uint64_t allocs = 0, bytes = 0;
+    for (int r = 0; r < ROUNDS; r++) {
+        uint64_t a0 = g_allocs, b0 = g_alloc_bytes;
+        best   = std::min(best, runOps(op, iters, counter) / (double)iters);
+        allocs = g_allocs - a0;
+        bytes  = g_alloc_bytes - b0;
+    }
+    g_results.push_back({ name, n, best, (double)allocs / iters, (double)bytes / iters });
+}
+
+// ====== Frame sintetis ======
+static void macOf(int id, uint8_t mac[6]) {
+    const uint8_t m[6] = { 0x02, 0x4C, 0x52, 0x00, (uint8_t)(id >> 8), (uint8_t)id };
+    std::memcpy(mac, m, 6);
+}
+
+static std::string macText(int id) {
+    uint8_t m[6];
+    macOf(id, m);
+    return macToString(m);
+}
+
+static std::string helloFrame(int id) {
+    return "Hello from NODE_" + std::to_string(id) + " " + WIRE_HELLO_CAP + " MAC: " + macText(id);
+}
+
+// tujuan [first, first + n) lewat tetangga sender
+static std::string textAdvert(int sender, int first, int n) {
+    std::string m = "ROUTINGID|" + std::to_string(sender) + "|";
+    for (int d = first; d < first + n; d++) {
+        m += std::to_string(d) + ",-90," + std::to_string(100 + d * 3 + sender * 5) + "," +
+             std::to_string(d) + "|";
+    }
+    return m;
+}
+
+struct Frame {
+    std::vector<uint8_t> bytes;
+    int rssi;
+};
+
+static Frame v2Frame(uint8_t type, int sender, uint16_t seq, int first, int n, int costBias) {
+    Frame f{ std::vector<uint8_t>(WIRE_MAX_FRAME_LEN), -75 };
+    uint8_t flags = type == WIRE_TYPE_ROUTING_FULL ? (WIRE_FLAG_FIRST | WIRE_FLAG_LAST) : 0;
+    size_t len = wireEncodeRoutingHeaderV2(f.bytes.data(), f.bytes.size(), type, sender,
+                                           seq, (uint16_t)(seq - 1), flags);
+    for (int d = first; d < first + n; d++) {
+        WireRouteEntry e{ d, d, 120 + d * 2 + costBias, -95 };
+        len += wireEncodeRouteEntry(f.bytes.data() + len, f.bytes.size() - len, e);
+    }
+    f.bytes.resize(len);
+    return f;
+}
+
+static void setV2Seq(Frame& f, uint16_t seq) {
+    uint16_t base = (uint16_t)(seq - 1);
+    f.bytes[2] = (uint8_t)seq;  f.bytes[3] = (uint8_t)(seq >> 8);
+    f.bytes[4] = (uint8_t)base; f.bytes[5] = (uint8_t)(base >> 8);
+}
+
+static Frame dataFrame(int src, int dst, size_t payload) {
+    Frame f{ std::vector<uint8_t>(WIRE_DATA_HDR_LEN + payload, 0x5A), -80 };
+    wireEncodeDataHeader(f.bytes.data(), f.bytes.size(), src, dst, NODE_ID, (uint8_t)DATA_TTL, 1);
+    return f;
+}
+
+static Frame textFrame(const std::string& s, int rssi) {
+    return Frame{ std::vector<uint8_t>(s.begin(), s.end()), rssi };
+}
+
+// satu iterasi task routing: paket masuk antrean -> LoRa_ParsePacket -> onDataRecv
+static void receive(const Frame& f) {
+    bench::setRx(f.bytes.data(), f.bytes.size(), f.rssi);
+    int len = LoRa_ParsePacket();
+    onDataRecv(len);
+}
+
+// ====== Skenario ======
+// Node 0 = kita. Tetangga 1 & 2 mengiklankan tujuan [DEST0, DEST0 + n) dalam
+// teks ROUTINGID; tetangga 3 bicara v2 (full/delta) untuk sebagian tujuan.
+static constexpr int NBR_V2 = 3;
+static constexpr int DEST0  = 4;
+static const int     kSizes[] = { 8, 32, 128, 250 };
+
+static uint16_t g_v2seq = 1000;
+
+static void buildTable(int n) {
+    receive(textFrame(helloFrame(1), -70));
+    receive(textFrame(helloFrame(2), -82));
+    receive(textFrame(helloFrame(NBR_V2), -75));
+    parseAndUpdateRoutingTableId(textAdvert(1, DEST0, n), -70);
+    parseAndUpdateRoutingTableId(textAdvert(2, DEST0, n), -82);
+    runBellmanFord();
+}
+
+static size_t maxFrameLen() {
+    size_t dwell = loraMaxPayloadForAirtime(sx1276_modem_config(), (uint32_t)AIRTIME_MAX_DWELL_MS * 1000u);
+    return std::min(dwell, WIRE_MAX_FRAME_LEN);
+}
+
+// byte / frame / airtime datagram len setelah fragmentasi; frames = 0 bila
+// datagram melebihi FRAG_MAX_DATAGRAM (tidak bisa dikirim sama sekali)
+static void airOf(size_t len, size_t& bytes, size_t& frames, double& ms) {
+    const LoraModemConfig& m = sx1276_modem_config();
+    size_t maxFrame = maxFrameLen();
+    if (len <= maxFrame) {
+        bytes = len; frames = 1; ms = loraTimeOnAirUs(m, len) / 1e3;
+        return;
+    }
+    frames = fragCount(len, maxFrame);
+    if (frames == 0) {
+        bytes = len; ms = 0;
+        return;
+    }
+    size_t chunk = maxFrame - WIRE_FRAG_HDR_LEN;
+    bytes = len + frames * WIRE_FRAG_HDR_LEN;
+    ms = ((frames - 1) * loraTimeOnAirUs(m, maxFrame) +
+          loraTimeOnAirUs(m, WIRE_FRAG_HDR_LEN + len - (frames - 1) * chunk)) / 1e3;
+}
+
+static AirResult measureAir(int n) {
+    AirResult a{};
+    a.n = n;
+    airOf(serializeRoutingTableWithSenderId(-1).size(), a.text_bytes, a.text_frames, a.text_ms);
+
+    // v1 biner & v2 penuh lewat jalur kirim firmware yang sebenarnya
+    bench::resetTx();
+    sendRoutingTableToId(5);
+    bench::TxCapture t = bench::tx();
+    a.v1_bytes = t.bytes; a.v1_frames = t.frames; a.v1_ms = t.airtime_us / 1e3;
+
+    bench::resetTx();
+    sendRoutingTableId();
+    t = bench::tx();
+    a.full_bytes = t.bytes; a.full_frames = t.frames; a.full_ms = t.airtime_us / 1e3;
+
+    // delta untuk satu rute yang berubah
+    a.delta_bytes = WIRE_ROUTING_V2_HDR_LEN + WIRE_ROUTING_ENTRY_LEN;
+    a.delta_ms = loraTimeOnAirUs(sx1276_modem_config(), a.delta_bytes) / 1e3;
+    return a;
+}
+
+static void benchRegistry() {
+    std::vector<std::string> texts;
+    std::vector<std::array<uint8_t, 6>> macs;
+    for (int id = 0; id < NODE_REGISTRY_MAX; id++) {
+        texts.push_back(macText(id));
+        std::array<uint8_t, 6> m;
+        macOf(id, m.data());
+        macs.push_back(m);
+    }
+    const int count = (int)texts.size();
+    measure("mac_to_node_id_str", count, [&](uint64_t i) {
+        g_sink += macToNodeId(texts[i % count]);
+    });
+    measure("mac_to_node_id_bytes", count, [&](uint64_t i) {
+        g_sink += macToNodeId(macs[i % count].data());
+    });
+}
+
+// Pola ring RX driver / pipeline.h di dua pthread: thread "radio" mengisi
+// slot kosong dan mendorong indeksnya ke ring siap, thread utama ("routing")
+// mengambil, membaca payload, lalu mengembalikan slot. ns/op = satu paket
+// melintasi dua core (termasuk kembalinya slot).
+static void benchSpsc() {
+    constexpr int SLOTS = LORA_RX_QUEUE_LEN + 1;   // RX_POOL_LEN driver
+    using Ring = SpscRing<uint8_t, spscCapacityFor(SLOTS)>;
+    static Ring ready, freeSlots;
+    static std::array<std::array<uint8_t, 256>, SLOTS> pool;
+    for (int i = 0; i < SLOTS; i++) freeSlots.push((uint8_t)i);
+
+    std::atomic<bool> stop{false};
+    std::thread radio([&]() {
+        uint8_t slot;
+        uint32_t seq = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (!freeSlots.pop(slot)) { std::this_thread::yield(); continue; }
+            pool[slot][0] = (uint8_t)seq++;
+            ready.push(slot);
+        }
+    });
+    measure("spsc_pipeline", SLOTS, [&](uint64_t) {
+        uint8_t slot;
+        while (!ready.pop(slot)) std::this_thread::yield();
+        g_sink += pool[slot][0];
+        freeSlots.push(slot);
+    });
+    stop.store(true, std::memory_order_relaxed);
+    radio.join();
+}
+
+static void benchTable(int n) {
+    std::string adv1 = textAdvert(1, DEST0, n);
+    measure("serialize_text", n, [&](uint64_t) {
+        g_sink += serializeRoutingTableWithSenderId(-1).size();
+    });
+    static uint8_t buf[FRAG_MAX_DATAGRAM];
+    measure("serialize_bin", n, [&](uint64_t) {
+        g_sink += serializeRoutingTableBin(buf, sizeof(buf), -1);
+    });
+    measure("parse_text", n, [&](uint64_t) {
+        parseAndUpdateRoutingTableId(adv1, -70);
+    });
+    measure("bellman_ford", n, [&](uint64_t) {
+        runBellmanFord();
+    });
+
+    // ---- onDataRecv per jenis frame ----
+    const int v2n = std::min<int>(n, (int)WIRE_V2_MAX_ENTRIES);
+    Frame hello = textFrame(helloFrame(1), -70);
+    Frame full  = v2Frame(WIRE_TYPE_ROUTING_FULL, NBR_V2, ++g_v2seq, DEST0, v2n, 0);
+    Frame delta[2] = { v2Frame(WIRE_TYPE_ROUTING_DELTA, NBR_V2, 0, DEST0, 1, 0),
+                       v2Frame(WIRE_TYPE_ROUTING_DELTA, NBR_V2, 0, DEST0, 1, 40) };
+    Frame local = dataFrame(5, NODE_ID, 20);
+    Frame relay = dataFrame(5, DEST0 + n - 1, 20);
+    receive(full);   // tetangga v2 sinkron
+
+    measure("rx_hello", n, [&](uint64_t) { receive(hello); });
+    measure("rx_v2_delta", n, [&](uint64_t i) {
+        Frame& f = delta[i & 1];             // biaya rute bolak-balik: rekomputasi nyata
+        setV2Seq(f, ++g_v2seq);
+        receive(f);
+    });
+    measure("rx_v2_full", v2n, [&](uint64_t) {
+        setV2Seq(full, ++g_v2seq);
+        receive(full);
+    });
+    measure("rx_data_local", n, [&](uint64_t) { receive(local); });
+    measure("rx_data_relay", n, [&](uint64_t) { receive(relay); });
+
+    // campuran kira-kira sesuai lalu lintas mesh: 3 hello, 3 delta, 1 full, 1 data
+    measure("rx_mix", n, [&](uint64_t i) {
+        switch (i & 7) {
+            case 0: case 3: case 6: receive(hello); break;
+            case 1: case 4: case 7: {
+                Frame& f = delta[(i >> 3) & 1];
+                setV2Seq(f, ++g_v2seq);
+                receive(f);
+                break;
+            }
+            case 2: setV2Seq(full, ++g_v2seq); receive(full); break;
+            default: receive((i >> 3) & 1 ? relay : local); break;
+        }
+    });
+}
+
+// ====== Baseline (--json sebelumnya) ======
+struct Baseline {
+    std::string name;
+    int         n;
+    double      ns_per_op;
+    double      allocs_per_op;
+};
+
+static std::vector<Baseline> loadBaseline(const char* path) {
+    std::vector<Baseline> out;
+    FILE* f = std::fopen(path, "r");
+    if (!f) { std::perror(path); return out; }
+    char line[512];
+    while (std::fgets(line, sizeof(line), f)) {
+        char name[64];
+        Baseline b;
+        if (std::sscanf(line, " { \"name\": \"%63[^\"]\", \"n\": %d, \"ns_per_op\": %lf, \"allocs_per_op\": %lf",
+                        name, &b.n, &b.ns_per_op, &b.allocs_per_op) == 4) {
+            b.name = name;
+            out.push_back(b);
+        }
+    }
+    std::fclose(f);
+    return out;
+}
+
+static const Baseline* findBaseline(const std::vector<Baseline>& base, const Result& r) {
+    for (const Baseline& b : base) {
+        if (b.name == r.name && b.n == r.n) return &b;
+    }
+    return nullptr;
+}
+
+// ====== Laporan ======
+static void report(const std::vector<AirResult>& air, const std::vector<Baseline>& base) {
+    const LoraModemConfig& m = sx1276_modem_config();
+    std::printf("lora_bench: SF%d BW%u, ROUTING_MAX_NODES=%d, max frame %u B\n\n",
+                m.sf, (unsigned)m.bw_hz, ROUTING_MAX_NODES, (unsigned)maxFrameLen());
+    std::printf("%-22s %5s %12s %10s %12s%s\n", "case", "n", "ns/op", "allocs/op", "alloc B/op",
+                base.empty() ? "" : "   vs baseline");
+    for (const Result& r : g_results) {
+        std::printf("%-22s %5d %12.1f %10.2f %12.1f", r.name.c_str(), r.n, r.ns_per_op,
+                    r.allocs_per_op, r.alloc_bytes_per_op);
+        if (const Baseline* b = base.empty() ? nullptr : findBaseline(base, r)) {
+            std::printf("   %+6.1f%% ns  %+.2f allocs", 100.0 * (r.ns_per_op / b->ns_per_op - 1.0),
+                        r.allocs_per_op - b->allocs_per_op);
+        }
+        std::printf("\n");
+    }
+
+    std::printf("\n%-6s %22s %22s %22s %16s\n", "routes", "text ROUTINGID", "binary v1",
+                "v2 full advert", "v2 delta (1)");
+    for (const AirResult& a : air) {
+        std::printf("%6d %6zu B %2zu fr %6.1f ms %6zu B %2zu fr %6.1f ms %6zu B %2zu fr %6.1f ms %5zu B %6.1f ms\n",
+                    a.n, a.text_bytes, a.text_frames, a.text_ms, a.v1_bytes, a.v1_frames, a.v1_ms,
+                    a.full_bytes, a.full_frames, a.full_ms, a.delta_bytes, a.delta_ms);
+    }
+}
+
+static bool writeJson(const char* path, const std::vector<AirResult>& air) {
+    FILE* f = std::fopen(path, "w");
+    if (!f) { std::perror(path); return false; }
+    const LoraModemConfig& m = sx1276_modem_config();
+    std::fprintf(f, "{\n  \"bench\": \"lora_bench\",\n  \"version\": 1,\n  \"sf\": %d,\n  \"bw_hz\": %u,\n"
+                    "  \"routing_max_nodes\": %d,\n  \"results\": [",
+                 m.sf, (unsigned)m.bw_hz, ROUTING_MAX_NODES);
+    for (size_t i = 0; i < g_results.size(); i++) {
+        const Result& r = g_results[i];
+        std::fprintf(f, "%s\n    { \"name\": \"%s\", \"n\": %d, \"ns_per_op\": %.1f, \"allocs_per_op\": %.2f, "
+                        "\"alloc_bytes_per_op\": %.1f }",
+                     i ? "," : "", r.name.c_str(), r.n, r.ns_per_op, r.allocs_per_op, r.alloc_bytes_per_op);
+    }
+    std::fprintf(f, "\n  ],\n  \"air\": [");
+    for (size_t i = 0; i < air.size(); i++) {
+        const AirResult& a = air[i];
+        std::fprintf(f, "%s\n    { \"routes\": %d, \"text_bytes\": %zu, \"text_frames\": %zu, \"text_ms\": %.1f, "
+                        "\"v1_bytes\": %zu, \"v1_frames\": %zu, \"v1_ms\": %.1f, "
+                        "\"v2_full_bytes\": %zu, \"v2_full_frames\": %zu, \"v2_full_ms\": %.1f, "
+                        "\"v2_delta1_bytes\": %zu, \"v2_delta1_ms\": %.1f }",
+                     i ? "," : "", a.n, a.text_bytes, a.text_frames, a.text_ms, a.v1_bytes, a.v1_frames,
+                     a.v1_ms, a.full_bytes, a.full_frames, a.full_ms, a.delta_bytes, a.delta_ms);
+    }
+    std::fprintf(f, "\n  ]\n}\n");
+    std::fclose(f);
+    return true;
+}
+
+static void usage(const char* prog) {
+    std::printf(
+        "usage: %s [options]\n"
+        "  --min-ms MS        waktu ukur minimum per kasus (default 100)\n"
+        "  --filter TEXT      hanya kasus yang namanya memuat TEXT\n"
+        "  --json FILE        tulis hasil dalam format JSON\n"
+        "  --baseline FILE    bandingkan dengan JSON dari run sebelumnya\n",
+        prog);
+}
+
+int main(int argc, char** argv) {
+    const char* json = nullptr;
+    const char* baseline = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) { std::fprintf(stderr, "missing value for %s\n", a.c_str()); std::exit(2); }
+            return argv[++i];
+        };
+        if      (a == "--min-ms")   g_min_ms = std::atof(next());
+        else if (a == "--filter")   g_filter = next();
+        else if (a == "--json")     json = next();
+        else if (a == "--baseline") baseline = next();
+        else { usage(argv[0]); return a == "--help" || a == "-h" ? 0 : 2; }
+    }
+    if (g_min_ms <= 0) { usage(argv[0]); return 2; }
+
+    // node 0 dengan registry sintetis penuh
+    registryClear();
+    for (int id = 0; id < NODE_REGISTRY_MAX; id++) {
+        uint8_t mac[6];
+        macOf(id, mac);
+        registrySet(id, mac);
+    }
+    uint8_t self[6];
+    macOf(0, self);
+    bench::setMac(self);
+    bench::setTimeUs(1000000);
+    NODE_ID = 0;
+    initLoRa();
+
+    benchRegistry();
+    benchSpsc();
+    std::vector<AirResult> air;
+    for (int n : kSizes) {
+        buildTable(n);
+        air.push_back(measureAir(n));
+        benchTable(n);
+    }
+
+    std::vector<Baseline> base;
+    if (baseline) base = loadBaseline(baseline);
+    report(air, base);
+    if (json && !writeJson(json, air)) return 1;
+    return 0;
+}
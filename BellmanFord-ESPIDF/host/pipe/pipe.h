@@ -0,0 +1,22 @@
+#pragma once
+// pipe.h — kontrol backend host untuk lora_pipe (satu node, task routing dan
+// aplikasi dari pipeline.cpp berjalan di pthread).
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace pipe {
+
+// Peran task radio: salin frame ke slot pool RX lalu antrekan ke ring yang
+// sama dengan driver (SpscNotifyRing, membangunkan sx1276_wait_packet).
+// Hanya dari satu thread. false = semua slot masih dipegang firmware.
+bool inject(const uint8_t* data, size_t len, int rssi, int snr_x4 = 40);
+
+// Frame TX berikutnya (urutan sx1276_end_packet); false = timeout.
+bool waitTx(std::vector<uint8_t>& out, uint32_t timeoutMs);
+
+// true: sx1276_end_packet menahan task pemanggil (task routing) sampai
+// holdTx(false), seolah antrean TX driver macet
+void holdTx(bool hold);
+
+} // namespace pipe
@@ -0,0 +1,236 @@
+// pipe_backend.cpp — implementasi host untuk API yang dipanggil firmware
+// (driver sx1276_* dan shim ESP-IDF) dalam lora_pipe. Berbeda dengan
+// bench_backend, jam adalah jam dinding dan RX memakai pool slot + ring
+// SPSC + notifikasi task persis seperti lora_sx1276.cpp, jadi task routing
+// benar-benar tidur di sx1276_wait_packet dan dibangunkan thread lain.
+
+#include "pipe.h"
+#include "lora_sx1276.h"
+#include "lora_airtime.h"
+#include "spsc_notify.h"
+
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+const Clock::time_point g_boot = Clock::now();
+
+std::mutex g_rng_mu;
+uint32_t   g_rng = 0x12345678u;
+
+// ====== RX: cermin pool + ring driver ======
+struct RxPacket {
+    int16_t  rssi;
+    int8_t   snr_x4;
+    uint16_t len;
+    int64_t  time_us;
+    uint8_t  data[256];
+};
+
+constexpr int RX_POOL_LEN = LORA_RX_QUEUE_LEN + 1;
+RxPacket g_rx_pool[RX_POOL_LEN];
+SpscNotifyRing<uint8_t, spscCapacityFor(RX_POOL_LEN)> g_rx_ready;   // radio -> routing
+SpscRing<uint8_t, spscCapacityFor(RX_POOL_LEN)>       g_rx_free;    // routing -> radio
+int    g_rx_cur = -1;
+size_t g_rx_idx = 0;
+
+struct RxInit {
+    RxInit() { for (int i = 0; i < RX_POOL_LEN; i++) g_rx_free.push((uint8_t)i); }
+} g_rx_init;
+
+// ====== TX: frame tersusun -> daftar untuk harness ======
+uint8_t g_txbuf[256];   // hanya task routing
+size_t  g_txlen = 0;
+
+std::mutex                        g_tx_mu;
+std::condition_variable           g_tx_cv;
+std::deque<std::vector<uint8_t>>  g_tx_out;
+bool                              g_tx_hold = false;
+
+const LoraModemConfig& modem() {
+    static const LoraModemConfig cfg = loraModemConfigForDr(0);
+    return cfg;
+}
+
+} // namespace
+
+namespace pipe {
+
+bool inject(const uint8_t* data, size_t len, int rssi, int snr_x4) {
+    uint8_t slot;
+    if (!g_rx_free.pop(slot)) return false;
+    RxPacket& p = g_rx_pool[slot];
+    if (len > sizeof(p.data)) len = sizeof(p.data);
+    std::memcpy(p.data, data, len);
+    p.len     = (uint16_t)len;
+    p.rssi    = (int16_t)rssi;
+    p.snr_x4  = (int8_t)snr_x4;
+    p.time_us = esp_timer_get_time();
+    g_rx_ready.push(slot);
+    return true;
+}
+
+bool waitTx(std::vector<uint8_t>& out, uint32_t timeoutMs) {
+    std::unique_lock<std::mutex> lk(g_tx_mu);
+    if (!g_tx_cv.wait_for(lk, std::chrono::milliseconds(timeoutMs), [] { return !g_tx_out.empty(); }))
+        return false;
+    out = std::move(g_tx_out.front());
+    g_tx_out.pop_front();
+    return true;
+}
+
+void holdTx(bool hold) {
+    {
+        std::lock_guard<std::mutex> lk(g_tx_mu);
+        g_tx_hold = hold;
+    }
+    g_tx_cv.notify_all();
+}
+
+} // namespace pipe
+
+// ====== Driver SX1276 palsu ======
+bool sx1276_begin() {
+    return true;
+}
+
+void sx1276_begin_packet(uint8_t, TxPrio) {
+    g_txlen = 0;
+}
+
+void sx1276_write(const char* data, size_t len) {
+    if (!data || len == 0) return;
+    size_t space = sizeof(g_txbuf) - g_txlen;
+    if (len > space) len = space;
+    std::memcpy(&g_txbuf[g_txlen], data, len);
+    g_txlen += len;
+}
+
+bool sx1276_end_packet() {
+    if (g_txlen == 0) return false;
+    std::unique_lock<std::mutex> lk(g_tx_mu);
+    g_tx_cv.wait(lk, [] { return !g_tx_hold; });
+    g_tx_out.emplace_back(g_txbuf, g_txbuf + g_txlen);
+    lk.unlock();
+    g_tx_cv.notify_all();
+    return true;
+}
+
+void sx1276_on_tx_done(sx1276_tx_done_cb_t, void*) {}
+
+uint32_t sx1276_tx_room(TxPrio prio) {
+    return sx1276_tx_depth(prio);   // frame dianggap langsung terkirim
+}
+
+uint32_t sx1276_tx_free(TxPrio prio) {
+    return sx1276_tx_depth(prio);
+}
+
+uint32_t sx1276_tx_pending() {
+    return 0;
+}
+
+int sx1276_wait_packet(uint32_t timeout_ms) {
+    // paket sebelumnya selesai diproses: slot kembali ke pool
+    if (g_rx_cur >= 0) {
+        g_rx_free.push((uint8_t)g_rx_cur);
+        g_rx_cur = -1;
+    }
+    uint8_t slot;
+    TickType_t ticks = (timeout_ms == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    if (!g_rx_ready.wait(slot, ticks)) return 0;
+    g_rx_cur = slot;
+    g_rx_idx = 0;
+    return g_rx_pool[slot].len;
+}
+
+int sx1276_parse_packet() {
+    return sx1276_wait_packet(0);
+}
+
+Sx1276RxView sx1276_rx_view() {
+    Sx1276RxView v{};
+    if (g_rx_cur < 0) return v;
+    RxPacket& p = g_rx_pool[g_rx_cur];
+    v.data    = p.data;
+    v.len     = p.len;
+    v.rssi    = p.rssi;
+    v.snr_x4  = p.snr_x4;
+    v.time_us = p.time_us;
+    return v;
+}
+
+int sx1276_read_byte() {
+    if (g_rx_cur < 0 || g_rx_idx >= g_rx_pool[g_rx_cur].len) return -1;
+    return g_rx_pool[g_rx_cur].data[g_rx_idx++];
+}
+
+int sx1276_packet_rssi() {
+    return g_rx_cur >= 0 ? g_rx_pool[g_rx_cur].rssi : -127;
+}
+
+int64_t sx1276_packet_time_us() {
+    return g_rx_cur >= 0 ? g_rx_pool[g_rx_cur].time_us : esp_timer_get_time();
+}
+
+uint32_t sx1276_rx_dropped() {
+    return 0;
+}
+
+const LoraModemConfig& sx1276_modem_config() {
+    return modem();
+}
+
+// ====== Shim ESP-IDF ======
+extern "C" {
+
+esp_log_level_t esp_log_host_level = ESP_LOG_NONE;
+
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...) {
+    static const char letters[] = "NEWIDV";
+    char msg[512];
+    va_list ap;
+    va_start(ap, format);
+    std::vsnprintf(msg, sizeof(msg), format, ap);
+    va_end(ap);
+    std::fprintf(stderr, "%c (%s) %s\n", letters[level], tag, msg);
+}
+
+// jam dinding sejak start + 1 s (firmware menganggap 0 = belum pernah)
+int64_t esp_timer_get_time(void) {
+    return 1000000 + std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - g_boot).count();
+}
+
+esp_err_t esp_read_mac(uint8_t* mac, esp_mac_type_t) {
+    static const uint8_t self[6] = { 0x02, 0x4C, 0x52, 0x00, 0x00, 0x00 };
+    std::memcpy(mac, self, 6);
+    return ESP_OK;
+}
+
+uint32_t esp_random(void) {
+    std::lock_guard<std::mutex> lk(g_rng_mu);
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+}
+
+} // extern "C"
@@ -0,0 +1,39 @@
+#pragma once
+// esp_log.h — shim host (Linux) untuk build simulator/benchmark.
+// Hanya subset yang dipakai firmware; implementasi esp_log_write()
+// disediakan oleh program host (sim / bench).
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    ESP_LOG_NONE = 0,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+// level global yang aktif; esp_log_write() tidak dipanggil di atas level ini
+extern esp_log_level_t esp_log_host_level;
+
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+#ifdef __cplusplus
+}
+#endif
+
+#define ESP_LOG_LEVEL_HOST(level, tag, format, ...)                         \
+    do {                                                                    \
+        if ((level) <= esp_log_host_level)                                  \
+            esp_log_write((level), (tag), format, ##__VA_ARGS__);           \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) ESP_LOG_LEVEL_HOST(ESP_LOG_ERROR,   tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) ESP_LOG_LEVEL_HOST(ESP_LOG_WARN,    tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ESP_LOG_LEVEL_HOST(ESP_LOG_INFO,    tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) ESP_LOG_LEVEL_HOST(ESP_LOG_DEBUG,   tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) ESP_LOG_LEVEL_HOST(ESP_LOG_VERBOSE, tag, format, ##__VA_ARGS__)
@@ -0,0 +1,14 @@
+#pragma once
+// esp_random.h — shim host. PRNG deterministik per node (seed dari simulator),
+// supaya run simulasi bisa diulang persis.
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t esp_random(void);
+
+#ifdef __cplusplus
+}
+#endif
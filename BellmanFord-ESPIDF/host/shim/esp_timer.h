@@ -0,0 +1,15 @@
+#pragma once
+// esp_timer.h — shim host. Waktu berasal dari jam discrete-event simulator
+// (bukan jam dinding), jadi simulasi bisa berjalan lebih cepat dari real time.
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// mikrodetik sejak node "boot"
+int64_t esp_timer_get_time(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,15 @@
+#pragma once
+// FreeRTOS.h — shim host (subset). Tick = 1 ms.
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define pdFALSE          0
+#define pdTRUE           1
+#define pdPASS           pdTRUE
+#define pdFAIL           pdFALSE
+#define portMAX_DELAY    ((TickType_t)0xFFFFFFFFu)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
@@ -0,0 +1,28 @@
+#pragma once
+// task.h — shim host. vTaskDelay() memajukan jam lokal node di simulator,
+// bukan benar-benar tidur.
+//
+// Task + notifikasi task (task_host.cpp): satu std::thread per task,
+// notifikasi = counter + condition variable per task. Hanya di-link ke
+// target yang benar-benar menjalankan task (lora_pipe).
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct HostTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+void vTaskDelay(TickType_t ticks);
+
+// core dan prioritas diabaikan (penjadwal OS host)
+BaseType_t   xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                                     void* arg, UBaseType_t prio, TaskHandle_t* out, BaseType_t core);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+void         xTaskNotifyGive(TaskHandle_t task);
+uint32_t     ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,66 @@
+// task_host.cpp — task FreeRTOS di atas std::thread untuk host (lora_pipe).
+//
+// Thread yang bukan task (mis. main) mendapat HostTask sendiri saat pertama
+// kali memanggil xTaskGetCurrentTaskHandle()/ulTaskNotifyTake(), jadi bisa
+// ikut menunggu notifikasi seperti task biasa.
+
+#include "freertos/task.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct HostTask {
+    std::mutex              mu;
+    std::condition_variable cv;
+    uint32_t                count = 0;   // nilai notifikasi (counting)
+};
+
+static thread_local HostTask* t_self = nullptr;
+
+static HostTask* self() {
+    // thread non-task: tidak pernah dibebaskan, sama seperti task FreeRTOS
+    if (!t_self) t_self = new HostTask;
+    return t_self;
+}
+
+extern "C" {
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char*, uint32_t, void* arg, UBaseType_t,
+                                   TaskHandle_t* out, BaseType_t) {
+    HostTask* task = new HostTask;
+    // handle terisi sebelum task jalan (task lain boleh langsung memakainya)
+    if (out) *out = task;
+    std::thread([fn, arg, task] {
+        t_self = task;
+        fn(arg);
+    }).detach();
+    return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return self();
+}
+
+void xTaskNotifyGive(TaskHandle_t task) {
+    if (!task) return;
+    {
+        std::lock_guard<std::mutex> lk(task->mu);
+        task->count++;
+    }
+    task->cv.notify_one();
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+    HostTask* t = self();
+    std::unique_lock<std::mutex> lk(t->mu);
+    auto ready = [t] { return t->count > 0; };
+    if (ticks == portMAX_DELAY) t->cv.wait(lk, ready);
+    else t->cv.wait_for(lk, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), ready);
+    uint32_t v = t->count;
+    if (v) t->count = clearOnExit ? 0 : v - 1;
+    return v;
+}
+
+} // extern "C"
@@ -0,0 +1,39 @@
+#pragma once
+// node_api.h — antarmuka antara simulator dan "image" firmware satu node.
+//
+// Setiap node virtual memuat salinan modul lora_node (.so) sendiri, sehingga
+// semua state statis di LoRaRouting.cpp/node.cpp terpisah per node — sama
+// seperti tiap board punya RAM sendiri. Simulator hanya mengakses firmware
+// lewat tabel fungsi ini (satu dlsym, tanpa nama C++ yang di-mangle).
+#include <cstdint>
+#include <cstddef>
+
+struct SimNodeApi {
+    int version;
+
+    // setup_port() versi simulator
+    void     (*setup)(int nodeId);
+    // satu iterasi task routing (pipeline.cpp); kembalikan jeda (ms) sampai timer periodik
+    // berikutnya (paket masuk membangunkan node lebih awal)
+    uint32_t (*loop_once)();
+
+    // akses tabel routing untuk metrik (tanpa efek samping)
+    int      (*next_hop)(int destId);    // -1 jika tidak ada rute
+    int      (*route_cost)(int destId);  // -1 jika tidak ada rute
+
+    // trafik aplikasi: sendData() firmware (false = ditolak firmware)
+    bool     (*send_data)(int destId, const uint8_t* payload, size_t len);
+
+    // statistik runtime firmware (lora_stats.h)
+    size_t      (*stats_snapshot)(uint8_t* out, size_t cap);
+    const char* (*stat_name)(int index);
+    void        (*set_stats_report)(int collectorId, uint32_t intervalMs);
+};
+
+static constexpr int SIM_NODE_API_VERSION = 4;
+
+extern "C" const SimNodeApi* sim_node_api();
+
+// Disediakan simulator (diekspor executable): firmware node aktif menerima
+// frame data untuk dirinya (handler setDataRecvHandler)
+extern "C" void sim_data_delivered(int srcId, const uint8_t* payload, size_t len);
@@ -0,0 +1,74 @@
+// node_entry.cpp — pengganti main.cpp untuk simulator.
+// Dikompilasi ke dalam modul lora_node bersama LoRaRouting.cpp/node.cpp
+// (tanpa modifikasi). Logika setup_port()/routing_task() (pipeline.cpp)
+// disalin apa adanya;
+// LoRa_WaitPacket() yang blocking diganti oleh penjadwal event di simulator
+// (node dibangunkan saat paket masuk antrean RX atau timer jatuh tempo).
+
+#include "node_api.h"
+
+#include "LoRaRouting.h"
+#include "node.h"
+#include "lora_stats.h"
+
+static void sim_on_data(int srcId, const uint8_t* payload, size_t len, void*) {
+  sim_data_delivered(srcId, payload, len);
+}
+
+static void sim_setup(int nodeId) {
+  NODE_ID = nodeId;
+
+  initLoRa();
+  setDataRecvHandler(sim_on_data, nullptr);
+  initNodes();              // cetak Node ID + hello awal
+  runBellmanFord();
+
+  sendHelloMessages();
+}
+
+static uint32_t sim_loop_once() {
+  // kuras antrean RX (task radio sudah mengisinya), lalu timer periodik
+  int packetSize;
+  while ((packetSize = LoRa_ParsePacket()) > 0) {
+    onDataRecv(packetSize);
+  }
+  return runPeriodicTasks();
+}
+
+// ====== Akses tabel routing untuk metrik ======
+static int sim_next_hop(int destId) {
+  const RoutingEntry* e = routingTable.find(destId);
+  return e ? e->nextHopId : -1;
+}
+
+static int sim_route_cost(int destId) {
+  const RoutingEntry* e = routingTable.find(destId);
+  return e ? (int)e->cost : -1;
+}
+
+static bool sim_send_data(int destId, const uint8_t* payload, size_t len) {
+  return sendData(destId, payload, len);
+}
+
+// ====== Statistik runtime ======
+static size_t sim_stats_snapshot(uint8_t* out, size_t cap) {
+  return statsSnapshot(out, cap, NODE_ID);
+}
+
+static const char* sim_stat_name(int index) {
+  return index >= 0 && index < STAT_COUNT ? statName((Stat)index) : nullptr;
+}
+
+static const SimNodeApi s_api = {
+  SIM_NODE_API_VERSION,
+  sim_setup,
+  sim_loop_once,
+  sim_next_hop,
+  sim_route_cost,
+  sim_send_data,
+  sim_stats_snapshot,
+  sim_stat_name,
+  setStatsReport,
+};
+
+extern "C" const SimNodeApi* sim_node_api() { return &s_api; }
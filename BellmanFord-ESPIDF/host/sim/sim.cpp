@@ -0,0 +1,784 @@
+// sim.cpp — inti discrete-event simulator: penempatan node, kanal radio,
+// antrean event, dan metrik (konvergensi, overhead kontrol, delivery ratio).
+
+#include "sim.h"
+#include "board.h"
+#include "routing_wire.h"
+#include "lora_sx1276.h"
+#include "lora_airtime.h"
+#include "lora_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <numeric>
+
+#include <dlfcn.h>
+#include <unistd.h>
+
+namespace sim {
+
+World* g_world = nullptr;
+
+// ====== PHY helper ======
+// konfigurasi modem yang sama dengan set_modem() di firmware (lora_airtime.h)
+static const LoraModemConfig& modem(uint8_t dr) {
+    static const auto cfg = [] {
+        std::array<LoraModemConfig, LORA_DR_MAX> c{};
+        for (uint8_t i = 0; i < LORA_DR_MAX; i++) c[i] = loraModemConfigForDr(i);
+        return c;
+    }();
+    return cfg[dr < LORA_DR_MAX ? dr : 0];
+}
+
+uint32_t airtimeUs(size_t payloadLen, uint8_t dr) {
+    return loraTimeOnAirUs(modem(dr), payloadLen);
+}
+
+double noiseFloorDbm(double nf_db, uint8_t dr) {
+    return -174.0 + 10.0 * std::log10((double)modem(dr).bw_hz) + nf_db;
+}
+
+double sensitivityDbm(double nf_db, uint8_t dr) {
+    return noiseFloorDbm(nf_db, dr) + snrThresholdDb(modem(dr).sf);
+}
+
+double snrThresholdDb(int sf) {
+    static const double thr[] = { -5.0, -7.5, -10.0, -12.5, -15.0, -17.5, -20.0 };
+    if (sf < 6) sf = 6;
+    if (sf > 12) sf = 12;
+    return thr[sf - 6];
+}
+
+const char* kindName(Kind k) {
+    switch (k) {
+        case Kind::Hello:   return "hello";
+        case Kind::Routing: return "routing";
+        case Kind::Data:    return "data";
+        case Kind::Ack:     return "ack";
+        default:            return "other";
+    }
+}
+
+static bool startsWith(const uint8_t* d, size_t n, const char* p) {
+    size_t m = std::strlen(p);
+    return n >= m && std::memcmp(d, p, m) == 0;
+}
+
+Kind classify(const uint8_t* data, size_t len) {
+    if (startsWith(data, len, "Hello from "))  return Kind::Hello;
+    if (startsWith(data, len, "ROUTINGID|") ||
+        startsWith(data, len, "ROUTING|"))     return Kind::Routing;
+    if (len > 0 && wireIsRoutingType(data[0])) return Kind::Routing;
+    if (len > 0 && data[0] == WIRE_TYPE_DATA)  return Kind::Data;
+    if (len > 0 && data[0] == WIRE_TYPE_ACK)   return Kind::Ack;
+    if (startsWith(data, len, "Data to "))     return Kind::Data;
+    return Kind::Other;
+}
+
+// Fragmen dihitung sebagai kategori datagram yang dibawanya: fragmen 0
+// (selalu dikirim lebih dulu) memuat awal datagram.
+Kind World::kindOf(const uint8_t* data, size_t len) {
+    if (len <= WIRE_FRAG_HDR_LEN || data[0] != WIRE_TYPE_FRAG) return classify(data, len);
+    uint32_t key = ((uint32_t)data[1] << 16) | data[3] | ((uint32_t)data[4] << 8);
+    if (data[5] == 0) {
+        Kind k = classify(data + WIRE_FRAG_HDR_LEN, len - WIRE_FRAG_HDR_LEN);
+        frag_kind_[key] = k;
+        return k;
+    }
+    auto it = frag_kind_.find(key);
+    return it != frag_kind_.end() ? it->second : Kind::Other;
+}
+
+// ====== World ======
+World::World(const Config& cfg)
+    : cfg_(cfg), chan_rng_(cfg.seed * 7919u + 17u), data_rng_(cfg.seed ^ 0xda7au) {
+    g_world = this;
+}
+
+World::~World() {
+    for (auto& n : nodes_) {
+        if (n.handle) dlclose(n.handle);
+    }
+    if (!tmpdir_.empty()) {
+        std::error_code ec;
+        std::filesystem::remove_all(tmpdir_, ec);
+    }
+    g_world = nullptr;
+}
+
+void World::place() {
+    std::mt19937 rng(cfg_.seed);
+    std::uniform_real_distribution<double> u(0.0, cfg_.area_m);
+    const int n = (int)nodes_.size();
+    const int cols = std::max(1, (int)std::ceil(std::sqrt((double)n)));
+    for (int i = 0; i < n; ++i) {
+        Node& nd = nodes_[i];
+        if (cfg_.topology == "random") {
+            nd.x = u(rng);
+            nd.y = u(rng);
+        } else if (cfg_.topology == "line") {
+            nd.x = i * cfg_.spacing_m;
+            nd.y = 0;
+        } else {
+            nd.x = (i % cols) * cfg_.spacing_m;
+            nd.y = (i / cols) * cfg_.spacing_m;
+        }
+    }
+}
+
+void World::buildLinks() {
+    const size_t n = nodes_.size();
+    rssi_.assign(n * n, -200.0);
+    std::normal_distribution<double> shadow(0.0, cfg_.shadowing_db);
+    for (size_t a = 0; a < n; ++a) {
+        for (size_t b = a + 1; b < n; ++b) {
+            double dx = nodes_[a].x - nodes_[b].x, dy = nodes_[a].y - nodes_[b].y;
+            double d  = std::max(1.0, std::sqrt(dx * dx + dy * dy));
+            double pl = cfg_.pl_d0_db + 10.0 * cfg_.pl_exp * std::log10(d) + shadow(chan_rng_);
+            rssi_[a * n + b] = rssi_[b * n + a] = cfg_.tx_power_dbm - pl;
+        }
+    }
+    buildComponents();
+}
+
+void World::buildComponents() {
+    // komponen terhubung pada link "usable" (RSSI rata-rata >= sensitivitas)
+    const size_t n = nodes_.size();
+    const double sens = sensitivityDbm(cfg_.noise_fig_db);
+    component_.resize(n);
+    std::iota(component_.begin(), component_.end(), 0);
+    auto find = [&](int x) {
+        while (component_[x] != x) x = component_[x] = component_[component_[x]];
+        return x;
+    };
+    for (size_t a = 0; a < n; ++a)
+        for (size_t b = a + 1; b < n; ++b)
+            if (!nodes_[a].down && !nodes_[b].down && rssi_[a * n + b] >= sens)
+                component_[find((int)a)] = find((int)b);
+    for (size_t a = 0; a < n; ++a) component_[a] = find((int)a);
+}
+
+bool World::connected(int a, int b) const {
+    return !nodes_[a].down && !nodes_[b].down && component_[a] == component_[b];
+}
+
+bool World::load(std::string& err) {
+    nodes_.resize((size_t)cfg_.nodes);
+
+    char tmpl[] = "/tmp/lorasim.XXXXXX";
+    if (!mkdtemp(tmpl)) { err = "mkdtemp failed"; return false; }
+    tmpdir_ = tmpl;
+
+    std::mt19937 boot_rng(cfg_.seed ^ 0x5eedu);
+    std::uniform_real_distribution<double> boot(0.0, cfg_.boot_jitter_s * 1e6);
+
+    for (int i = 0; i < cfg_.nodes; ++i) {
+        Node& nd = nodes_[i];
+        nd.id  = i;
+        nd.rng.seed(cfg_.seed * 1000003u + (uint32_t)i);
+
+        // salinan modul per node -> state statis firmware terpisah
+        std::string path = tmpdir_ + "/node_" + std::to_string(i) + ".so";
+        std::error_code ec;
+        std::filesystem::copy_file(cfg_.module_path, path, ec);
+        if (ec) { err = "copy " + cfg_.module_path + ": " + ec.message(); return false; }
+        nd.handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!nd.handle) { err = dlerror(); return false; }
+        std::filesystem::remove(path, ec);
+
+        auto entry = (const SimNodeApi* (*)())dlsym(nd.handle, "sim_node_api");
+        if (!entry) { err = "sim_node_api not found"; return false; }
+        nd.api = entry();
+        if (nd.api->version != SIM_NODE_API_VERSION) { err = "node API version mismatch"; return false; }
+
+        // MAC: pakai tabel NODE_x dari node.cpp bila ada, selain itu MAC
+        // locally-administered sintetis
+        char sym[16];
+        std::snprintf(sym, sizeof(sym), "NODE_%d", i);
+        if (auto mac = (const uint8_t*)dlsym(nd.handle, sym)) {
+            std::memcpy(nd.mac, mac, 6);
+        } else {
+            const uint8_t synth[6] = { 0x02, 0x4C, 0x52, 0x00, (uint8_t)(i >> 8), (uint8_t)i };
+            std::memcpy(nd.mac, synth, 6);
+        }
+
+        nd.boot_us = (uint64_t)boot(boot_rng);
+        schedule({ nd.boot_us, 0, Event::Boot, i, 0, 0 });
+    }
+
+    // registry node_id <-> MAC untuk semua node (dibaca firmware saat initNodes)
+    std::string regPath = tmpdir_ + "/registry.txt";
+    FILE* reg = std::fopen(regPath.c_str(), "w");
+    if (!reg) { err = "cannot write " + regPath; return false; }
+    std::fprintf(reg, "# lora_sim node registry\n");
+    for (const Node& nd : nodes_) {
+        std::fprintf(reg, "%d %02X:%02X:%02X:%02X:%02X:%02X\n", nd.id,
+                     nd.mac[0], nd.mac[1], nd.mac[2], nd.mac[3], nd.mac[4], nd.mac[5]);
+    }
+    std::fclose(reg);
+    setenv("LORA_NODE_REGISTRY", regPath.c_str(), 1);
+
+    place();
+    buildLinks();
+
+    for (uint64_t t = 0; t <= (uint64_t)(cfg_.duration_s * 1e6); t += (uint64_t)(cfg_.sample_s * 1e6)) {
+        schedule({ t, 0, Event::Sample, -1, 0, 0 });
+    }
+    if (cfg_.fail_node >= 0) {
+        if (cfg_.fail_node >= cfg_.nodes) { err = "--fail: no such node"; return false; }
+        schedule({ (uint64_t)(cfg_.fail_s * 1e6), 0, Event::Fail, cfg_.fail_node, 0, 0 });
+    }
+    if (cfg_.data_interval_s > 0) {
+        std::exponential_distribution<double> gap(1.0 / cfg_.data_interval_s);
+        for (const Node& nd : nodes_) {
+            uint64_t t = (uint64_t)((cfg_.data_start_s + gap(data_rng_)) * 1e6);
+            schedule({ t, 0, Event::Data, nd.id, 0, 0 });
+        }
+    }
+    return true;
+}
+
+void World::schedule(const Event& e) {
+    Event x = e;
+    x.seq = seq_++;
+    q_.push(x);
+}
+
+void World::wakeAt(Node& n, uint64_t t_us) {
+    n.wake_us = t_us;
+    schedule({ t_us, 0, Event::Wake, n.id, ++n.wake_gen, 0 });
+}
+
+void World::fail(Node& n) {
+    // node mati mendadak: tidak bangun, tidak mengirim sisa antrean, tidak menerima
+    n.down = true;
+    n.wake_gen++;
+    for (auto& q : n.txq) q.clear();
+    n.rxq.clear();
+    buildComponents();
+}
+
+void World::runNode(Node& n, bool boot) {
+    if (n.down) return;
+    cur_ = &n;
+    n.local_us = now_us_;
+    uint32_t delay_ms;
+    if (boot) {
+        n.booted = true;
+        n.api->setup(n.id);
+        if (cfg_.stats_collector >= 0)
+            n.api->set_stats_report(cfg_.stats_collector, (uint32_t)(cfg_.stats_interval_s * 1000));
+        delay_ms = 0;   // task routing mulai segera setelah setup
+    } else {
+        delay_ms = n.api->loop_once();
+    }
+    cur_ = nullptr;
+
+    n.idle_us = n.local_us;
+    wakeAt(n, n.local_us + (uint64_t)delay_ms * 1000u);
+}
+
+bool World::transmit(Node& n) {
+    // sx1276_end_packet() non-blocking: frame masuk antrean kelasnya, task
+    // radio mengirimnya saat radio bebas
+    if (n.txlen == 0) return false;
+    Kind k = kindOf(n.txbuf, n.txlen);
+    auto& q = n.txq[(int)n.txprio];
+    if (q.size() >= sx1276_tx_depth(n.txprio)) {
+        if (!sx1276_tx_drop_oldest(n.txprio)) {
+            total_.tx_dropped++;
+            by_kind_[(int)k].tx_dropped++;
+            n.tx_dropped++;
+            return false;
+        }
+        Kind old = kindOf(q.front().bytes.data(), q.front().bytes.size());
+        for (Counters* c : { &total_, &by_kind_[(int)old] }) c->tx_evicted++;
+        q.pop_front();
+    }
+    q.push_back({ n.txdr, now_us_, std::vector<uint8_t>(n.txbuf, n.txbuf + n.txlen) });
+    if (!n.tx_busy && !n.lbt_wait) channelAccess(n);
+    return true;
+}
+
+// cermin tx_dequeue() driver: kelas tertinggi yang berisi, kecuali kepala
+// antrean yang menunggu > LORA_TXQ_AGE_MS (yang terlama didahulukan)
+bool World::dequeueTx(Node& n) {
+    int pick = -1, aged = -1;
+    for (int p = 0; p < TX_PRIO_COUNT; ++p) {
+        if (n.txq[p].empty()) continue;
+        if (pick < 0) pick = p;
+        uint64_t at = n.txq[p].front().queued_us;
+        if (now_us_ - at > (uint64_t)LORA_TXQ_AGE_MS * 1000u &&
+            (aged < 0 || at < n.txq[aged].front().queued_us))
+            aged = p;
+    }
+    if (pick < 0) return false;
+    if (aged >= 0 && aged != pick) {
+        pick = aged;
+        const TxFrame& f = n.txq[pick].front();
+        Kind k = kindOf(f.bytes.data(), f.bytes.size());
+        for (Counters* c : { &total_, &by_kind_[(int)k] }) c->tx_aged++;
+    }
+    n.txcur = std::move(n.txq[pick].front());
+    n.txq[pick].pop_front();
+    return true;
+}
+
+// frame berikutnya: CAD dulu (LORA_LBT_ENABLE) seperti tx_step() driver
+void World::channelAccess(Node& n) {
+    if (!dequeueTx(n)) return;
+    if (!LORA_LBT_ENABLE) { startTx(n); return; }
+    n.lbt_wait  = true;
+    n.lbt_tries = 0;
+    schedule({ now_us_ + loraCadTimeUs(modem(n.txcur.dr)), 0, Event::Cad, n.id, 0, 0 });
+}
+
+// CAD mendeteksi preamble/chirp frame lain di SF/BW yang sama dan di atas sensitivitas
+bool World::channelBusy(const Node& n, uint8_t dr) {
+    const LoraModemConfig& m = modem(dr);
+    const double sens = sensitivityDbm(cfg_.noise_fig_db, dr);
+    std::normal_distribution<double> fade(0.0, cfg_.fading_db);
+    for (const auto& u : history_) {
+        if (u.src == n.id || u.start_us > now_us_ || u.end_us <= now_us_) continue;
+        const LoraModemConfig& um = modem(u.dr);
+        if (um.sf != m.sf || um.bw_hz != m.bw_hz) continue;
+        if (meanRssi(u.src, n.id) + fade(chan_rng_) >= sens) return true;
+    }
+    return false;
+}
+
+void World::onCad(Node& n) {
+    n.lbt_wait = false;
+    if (n.down || n.tx_busy) return;
+    const uint8_t dr = n.txcur.dr;
+    if (!channelBusy(n, dr)) { startTx(n); return; }
+
+    Kind k = kindOf(n.txcur.bytes.data(), n.txcur.bytes.size());
+    for (Counters* c : { &total_, &by_kind_[(int)k] }) c->lbt_busy++;
+    if (++n.lbt_tries <= LORA_LBT_MAX_TRIES) {
+        uint64_t backoff = sx1276_lbt_backoff_us(modem(dr), n.lbt_tries, (uint32_t)n.rng());
+        n.lbt_wait = true;
+        schedule({ now_us_ + backoff + loraCadTimeUs(modem(dr)), 0, Event::Cad, n.id, 0, 0 });
+        return;
+    }
+
+    // budget habis: frame dibuang, laporkan gagal ke aplikasi
+    for (Counters* c : { &total_, &by_kind_[(int)k] }) c->lbt_drop++;
+    n.txcur.bytes.clear();
+    if (n.tx_done_cb) {
+        cur_ = &n;
+        n.local_us = now_us_;
+        n.tx_done_cb(false, n.tx_done_arg);
+        cur_ = nullptr;
+    }
+    channelAccess(n);
+}
+
+void World::startTx(Node& n) {
+    Transmission t;
+    t.src      = n.id;
+    t.start_us = now_us_;
+    t.dr       = n.txcur.dr;
+    t.bytes    = std::move(n.txcur.bytes);
+    t.end_us   = now_us_ + airtimeUs(t.bytes.size(), t.dr);
+    n.tx_busy = true;
+    n.tx_airtime_us += t.end_us - t.start_us;
+
+    Kind k = kindOf(t.bytes.data(), t.bytes.size());
+    for (Counters* c : { &total_, &by_kind_[(int)k] }) {
+        c->tx_frames++;
+        c->tx_bytes += t.bytes.size();
+        c->tx_airtime_us += t.end_us - t.start_us;
+    }
+
+    size_t idx = history_base_ + history_.size();
+    uint64_t end = t.end_us;
+    history_.push_back(std::move(t));
+    schedule({ end, 0, Event::TxEnd, n.id, 0, idx });
+}
+
+void World::onTxEnd(size_t txIdx) {
+    const Transmission& t = tx(txIdx);
+    const size_t n = nodes_.size();
+    const double sens = sensitivityDbm(cfg_.noise_fig_db, t.dr);
+    Kind k = kindOf(t.bytes.data(), t.bytes.size());
+
+    // semua TX lain yang tumpang tindih dengan frame ini
+    std::vector<const Transmission*> overlap;
+    for (const auto& u : history_) {
+        if (&u != &t && u.start_us < t.end_us && u.end_us > t.start_us) overlap.push_back(&u);
+    }
+
+    std::normal_distribution<double> fade(0.0, cfg_.fading_db);
+    for (size_t r = 0; r < n; ++r) {
+        if ((int)r == t.src) continue;
+        Node& rx = nodes_[r];
+        double mean = meanRssi(t.src, (int)r);
+        if (mean + 4.0 * cfg_.fading_db < sens || !rx.booted || rx.down || rx.boot_us > t.start_us) continue;
+
+        double rssi = mean + fade(chan_rng_);
+        Counters* cs[2] = { &total_, &by_kind_[(int)k] };
+
+        bool halfDuplex = false, collided = false;
+        for (const Transmission* u : overlap) {
+            if (u->src == (int)r) { halfDuplex = true; break; }
+            if (meanRssi(u->src, (int)r) > rssi - cfg_.capture_db) collided = true;
+        }
+        if (halfDuplex) { if (mean >= sens) for (auto c : cs) c->lost_half_duplex++; continue; }
+        if (rssi < sens) { if (mean >= sens) for (auto c : cs) c->lost_sensitivity++; continue; }
+        if (collided)    { for (auto c : cs) c->lost_collision++; continue; }
+
+        for (auto c : cs) c->rx_ok++;
+        if (rx.rxq.size() >= (size_t)LORA_RX_QUEUE_LEN) {
+            for (auto c : cs) c->lost_overrun++;
+            rx.rx_dropped++;
+            continue;
+        }
+        RxFrame f;
+        f.time_us = (int64_t)(now_us_ - rx.boot_us);
+        f.rssi    = (int)std::lround(rssi);
+        f.snr_x4  = (int)std::lround(4.0 * (rssi - noiseFloorDbm(cfg_.noise_fig_db, t.dr)));
+        f.dr      = t.dr;
+        f.len     = (uint16_t)t.bytes.size();
+        std::memcpy(f.data.data(), t.bytes.data(), t.bytes.size());
+        rx.rxq.push_back(f);
+
+        // ISR DIO0 -> antrean -> task routing bangun segera (setelah iterasi yang sedang jalan)
+        uint64_t due = std::max(now_us_, rx.idle_us);
+        if (due < rx.wake_us) wakeAt(rx, due);
+    }
+
+    // TxDone di pengirim: callback aplikasi (konteks task radio node tsb),
+    // lalu frame berikutnya di antrean TX
+    Node& src = nodes_[(size_t)t.src];
+    src.tx_busy = false;
+    if (src.tx_done_cb && !src.down) {
+        cur_ = &src;
+        src.local_us = now_us_;
+        src.tx_done_cb(true, src.tx_done_arg);
+        cur_ = nullptr;
+    }
+    if (!src.down && !src.lbt_wait) channelAccess(src);
+
+    // buang riwayat yang tidak mungkin lagi tumpang tindih dengan TX mendatang
+    const uint64_t horizon = airtimeUs(255);
+    while (!history_.empty() && history_.front().end_us + horizon < now_us_ &&
+           history_base_ < txIdx) {
+        history_.pop_front();
+        history_base_++;
+    }
+}
+
+void World::sample() {
+    const int n = (int)nodes_.size();
+    std::vector<std::pair<int, int>> pairs;
+    for (int a = 0; a < n; ++a)
+        for (int b = 0; b < n; ++b)
+            if (a != b && connected(a, b)) pairs.emplace_back(a, b);
+
+    std::mt19937 probe_rng(cfg_.seed + (uint32_t)samples_.size());
+    if ((int)pairs.size() > cfg_.probe_pairs) {
+        std::shuffle(pairs.begin(), pairs.end(), probe_rng);
+        pairs.resize((size_t)cfg_.probe_pairs);
+    }
+
+    // telusuri rantai next-hop dari tabel routing masing-masing node
+    int ok = 0;
+    for (auto [src, dst] : pairs) {
+        int cur = src;
+        for (int hop = 0; hop < n; ++hop) {
+            if (!nodes_[cur].booted || nodes_[cur].down) break;
+            int nh = nodes_[cur].api->next_hop(dst);
+            if (nh < 0 || nh >= n) break;
+            if (nh == dst) { ok++; break; }
+            cur = nh;
+        }
+    }
+    // rute basi ke node yang sudah mati (harus ditarik dari seluruh jaringan)
+    int stale = 0;
+    if (cfg_.fail_node >= 0 && nodes_[cfg_.fail_node].down) {
+        for (const Node& nd : nodes_) {
+            if (nd.booted && !nd.down && nd.api->next_hop(cfg_.fail_node) >= 0) stale++;
+        }
+    }
+    samples_.push_back({ now_us_ / 1e6, (int)pairs.size(), ok, stale });
+}
+
+// ====== Trafik data ======
+// Pesan ke tujuan acak lewat sendData() firmware; berhenti DATA_DRAIN_S
+// sebelum akhir simulasi supaya pesan terakhir sempat sampai.
+static constexpr double DATA_DRAIN_S = 10.0;
+
+void World::sendData(Node& n) {
+    const int count = (int)nodes_.size();
+    if (count > 1 && n.booted && !n.down) {
+        int dst = std::uniform_int_distribution<int>(0, count - 2)(data_rng_);
+        if (dst >= n.id) dst++;
+
+        DataMsg m;
+        m.src = n.id;
+        m.dst = dst;
+        m.sent_us = now_us_;
+        m.connected = connected(n.id, dst);
+
+        std::vector<uint8_t> payload((size_t)std::max(4, cfg_.data_len), 0x5A);
+        uint32_t id = (uint32_t)data_.size();
+        std::memcpy(payload.data(), &id, sizeof(id));
+
+        cur_ = &n;
+        n.local_us = now_us_;
+        m.accepted = n.api->send_data(dst, payload.data(), payload.size());
+        cur_ = nullptr;
+        data_.push_back(m);
+    }
+
+    std::exponential_distribution<double> gap(1.0 / cfg_.data_interval_s);
+    uint64_t next = now_us_ + (uint64_t)(gap(data_rng_) * 1e6);
+    if (next / 1e6 < cfg_.duration_s - DATA_DRAIN_S) schedule({ next, 0, Event::Data, n.id, 0, 0 });
+}
+
+void World::delivered(Node& n, int src, const uint8_t* payload, size_t len) {
+    if (len >= STATS_HDR_LEN && payload[0] == STATS_MAGIC0 && payload[1] == STATS_MAGIC1) {
+        stats_reports_++;   // laporan statistik (bukan trafik --data-interval)
+        return;
+    }
+    uint32_t id;
+    if (len < sizeof(id)) return;
+    std::memcpy(&id, payload, sizeof(id));
+    if (id >= data_.size() || data_[id].dst != n.id || data_[id].src != src) return;
+    if (data_[id].delivered_us) { data_dup_++; return; }
+    data_[id].delivered_us = std::max<uint64_t>(n.local_us, data_[id].sent_us + 1);
+}
+
+void World::run() {
+    const uint64_t end = (uint64_t)(cfg_.duration_s * 1e6);
+    while (!q_.empty()) {
+        Event e = q_.top();
+        if (e.t_us > end) break;
+        q_.pop();
+        now_us_ = e.t_us;
+        switch (e.type) {
+            case Event::Boot:
+                runNode(nodes_[e.node], true);
+                break;
+            case Event::Wake: {
+                Node& nd = nodes_[e.node];
+                if (e.gen == nd.wake_gen) runNode(nd, false);
+                break;
+            }
+            case Event::TxEnd:
+                onTxEnd(e.tx);
+                break;
+            case Event::Cad:
+                onCad(nodes_[e.node]);
+                break;
+            case Event::Sample:
+                sample();
+                break;
+            case Event::Fail:
+                fail(nodes_[e.node]);
+                break;
+            case Event::Data:
+                sendData(nodes_[e.node]);
+                break;
+        }
+    }
+    collectFirmwareStats();
+}
+
+// jumlahkan counter lora_stats semua node (snapshot lewat node API)
+void World::collectFirmwareStats() {
+    fw_stats_.clear();
+    uint8_t buf[512];
+    for (Node& n : nodes_) {
+        if (!n.booted) continue;
+        cur_ = &n;
+        n.local_us = now_us_;
+        size_t len = n.api->stats_snapshot(buf, sizeof(buf));
+        cur_ = nullptr;
+        if (len < STATS_HDR_LEN) continue;
+        size_t count = std::min<size_t>(buf[3], (len - STATS_HDR_LEN) / 4);
+        if (fw_stats_.empty()) {
+            for (size_t i = 0; i < count; ++i) {
+                const char* name = n.api->stat_name((int)i);
+                fw_stats_.emplace_back(name ? name : "?", 0);
+            }
+        }
+        for (size_t i = 0; i < count && i < fw_stats_.size(); ++i) {
+            const uint8_t* p = buf + STATS_HDR_LEN + 4 * i;
+            fw_stats_[i].second += (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+                                   ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        }
+    }
+}
+
+// ====== Laporan ======
+// fraksi waktu TX terbesar dari semua node (batas regulasi AS923: 1%)
+double World::maxDuty(double sim_s) const {
+    uint64_t worst = 0;
+    for (const Node& n : nodes_) worst = std::max(worst, n.tx_airtime_us);
+    return sim_s > 0 ? worst / 1e6 / sim_s : 0.0;
+}
+
+void World::report(double wall_s) const {
+    const double sim_s = cfg_.duration_s;
+    const int n = (int)nodes_.size();
+
+    double t90 = -1, t100 = -1;
+    for (const auto& s : samples_) {
+        if (s.pairs == 0) continue;
+        double r = (double)s.reachable / s.pairs;
+        if (t90 < 0 && r >= 0.9) t90 = s.t_s;
+        if (t100 < 0 && s.reachable == s.pairs) t100 = s.t_s;
+    }
+    // waktu sampai semua pasangan terhubung kembali setelah node dimatikan
+    // dan sampai tidak ada lagi node yang merutekan ke node mati itu
+    double recover = -1, withdrawn = -1;
+    if (cfg_.fail_node >= 0) {
+        for (const auto& s : samples_) {
+            if (s.t_s > cfg_.fail_s && s.pairs > 0 && s.reachable == s.pairs) {
+                recover = s.t_s - cfg_.fail_s;
+                break;
+            }
+        }
+        for (const auto& s : samples_) {
+            if (s.t_s > cfg_.fail_s && s.stale == 0) {
+                withdrawn = s.t_s - cfg_.fail_s;
+                break;
+            }
+        }
+    }
+    double final_ratio = 0;
+    if (!samples_.empty() && samples_.back().pairs)
+        final_ratio = (double)samples_.back().reachable / samples_.back().pairs;
+
+    auto ratio = [](const Counters& c) {
+        uint64_t att = c.rx_ok + c.lost_collision + c.lost_half_duplex + c.lost_sensitivity;
+        return att ? (double)c.rx_ok / att : 0.0;
+    };
+    const Counters& hello = by_kind_[(int)Kind::Hello];
+    const Counters& rout  = by_kind_[(int)Kind::Routing];
+    uint64_t ctrl_air = hello.tx_airtime_us + rout.tx_airtime_us;
+
+    std::printf("LoRaRoute sim: %d nodes (%s), SF%d BW%u, %u DR, %.0f s simulated in %.2f s (x%.0f)\n",
+                n, cfg_.topology.c_str(), modem(0).sf, (unsigned)modem(0).bw_hz, (unsigned)loraDrCount(),
+                sim_s, wall_s, wall_s > 0 ? sim_s / wall_s : 0.0);
+    std::printf("  convergence  : t90=%.1f s  t100=%.1f s  final reachability=%.3f\n",
+                t90, t100, final_ratio);
+    if (cfg_.fail_node >= 0)
+        std::printf("  failure      : node %d down at %.1f s, all routes restored after %.1f s, "
+                    "routes to it withdrawn after %.1f s\n",
+                    cfg_.fail_node, cfg_.fail_s, recover, withdrawn);
+    for (int k = 0; k < (int)Kind::Count; ++k) {
+        const Counters& c = by_kind_[k];
+        if (!c.tx_frames) continue;
+        std::printf("  tx %-8s   : %7llu frames %9llu B %9.1f s airtime  delivery=%.3f\n",
+                    kindName((Kind)k), (unsigned long long)c.tx_frames,
+                    (unsigned long long)c.tx_bytes, c.tx_airtime_us / 1e6, ratio(c));
+    }
+    std::printf("  control      : %.2f%% of channel time per node\n",
+                n ? 100.0 * ctrl_air / 1e6 / sim_s / n : 0.0);
+    std::printf("  duty cycle   : max %.2f%% per node (all traffic)\n", 100.0 * maxDuty(sim_s));
+    // pesan data: PDR dihitung atas pesan yang punya jalur fisik saat dikirim
+    uint64_t offered = 0, accepted = 0, delivered = 0;
+    std::vector<double> lat_ms;
+    for (const DataMsg& m : data_) {
+        if (!m.connected) continue;
+        offered++;
+        accepted += m.accepted;
+        if (m.delivered_us) {
+            delivered++;
+            lat_ms.push_back((m.delivered_us - m.sent_us) / 1e3);
+        }
+    }
+    std::sort(lat_ms.begin(), lat_ms.end());
+    double pdr = offered ? (double)delivered / offered : 0.0;
+    double lat_avg = lat_ms.empty() ? 0.0 : std::accumulate(lat_ms.begin(), lat_ms.end(), 0.0) / lat_ms.size();
+    double lat_p95 = lat_ms.empty() ? 0.0 : lat_ms[(lat_ms.size() - 1) * 95 / 100];
+    if (!data_.empty())
+        std::printf("  data e2e     : offered=%llu accepted=%llu delivered=%llu pdr=%.3f "
+                    "latency avg=%.0f ms p95=%.0f ms dup=%llu\n",
+                    (unsigned long long)offered, (unsigned long long)accepted,
+                    (unsigned long long)delivered, pdr, lat_avg, lat_p95,
+                    (unsigned long long)data_dup_);
+    if (total_.tx_dropped || total_.tx_evicted || total_.tx_aged)
+        std::printf("  tx queue     : dropped=%llu evicted=%llu aged-first=%llu\n",
+                    (unsigned long long)total_.tx_dropped, (unsigned long long)total_.tx_evicted,
+                    (unsigned long long)total_.tx_aged);
+    if (total_.lbt_busy)
+        std::printf("  lbt          : busy=%llu dropped=%llu\n", (unsigned long long)total_.lbt_busy,
+                    (unsigned long long)total_.lbt_drop);
+    std::printf("  rx           : ok=%llu collision=%llu half-duplex=%llu fading=%llu overrun=%llu\n",
+                (unsigned long long)total_.rx_ok, (unsigned long long)total_.lost_collision,
+                (unsigned long long)total_.lost_half_duplex, (unsigned long long)total_.lost_sensitivity,
+                (unsigned long long)total_.lost_overrun);
+    if (cfg_.stats_collector >= 0)
+        std::printf("  stats report : %llu snapshots received by node %d\n",
+                    (unsigned long long)stats_reports_, cfg_.stats_collector);
+    // counter firmware yang tidak nol, beberapa per baris
+    int col = 0;
+    for (const auto& s : fw_stats_) {
+        if (!s.second) continue;
+        if (col % 4 == 0) std::printf("%s", col ? "\n                 " : "  firmware     : ");
+        std::printf("%s=%llu  ", s.first.c_str(), (unsigned long long)s.second);
+        col++;
+    }
+    if (col) std::printf("\n");
+
+    if (cfg_.json_path.empty()) return;
+    FILE* f = std::fopen(cfg_.json_path.c_str(), "w");
+    if (!f) { std::perror(cfg_.json_path.c_str()); return; }
+    std::fprintf(f, "{\n  \"nodes\": %d,\n  \"topology\": \"%s\",\n  \"seed\": %u,\n"
+                    "  \"sf\": %d,\n  \"bw_hz\": %u,\n  \"sim_s\": %.3f,\n  \"wall_s\": %.3f,\n",
+                 n, cfg_.topology.c_str(), cfg_.seed, modem(0).sf, (unsigned)modem(0).bw_hz,
+                 sim_s, wall_s);
+    std::fprintf(f, "  \"convergence\": { \"t90_s\": %.3f, \"t100_s\": %.3f, \"final_reachability\": %.4f },\n",
+                 t90, t100, final_ratio);
+    if (cfg_.fail_node >= 0)
+        std::fprintf(f, "  \"failure\": { \"node\": %d, \"t_s\": %.3f, \"recover_s\": %.3f, \"withdrawn_s\": %.3f },\n",
+                     cfg_.fail_node, cfg_.fail_s, recover, withdrawn);
+    std::fprintf(f, "  \"max_duty\": %.5f,\n", maxDuty(sim_s));
+    if (!data_.empty())
+        std::fprintf(f, "  \"data\": { \"offered\": %llu, \"accepted\": %llu, \"delivered\": %llu, "
+                        "\"pdr\": %.4f, \"latency_avg_ms\": %.1f, \"latency_p95_ms\": %.1f, \"dup\": %llu },\n",
+                     (unsigned long long)offered, (unsigned long long)accepted,
+                     (unsigned long long)delivered, pdr, lat_avg, lat_p95,
+                     (unsigned long long)data_dup_);
+    std::fprintf(f, "  \"tx\": {");
+    for (int k = 0; k < (int)Kind::Count; ++k) {
+        const Counters& c = by_kind_[k];
+        std::fprintf(f, "%s\n    \"%s\": { \"frames\": %llu, \"bytes\": %llu, \"airtime_s\": %.3f, \"delivery\": %.4f, \"dropped\": %llu, "
+                        "\"evicted\": %llu, \"aged_first\": %llu }",
+                     k ? "," : "", kindName((Kind)k), (unsigned long long)c.tx_frames,
+                     (unsigned long long)c.tx_bytes, c.tx_airtime_us / 1e6, ratio(c),
+                     (unsigned long long)c.tx_dropped, (unsigned long long)c.tx_evicted,
+                     (unsigned long long)c.tx_aged);
+    }
+    std::fprintf(f, "\n  },\n  \"rx\": { \"ok\": %llu, \"collision\": %llu, \"half_duplex\": %llu, "
+                    "\"fading\": %llu, \"overrun\": %llu },\n",
+                 (unsigned long long)total_.rx_ok, (unsigned long long)total_.lost_collision,
+                 (unsigned long long)total_.lost_half_duplex, (unsigned long long)total_.lost_sensitivity,
+                 (unsigned long long)total_.lost_overrun);
+    std::fprintf(f, "  \"lbt\": { \"busy\": %llu, \"dropped\": %llu },\n",
+                 (unsigned long long)total_.lbt_busy, (unsigned long long)total_.lbt_drop);
+    std::fprintf(f, "  \"firmware\": {");
+    for (size_t i = 0; i < fw_stats_.size(); ++i) {
+        std::fprintf(f, "%s\n    \"%s\": %llu", i ? "," : "", fw_stats_[i].first.c_str(),
+                     (unsigned long long)fw_stats_[i].second);
+    }
+    std::fprintf(f, "\n  },\n");
+    if (cfg_.stats_collector >= 0)
+        std::fprintf(f, "  \"stats_reports\": %llu,\n", (unsigned long long)stats_reports_);
+    std::fprintf(f, "  \"samples\": [");
+    for (size_t i = 0; i < samples_.size(); ++i) {
+        std::fprintf(f, "%s\n    [%.1f, %d, %d]", i ? "," : "", samples_[i].t_s,
+                     samples_[i].pairs, samples_[i].reachable);
+    }
+    std::fprintf(f, "\n  ]\n}\n");
+    std::fclose(f);
+}
+
+} // namespace sim
@@ -0,0 +1,251 @@
+#pragma once
+// sim.h — discrete-event mesh simulator untuk LoRaRouting (host/Linux).
+//
+// Model:
+//  - jam global dalam mikrodetik; tiap node punya offset boot sendiri
+//  - kanal: log-distance path loss + shadowing per link (simetris) +
+//    fading per paket, SNR vs ambang demodulasi per SF
+//  - tabrakan: frame gagal bila ada frame lain yang tumpang tindih dengan
+//    daya kurang dari CAPTURE_DB di bawahnya; half-duplex (TX membutakan RX)
+//  - airtime dihitung loraTimeOnAirUs() dari konfigurasi modem yang sama
+//    dengan set_modem() (lora_airtime.h), per frame sesuai DR-nya (ADR);
+//    pindai CAD driver dimodelkan ideal: radio yang idle menangkap frame di
+//    DR mana pun, dengan ambang SNR dan noise floor DR frame itu
+//  - listen-before-talk driver: CAD (loraCadTimeUs) sebelum tiap frame;
+//    kanal sibuk bila frame lain di SF/BW yang sama sedang di udara dan
+//    terdengar di atas sensitivitas, lalu backoff sx1276_lbt_backoff_us()
+//  - antrean TX per kelas prioritas (TxPrio) dengan kedalaman, drop policy
+//    dan HOL aging yang sama dengan driver
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <deque>
+#include <map>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "node_api.h"
+#include "lora_sx1276.h"
+
+namespace sim {
+
+// ====== Parameter skenario ======
+struct Config {
+    int         nodes        = 10;
+    std::string topology     = "grid";   // grid | random | line
+    double      spacing_m    = 2000.0;   // grid/line
+    double      area_m       = 8000.0;   // random: sisi persegi
+    double      duration_s   = 600.0;
+    double      boot_jitter_s = 5.0;     // node tidak menyala bersamaan
+    double      sample_s     = 5.0;      // interval sampling metrik
+    int         probe_pairs  = 2000;     // maksimum pasangan (src,dst) per sampel
+    uint32_t    seed         = 1;
+    int         fail_node    = -1;       // node yang dimatikan di tengah simulasi
+    double      fail_s       = 0.0;
+    double      data_interval_s = 0.0;   // trafik data per node (rata-rata, eksponensial); 0 = mati
+    int         data_len     = 20;       // payload aplikasi (byte, >= 4)
+    double      data_start_s = 60.0;     // mulai trafik setelah rute terbentuk
+    int         stats_collector = -1;    // laporan statistik firmware ke node ini; -1 = mati
+    double      stats_interval_s = 300.0;
+
+    double      tx_power_dbm = 14.0;
+    double      pl_d0_db     = 40.0;     // path loss di 1 m
+    double      pl_exp       = 2.7;
+    double      shadowing_db = 4.0;      // sigma, tetap per link
+    double      fading_db    = 2.0;      // sigma, per paket
+    double      noise_fig_db = 6.0;
+    double      capture_db   = 6.0;
+
+    std::string json_path;
+    std::string module_path;
+};
+
+// ====== Frame di udara ======
+struct Transmission {
+    int                  src;
+    uint64_t             start_us;
+    uint64_t             end_us;
+    uint8_t              dr = 0;
+    std::vector<uint8_t> bytes;
+};
+
+struct Counters {
+    uint64_t tx_frames = 0, tx_bytes = 0, tx_airtime_us = 0;
+    uint64_t tx_dropped = 0;         // antrean kelas TX penuh
+    uint64_t tx_evicted = 0;         // digusur frame baru (kelas drop-oldest)
+    uint64_t tx_aged = 0;            // didahulukan karena HOL aging
+    uint64_t rx_ok = 0;
+    uint64_t lost_sensitivity = 0;   // dalam jangkauan rata-rata, gagal karena fading
+    uint64_t lost_collision = 0;
+    uint64_t lost_half_duplex = 0;
+    uint64_t lost_overrun = 0;       // antrean RX penuh (LORA_RX_QUEUE_LEN)
+    uint64_t lbt_busy = 0;           // CAD menemukan kanal sibuk (backoff)
+    uint64_t lbt_drop = 0;           // dibuang setelah LORA_LBT_MAX_TRIES
+};
+
+// kategori lalu lintas berdasarkan prefix payload
+enum class Kind : int { Hello = 0, Routing, Data, Ack, Other, Count };
+const char* kindName(Kind k);
+Kind classify(const uint8_t* data, size_t len);
+
+// frame di antrean TX driver (cermin TxFrame di lora_sx1276.cpp)
+struct TxFrame {
+    uint8_t              dr;
+    uint64_t             queued_us;   // jam global saat masuk antrean
+    std::vector<uint8_t> bytes;
+};
+
+// paket di antrean RX driver (cermin RxPacket di lora_sx1276.cpp)
+struct RxFrame {
+    int64_t  time_us;       // jam lokal node saat RxDone
+    int      rssi;
+    int      snr_x4;        // SNR (0.25 dB)
+    uint8_t  dr;
+    uint16_t len;
+    std::array<uint8_t, 256> data;
+};
+
+struct Node {
+    int      id = 0;
+    uint8_t  mac[6] = {0};
+    double   x = 0, y = 0;
+
+    // firmware image
+    void*             handle = nullptr;
+    const SimNodeApi* api = nullptr;
+
+    // waktu
+    uint64_t boot_us = 0;
+    uint64_t local_us = 0;       // jam node selama handler
+    uint64_t idle_us = 0;        // akhir iterasi terakhir (node sibuk sebelum ini)
+    uint64_t wake_us = 0;        // jadwal bangun saat ini
+    uint32_t wake_gen = 0;       // untuk membatalkan event bangun lama
+    bool     booted = false;
+    bool     down = false;           // dimatikan (--fail): tidak TX/RX lagi
+
+    std::mt19937 rng;
+
+    // radio (cermin state driver lora_sx1276.cpp)
+    uint8_t  txbuf[256];
+    size_t   txlen = 0;
+    uint8_t  txdr = 0;           // DR frame yang sedang disusun
+    TxPrio   txprio = TxPrio::Local;
+    std::array<std::deque<TxFrame>, TX_PRIO_COUNT> txq;   // antrean per kelas
+    TxFrame  txcur{};            // frame yang dipegang task radio (CAD / backoff)
+    bool     tx_busy = false;
+    bool     lbt_wait = false;   // CAD / backoff untuk txcur berjalan
+    uint8_t  lbt_tries = 0;
+    uint32_t tx_dropped = 0;
+    uint64_t tx_airtime_us = 0;  // duty cycle per node
+    void   (*tx_done_cb)(bool, void*) = nullptr;
+    void*    tx_done_arg = nullptr;
+    std::deque<RxFrame> rxq;     // diisi "task radio" saat RxDone
+    RxFrame  rx{};               // paket yang sedang dibaca firmware
+    int      rx_idx = 0;
+    uint32_t rx_dropped = 0;
+};
+
+struct Event {
+    uint64_t t_us;
+    uint64_t seq;
+    enum Type { Boot, Wake, TxEnd, Cad, Sample, Fail, Data } type;
+    int      node;
+    uint32_t gen;
+    size_t   tx;
+    bool operator>(const Event& o) const {
+        return t_us != o.t_us ? t_us > o.t_us : seq > o.seq;
+    }
+};
+
+struct Sample {
+    double t_s;
+    int    pairs;
+    int    reachable;
+    int    stale;      // node hidup yang masih punya rute ke node --fail yang mati
+};
+
+// satu pesan aplikasi (sendData) end-to-end; id dibawa di 4 byte pertama payload
+struct DataMsg {
+    int      src, dst;
+    uint64_t sent_us;
+    uint64_t delivered_us = 0;    // 0 = belum sampai
+    bool     connected;           // ada jalur fisik saat dikirim
+    bool     accepted;            // sendData() tidak menolak
+};
+
+class World {
+public:
+    explicit World(const Config& cfg);
+    ~World();
+
+    bool load(std::string& err);
+    void run();
+    void report(double wall_s) const;
+
+    // ---- dipanggil dari backend (sx1276_* / esp_*) untuk node aktif ----
+    Node&    current()       { return *cur_; }
+    bool     hasCurrent() const { return cur_ != nullptr; }
+    uint64_t now() const     { return now_us_; }
+    bool     transmit(Node& n);      // sx1276_end_packet(): masuk antrean TX
+    void     delivered(Node& n, int src, const uint8_t* payload, size_t len);
+
+private:
+    void place();
+    void buildLinks();
+    void buildComponents();
+    void fail(Node& n);
+    void schedule(const Event& e);
+    void wakeAt(Node& n, uint64_t t_us);
+    void runNode(Node& n, bool boot);
+    void channelAccess(Node& n);
+    bool dequeueTx(Node& n);
+    void onCad(Node& n);
+    bool channelBusy(const Node& n, uint8_t dr);
+    void startTx(Node& n);
+    void onTxEnd(size_t txIdx);
+    void sample();
+    void sendData(Node& n);
+    void collectFirmwareStats();
+    bool connected(int a, int b) const;
+    double maxDuty(double sim_s) const;
+    Kind   kindOf(const uint8_t* data, size_t len);
+
+    double meanRssi(int a, int b) const { return rssi_[(size_t)a * nodes_.size() + b]; }
+    const Transmission& tx(size_t idx) const { return history_[idx - history_base_]; }
+
+    Config                   cfg_;
+    std::vector<Node>        nodes_;
+    std::vector<double>      rssi_;        // mean RSSI matriks NxN
+    std::vector<int>         component_;   // komponen terhubung (link usable, node hidup)
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> q_;
+    std::deque<Transmission> history_;
+    size_t                   history_base_ = 0;   // indeks global elemen history_[0]
+    uint64_t                 now_us_ = 0;
+    uint64_t                 seq_ = 0;
+    Node*                    cur_ = nullptr;
+    std::mt19937             chan_rng_;
+    std::string              tmpdir_;
+
+    Counters                 total_;
+    Counters                 by_kind_[(int)Kind::Count];
+    std::vector<Sample>      samples_;
+    std::mt19937             data_rng_;
+    std::vector<DataMsg>     data_;
+    uint64_t                 data_dup_ = 0;   // pesan yang sampai lebih dari sekali
+    uint64_t                 stats_reports_ = 0;          // laporan statistik sampai di kolektor
+    std::vector<std::pair<std::string, uint64_t>> fw_stats_;  // counter firmware, jumlah semua node
+    std::map<uint32_t, Kind> frag_kind_;      // (link src, id) -> kind datagram asal
+};
+
+extern World* g_world;
+
+// ====== PHY helper ======
+uint32_t airtimeUs(size_t payloadLen, uint8_t dr = 0);
+double   noiseFloorDbm(double nf_db, uint8_t dr = 0);
+double   snrThresholdDb(int sf);
+// RSSI minimum frame DR dr (noise floor + ambang demodulasi SF-nya)
+double   sensitivityDbm(double nf_db, uint8_t dr = 0);
+
+} // namespace sim
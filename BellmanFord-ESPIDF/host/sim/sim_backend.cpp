@@ -0,0 +1,176 @@
+// sim_backend.cpp — implementasi host untuk API yang dipanggil firmware:
+// driver sx1276_* (lora_sx1276.h) dan shim ESP-IDF (esp_timer, esp_mac,
+// esp_random, esp_log, vTaskDelay). Semuanya bekerja pada node yang sedang
+// dieksekusi oleh simulator (World::current()).
+//
+// Simbol-simbol ini diekspor dari executable (ENABLE_EXPORTS) dan di-resolve
+// oleh setiap salinan modul lora_node saat dlopen().
+
+#include "sim.h"
+#include "lora_sx1276.h"
+
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+using sim::g_world;
+
+// ====== Driver SX1276 virtual ======
+bool sx1276_begin() {
+    return true;
+}
+
+void sx1276_begin_packet(uint8_t dr, TxPrio prio) {
+    sim::Node& n = g_world->current();
+    n.txdr   = dr < loraDrCount() ? dr : 0;
+    n.txprio = (int)prio < TX_PRIO_COUNT ? prio : TxPrio::Local;
+    n.txlen  = 0;
+}
+
+void sx1276_write(const char* data, size_t len) {
+    sim::Node& n = g_world->current();
+    if (!data || len == 0) return;
+    size_t space = sizeof(n.txbuf) - n.txlen;
+    if (len > space) len = space;   // truncate seperti driver asli
+    std::memcpy(&n.txbuf[n.txlen], data, len);
+    n.txlen += len;
+}
+
+bool sx1276_end_packet() {
+    return g_world->transmit(g_world->current());
+}
+
+void sx1276_on_tx_done(sx1276_tx_done_cb_t cb, void* arg) {
+    sim::Node& n = g_world->current();
+    n.tx_done_cb  = cb;
+    n.tx_done_arg = arg;
+}
+
+uint32_t sx1276_tx_room(TxPrio prio) {
+    const sim::Node& n = g_world->current();
+    if ((int)prio >= TX_PRIO_COUNT) return 0;
+    if (sx1276_tx_drop_oldest(prio)) return sx1276_tx_depth(prio);
+    size_t used = n.txq[(int)prio].size();
+    return used < sx1276_tx_depth(prio) ? (uint32_t)(sx1276_tx_depth(prio) - used) : 0u;
+}
+
+uint32_t sx1276_tx_free(TxPrio prio) {
+    const sim::Node& n = g_world->current();
+    if ((int)prio >= TX_PRIO_COUNT) return 0;
+    size_t used = n.txq[(int)prio].size();
+    return used < sx1276_tx_depth(prio) ? (uint32_t)(sx1276_tx_depth(prio) - used) : 0u;
+}
+
+uint32_t sx1276_tx_pending() {
+    const sim::Node& n = g_world->current();
+    uint32_t queued = 0;
+    for (const auto& q : n.txq) queued += (uint32_t)q.size();
+    return queued + (n.tx_busy || n.lbt_wait ? 1u : 0u);
+}
+
+// Menunggu tidak disimulasikan di sini: penjadwal event membangunkan node
+// saat paket masuk antrean, jadi timeout diabaikan.
+int sx1276_wait_packet(uint32_t) {
+    sim::Node& n = g_world->current();
+    n.rx.len = 0;   // paket sebelumnya dilepas (cermin slot pool driver)
+    if (n.rxq.empty()) return 0;
+    n.rx = n.rxq.front();
+    n.rxq.pop_front();
+    n.rx_idx = 0;
+    return n.rx.len;
+}
+
+int sx1276_parse_packet() {
+    return sx1276_wait_packet(0);
+}
+
+Sx1276RxView sx1276_rx_view() {
+    sim::Node& n = g_world->current();
+    Sx1276RxView v{};
+    if (n.rx.len == 0) return v;
+    v.data    = n.rx.data.data();
+    v.len     = n.rx.len;
+    v.rssi    = n.rx.rssi;
+    v.snr_x4  = n.rx.snr_x4;
+    v.time_us = n.rx.time_us;
+    v.dr      = n.rx.dr;
+    return v;
+}
+
+int sx1276_read_byte() {
+    sim::Node& n = g_world->current();
+    if (n.rx_idx >= n.rx.len) return -1;
+    return (int)n.rx.data[n.rx_idx++];
+}
+
+int sx1276_packet_rssi() {
+    const sim::Node& n = g_world->current();
+    return n.rx.len ? n.rx.rssi : -127;
+}
+
+int64_t sx1276_packet_time_us() {
+    return g_world->current().rx.time_us;
+}
+
+uint32_t sx1276_rx_dropped() {
+    return g_world->current().rx_dropped;
+}
+
+const LoraModemConfig& sx1276_modem_config() {
+    static const LoraModemConfig cfg = loraModemConfigForDr(0);
+    return cfg;
+}
+
+// ====== Hook data plane (node_api.h) ======
+extern "C" void sim_data_delivered(int srcId, const uint8_t* payload, size_t len) {
+    g_world->delivered(g_world->current(), srcId, payload, len);
+}
+
+// ====== Shim ESP-IDF ======
+extern "C" {
+
+esp_log_level_t esp_log_host_level = ESP_LOG_NONE;
+
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...) {
+    static const char letters[] = "NEWIDV";
+    char msg[512];
+    va_list ap;
+    va_start(ap, format);
+    std::vsnprintf(msg, sizeof(msg), format, ap);
+    va_end(ap);
+
+    // log dari luar konteks node (mis. saat load) tidak punya node aktif
+    int id = -1;
+    uint64_t t = 0;
+    if (g_world && g_world->hasCurrent()) {
+        id = g_world->current().id;
+        t  = g_world->current().local_us;
+    }
+    std::printf("[%10.3f] N%03d %c (%s) %s\n", t / 1e6, id, letters[level], tag, msg);
+}
+
+int64_t esp_timer_get_time(void) {
+    const sim::Node& n = g_world->current();
+    return (int64_t)(n.local_us - n.boot_us);
+}
+
+esp_err_t esp_read_mac(uint8_t* mac, esp_mac_type_t) {
+    std::memcpy(mac, g_world->current().mac, 6);
+    return ESP_OK;
+}
+
+uint32_t esp_random(void) {
+    return (uint32_t)g_world->current().rng();
+}
+
+void vTaskDelay(TickType_t ticks) {
+    g_world->current().local_us += (uint64_t)ticks * 1000u;
+}
+
+} // extern "C"
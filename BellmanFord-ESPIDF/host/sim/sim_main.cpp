@@ -0,0 +1,118 @@
+// sim_main.cpp — CLI lora_sim
+//
+// Contoh:
+//   lora_sim --nodes 10 --duration 900
+//   lora_sim --nodes 300 --topology random --area 30000 --json run.json
+
+#include "sim.h"
+#include "esp_log.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#ifndef LORA_SIM_MODULE_PATH
+#define LORA_SIM_MODULE_PATH "liblora_node.so"
+#endif
+
+static void usage(const char* prog) {
+    std::printf(
+        "usage: %s [options]\n"
+        "  --nodes N          jumlah node, 1..256 (default 10)\n"
+        "  --topology T       grid | random | line (default grid)\n"
+        "  --spacing M        jarak antar node grid/line, meter (default 2000)\n"
+        "  --area M           sisi area untuk topology random, meter (default 8000)\n"
+        "  --duration S       waktu simulasi, detik (default 600)\n"
+        "  --boot-jitter S    sebaran waktu boot node, detik (default 5)\n"
+        "  --sample S         interval sampling metrik, detik (default 5)\n"
+        "  --probe-pairs N    maks pasangan (src,dst) per sampel (default 2000)\n"
+        "  --seed N           seed PRNG (default 1)\n"
+        "  --fail ID@S        matikan node ID pada detik S (ukur rekonvergensi)\n"
+        "  --data-interval S  trafik data: rata-rata jeda pesan per node, detik (default 0 = mati)\n"
+        "  --data-len N       payload pesan data, byte (default 20)\n"
+        "  --data-start S     mulai trafik data pada detik S (default 60)\n"
+        "  --stats-report ID[@S]  laporan statistik firmware ke node ID tiap S detik (default 300)\n"
+        "  --tx-power DBM     daya TX (default 14)\n"
+        "  --pl-exp N         eksponen path loss (default 2.7)\n"
+        "  --shadowing DB     sigma shadowing per link (default 4)\n"
+        "  --fading DB        sigma fading per paket (default 2)\n"
+        "  --capture DB       ambang capture tabrakan (default 6)\n"
+        "  --log LEVEL        none|error|warn|info|debug (default none)\n"
+        "  --json FILE        tulis hasil dalam format JSON\n"
+        "  --module PATH      modul firmware (default %s)\n",
+        prog, LORA_SIM_MODULE_PATH);
+}
+
+static int parseLogLevel(const char* s) {
+    static const char* names[] = { "none", "error", "warn", "info", "debug", "verbose" };
+    for (int i = 0; i < 6; ++i) if (std::strcmp(s, names[i]) == 0) return i;
+    return -1;
+}
+
+int main(int argc, char** argv) {
+    sim::Config cfg;
+    cfg.module_path = LORA_SIM_MODULE_PATH;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) { std::fprintf(stderr, "missing value for %s\n", a.c_str()); std::exit(2); }
+            return argv[++i];
+        };
+        if      (a == "--nodes")        cfg.nodes = std::atoi(next());
+        else if (a == "--topology")     cfg.topology = next();
+        else if (a == "--spacing")      cfg.spacing_m = std::atof(next());
+        else if (a == "--area")         cfg.area_m = std::atof(next());
+        else if (a == "--duration")     cfg.duration_s = std::atof(next());
+        else if (a == "--boot-jitter")  cfg.boot_jitter_s = std::atof(next());
+        else if (a == "--sample")       cfg.sample_s = std::atof(next());
+        else if (a == "--probe-pairs")  cfg.probe_pairs = std::atoi(next());
+        else if (a == "--seed")         cfg.seed = (uint32_t)std::strtoul(next(), nullptr, 10);
+        else if (a == "--fail") {
+            if (std::sscanf(next(), "%d@%lf", &cfg.fail_node, &cfg.fail_s) != 2) { usage(argv[0]); return 2; }
+        }
+        else if (a == "--data-interval") cfg.data_interval_s = std::atof(next());
+        else if (a == "--data-len")     cfg.data_len = std::atoi(next());
+        else if (a == "--data-start")   cfg.data_start_s = std::atof(next());
+        else if (a == "--stats-report") {
+            if (std::sscanf(next(), "%d@%lf", &cfg.stats_collector, &cfg.stats_interval_s) < 1) {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+        else if (a == "--tx-power")     cfg.tx_power_dbm = std::atof(next());
+        else if (a == "--pl-exp")       cfg.pl_exp = std::atof(next());
+        else if (a == "--shadowing")    cfg.shadowing_db = std::atof(next());
+        else if (a == "--fading")       cfg.fading_db = std::atof(next());
+        else if (a == "--capture")      cfg.capture_db = std::atof(next());
+        else if (a == "--json")         cfg.json_path = next();
+        else if (a == "--module")       cfg.module_path = next();
+        else if (a == "--log") {
+            int lvl = parseLogLevel(next());
+            if (lvl < 0) { usage(argv[0]); return 2; }
+            esp_log_host_level = (esp_log_level_t)lvl;
+        }
+        else { usage(argv[0]); return a == "--help" || a == "-h" ? 0 : 2; }
+    }
+    if (cfg.nodes < 1 || cfg.nodes > 256 || cfg.duration_s <= 0 || cfg.sample_s <= 0 ||
+        cfg.data_interval_s < 0 || cfg.data_len < 4 || cfg.data_len > 4096 ||
+        cfg.stats_collector >= cfg.nodes || cfg.stats_interval_s < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    sim::World world(cfg);
+    std::string err;
+    if (!world.load(err)) {
+        std::fprintf(stderr, "lora_sim: %s\n", err.c_str());
+        return 1;
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    world.run();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    world.report(wall);
+    return 0;
+}
@@ -5,8 +5,18 @@
 #include "board.h"
 #include "node.h"
 #include "lora_sx1276.h"
+#include "routing_wire.h"
+#include "distance_vector.h"
+#include "lora_airtime.h"
+#include "airtime_scheduler.h"
+#include "lora_frag.h"
+#include "lora_arq.h"
+#include "lora_stats.h"
+#include "trickle.h"
 
 #include <algorithm>
+#include <bitset>
+#include <charconv>
 #include <cstring>
 #include <cstdio>
 #include <cstdlib>
@@ -18,31 +28,178 @@
 
 static const char *TAG = "LoRaRouting";
 
-RoutingEntry routingTable[10]; // simpan hingga 10 entry
+RoutingTable<ROUTING_MAX_NODES> routingTable; // diindeks node_id
+
+// Waktu (ms) terakhir tetangga terdengar mengirim Hello TANPA WIRE_HELLO_CAP
+// (firmware lama -> hanya paham teks). 0 = belum pernah.
+static uint32_t s_legacyPeerSeen[ROUTING_MAX_NODES];
+static constexpr uint32_t LEGACY_PEER_TIMEOUT_MS = 60000;
+// sama untuk Hello tanpa WIRE_HELLO_DSEQ: parser teks lama menolak entri
+// ROUTINGID yang membawa nomor urut tujuan
+static uint32_t s_noDseqPeerSeen[ROUTING_MAX_NODES];
+// tetangga yang Hello terakhirnya membawa WIRE_HELLO_ARQ (menjawab frame data dengan ACK)
+static std::bitset<ROUTING_MAX_NODES> s_arqPeer;
+
+// tetangga yang tidak terdengar selama ini dihapus (rute lewatnya ikut hilang)
+static constexpr uint32_t NEIGHBOR_TIMEOUT_MS = 60000;
+
+static bool recomputeRoutes();
+static void printNeighborTable();
+static void advertInit();
+static void dataInit();
+static void requestResync(int nbrId);
+static void onResyncRequest(const uint8_t* raw, size_t len);
+static void cancelResync(int nbrId);
+static void helloSoon();
+static uint32_t helloIntervalMs();
+static void kickDestSeq(int nbrId);
+static bool helloCarriesSeq();
+static uint16_t currentAdvertSeq();
+static void sendRoutingUpdate(bool full, TxPrio prio);
+static void onDataFrame(uint8_t* frame, size_t len);
+static void onAck(const uint8_t* raw, size_t len);
 
 // ===== waktu (ms) =====
 static inline uint32_t now_ms() {
     return (uint32_t)(esp_timer_get_time() / 1000ULL);
 }
 
-// ===== helper upper-case =====
-static inline std::string upper(std::string s) {
-    std::transform(s.begin(), s.end(), s.begin(),
-                   [](unsigned char c){ return (unsigned char)std::toupper(c); });
-    return s;
-}
-
 // ====== RADIO (wrapper ke driver SX1276) ======
 static bool radio_begin()                          { return sx1276_begin(); }
-static void radio_begin_packet()                   { sx1276_begin_packet(); }
+static void radio_begin_packet(uint8_t dr, TxPrio prio) { sx1276_begin_packet(dr, prio); }
 static void radio_write(const char *data, size_t len){ sx1276_write(data, len); }
-static void radio_end_packet()                     { sx1276_end_packet(); }
+static bool radio_end_packet()                     { return sx1276_end_packet(); }
 static int  radio_parse_packet()                   { return sx1276_parse_packet(); }
-static int  radio_read_byte()                      { return sx1276_read_byte(); }
-static int  radio_packet_rssi()                    { return sx1276_packet_rssi(); }
+static Sx1276RxView radio_rx_view()                { return sx1276_rx_view(); }
+
+static bool radio_tx(const void* data, size_t len, TxPrio prio, uint8_t dr = 0) {
+    radio_begin_packet(dr, prio);
+    radio_write((const char*)data, len);
+    if (!radio_end_packet()) {
+        statInc(Stat::TxQueueFull);
+        return false;
+    }
+    statInc(Stat::TxFrames);
+    statInc(Stat::TxBytes, (uint32_t)len);
+    return true;
+}
+
+// kelas antrean tidak punya ruang: jangan memotong jatah airtime
+static bool radio_room(TxPrio prio, size_t count) {
+    if (sx1276_tx_room(prio) >= count) return true;
+    ESP_LOGW(TAG, "Drop TX: no room for %u frame(s) in TX queue %u", (unsigned)count, (unsigned)prio);
+    statInc(Stat::TxQueueFull);
+    return false;
+}
+
+static void statAirtime(AirClass cls, uint32_t toaUs) {
+    static constexpr Stat kAir[AIR_CLASS_COUNT] = {
+        Stat::TxAirtimeDataUs, Stat::TxAirtimeRoutingUs, Stat::TxAirtimeHelloUs
+    };
+    statInc(kAir[(int)cls], toaUs);
+}
+
+// frame unicast di atas DR dasar (ADR): hemat airtime terhadap DR 0
+static void statFastDr(uint8_t dr, size_t len, uint32_t count, uint32_t toaUs) {
+    if (dr == 0) return;
+    statInc(Stat::TxFastDr, count);
+    uint32_t base = count * loraTimeOnAirUs(sx1276_modem_config(), len);
+    if (base > toaUs) statInc(Stat::TxAirtimeSavedUs, base - toaUs);
+}
+
+// Semua TX lewat sini: time-on-air dihitung dari konfigurasi modem DR frame
+// (dr = 0: broadcast / DR dasar), lalu dimintakan jatah ke scheduler airtime.
+// admitted = jatah sudah dicek pemanggil (frame lanjutan satu iklan), cukup
+// dipotong. prio = kelas antrean TX (lora_sx1276.h). false = tidak dikirim
+// (dwell time / jatah kelas habis / antrean kelas penuh).
+static bool radio_send(AirClass cls, TxPrio prio, const void* data, size_t len, bool admitted = false,
+                       uint8_t dr = 0) {
+    uint32_t toa = loraTimeOnAirUs(loraModemConfigForDr(dr), len);
+    if (!airtimeDwellOk(toa)) {
+        ESP_LOGE(TAG, "Drop TX: %u B = %u us on air exceeds dwell limit", (unsigned)len, (unsigned)toa);
+        statInc(Stat::TxDwellDrop);
+        return false;
+    }
+    if (!radio_room(prio, 1)) return false;
+    if (admitted) airtimeCharge(cls, toa);
+    else if (!airtimeAcquire(cls, toa)) {
+        statInc(Stat::TxBudgetDrop);
+        return false;
+    }
+
+    statAirtime(cls, toa);
+    statFastDr(dr, len, 1, toa);
+    return radio_tx(data, len, prio, dr);
+}
+
+// frame terpanjang (routing / data) yang masih memenuhi dwell time
+static size_t s_maxFrameLen = WIRE_MAX_FRAME_LEN;
+// datagram terpanjang (terfragmentasi): semua fragmen harus muat antrean
+// kelas TX terkecil
+static size_t s_maxDatagramLen = WIRE_MAX_FRAME_LEN;
+
+// Datagram > satu frame dipecah (lora_frag.h) dan dikirim utuh atau tidak
+// sama sekali: jatah airtime semua fragmen diminta sekaligus. linkDst =
+// penerima fragmen (-1 = broadcast); unicast dikirim di DR yang diminta
+// penerima (dvTxDr).
+static uint16_t s_fragId = 0;
+static uint16_t s_helloSeq = 0;   // nomor urut Hello (WIRE_HELLO_NUM)
+static uint8_t  s_destSeq  = 0;   // nomor urut tujuan milik node ini (WIRE_HELLO_DSEQ)
+static uint8_t  s_fragFrame[WIRE_MAX_FRAME_LEN];
+
+// time-on-air datagram len byte di DR dr (semua fragmen)
+static uint32_t datagramAirUs(size_t len, uint8_t dr) {
+    LoraModemConfig modem = loraModemConfigForDr(dr);
+    if (len <= s_maxFrameLen) return loraTimeOnAirUs(modem, len);
+    size_t count = fragCount(len, s_maxFrameLen);
+    if (count == 0) return 0;
+    size_t chunk = s_maxFrameLen - WIRE_FRAG_HDR_LEN;
+    size_t last  = WIRE_FRAG_HDR_LEN + len - (count - 1) * chunk;
+    return (uint32_t)(count - 1) * loraTimeOnAirUs(modem, s_maxFrameLen) + loraTimeOnAirUs(modem, last);
+}
+
+static bool radio_send_datagram(AirClass cls, TxPrio prio, const uint8_t* data, size_t len, int linkDst,
+                                bool admitted = false) {
+    uint8_t dr = linkDst >= 0 ? dvTxDr(linkDst) : 0;
+    if (len <= s_maxFrameLen) return radio_send(cls, prio, data, len, admitted, dr);
+
+    size_t count = fragCount(len, s_maxFrameLen);
+    if (count == 0 || len > s_maxDatagramLen) {
+        ESP_LOGE(TAG, "Drop TX: %u B datagram exceeds %u B limit", (unsigned)len, (unsigned)s_maxDatagramLen);
+        statInc(Stat::TxDwellDrop);
+        return false;
+    }
+    // count <= kedalaman kelas (s_maxDatagramLen): di kelas drop-oldest
+    // fragmen hanya menggusur frame lama, tidak pernah sesamanya
+    if (!radio_room(prio, count)) return false;
+    LoraModemConfig modem = loraModemConfigForDr(dr);
+    size_t chunk = s_maxFrameLen - WIRE_FRAG_HDR_LEN;
+    size_t last  = WIRE_FRAG_HDR_LEN + len - (count - 1) * chunk;
+    uint32_t toa = datagramAirUs(len, dr);
+    if (admitted) airtimeCharge(cls, toa);
+    else if (!airtimeAcquire(cls, toa)) {
+        statInc(Stat::TxBudgetDrop);
+        return false;
+    }
+
+    statAirtime(cls, toa);
+    if (dr) {
+        statFastDr(dr, s_maxFrameLen, (uint32_t)(count - 1), toa - loraTimeOnAirUs(modem, last));
+        statFastDr(dr, last, 1, loraTimeOnAirUs(modem, last));
+    }
+    uint16_t id = s_fragId++;
+    for (size_t i = 0; i < count; i++) {
+        size_t n = fragBuild(s_fragFrame, sizeof(s_fragFrame), data, len, s_maxFrameLen,
+                             NODE_ID, linkDst, id, i);
+        radio_tx(s_fragFrame, n, prio, dr);
+    }
+    ESP_LOGI(TAG, "Datagram %u B sent as %u fragments (id %u)", (unsigned)len, (unsigned)count, (unsigned)id);
+    return true;
+}
 
-// Wrapper publik agar main.cpp bisa polling RX
+// Wrapper publik untuk RX dari main.cpp
 int LoRa_ParsePacket() { return radio_parse_packet(); }
+int LoRa_WaitPacket(uint32_t timeoutMs) { return sx1276_wait_packet(timeoutMs); }
 
 // ====== Implementasi getMacAddress() versi ESP-IDF ======
 static uint8_t g_mac[6] = {0};
@@ -54,11 +211,32 @@ const uint8_t* getMacAddress() {
 }
 
 // -------------------- Radio Init --------------------
+static uint32_t txMinDepth() {
+    uint32_t depth = UINT32_MAX;
+    for (int p = 0; p < TX_PRIO_COUNT; p++) depth = std::min(depth, sx1276_tx_depth((TxPrio)p));
+    return depth;
+}
+
 void initLoRa() {
     if (!radio_begin()) {
         ESP_LOGE(TAG, "Starting LoRa failed!");
         abort();
     }
+    size_t dwellLen = loraMaxPayloadForAirtime(sx1276_modem_config(),
+                                               (uint32_t)AIRTIME_MAX_DWELL_MS * 1000u);
+    if (dwellLen < WIRE_ROUTING_V2_HDR_LEN + WIRE_ROUTING_ENTRY_LEN) {
+        ESP_LOGE(TAG, "SF%d/BW%u cannot meet the %d ms dwell limit",
+                 sx1276_modem_config().sf, (unsigned)sx1276_modem_config().bw_hz, AIRTIME_MAX_DWELL_MS);
+        dwellLen = WIRE_ROUTING_V2_HDR_LEN + WIRE_ROUTING_ENTRY_LEN;
+    }
+    s_maxFrameLen = std::min(dwellLen, WIRE_MAX_FRAME_LEN);
+    s_maxDatagramLen = std::min<size_t>(FRAG_MAX_DATAGRAM,
+        std::min<size_t>(WIRE_FRAG_MAX_COUNT, txMinDepth()) * (s_maxFrameLen - WIRE_FRAG_HDR_LEN));
+    s_fragId = (uint16_t)esp_random();
+    s_helloSeq = (uint16_t)esp_random();
+    s_destSeq  = (uint8_t)(esp_random() & ~1u);
+    advertInit();
+    dataInit();
     ESP_LOGI(TAG, "LoRa Initialized (native SX1276). F=%.0f Hz SF=%d BW=%.0f Hz P=%d dBm",
              (double)LORA_FREQ_HZ, (int)LORA_SF, (double)LORA_BW, (int)LORA_TX_POWER_DBM);
 }
@@ -72,17 +250,8 @@ std::string macToString(const uint8_t *macAddr) {
 }
 
 // legacy helper (fallback mac-based calls)
-int getDestinationFromMac(const std::string& mac_in) {
-    std::string mac = upper(mac_in);
-    if (mac == macToString(NODE_0)) return 0;
-    if (mac == macToString(NODE_1)) return 1;
-    if (mac == macToString(NODE_2)) return 2;
-    if (mac == macToString(NODE_3)) return 3;
-    if (mac == macToString(NODE_4)) return 4;
-    if (mac == macToString(NODE_5)) return 5;
-    if (mac == macToString(NODE_6)) return 6;
-    if (mac == macToString(NODE_7)) return 7;
-    return -1;
+int getDestinationFromMac(const std::string& mac) {
+    return macToNodeId(mac);
 }
 
 // -------------------- Hello --------------------
@@ -91,46 +260,168 @@ void sendHelloMessages() {
     snprintf(nodeName, sizeof(nodeName), "NODE_%d", NODE_ID);
 
     std::string message = std::string("Hello from ") + nodeName;
-    std::string macString = macToString(getMacAddress());
-    message += " MAC: " + macString;
+#if ROUTING_WIRE_MODE != 0
+    message += std::string(" ") + WIRE_HELLO_CAP;
+#endif
+#if ARQ_ENABLE
+    message += std::string(" ") + WIRE_HELLO_ARQ;
+#endif
+    char seq[16];
+#if ROUTING_WIRE_MODE != 0
+    snprintf(seq, sizeof(seq), " %s%u", WIRE_HELLO_NUM, (unsigned)s_helloSeq);
+    message += seq;
+#endif
+    snprintf(seq, sizeof(seq), " %s%u", WIRE_HELLO_DSEQ, (unsigned)s_destSeq);
+    message += seq;
+    // interval Trickle di atas Imin: tetangga memperpanjang timeout
+    uint32_t ivl = helloIntervalMs();
+    if (ivl) {
+        snprintf(seq, sizeof(seq), " %s%u", WIRE_HELLO_IVL, (unsigned)((ivl + 999) / 1000));
+        message += seq;
+    }
+    if (helloCarriesSeq()) {
+        snprintf(seq, sizeof(seq), " %s%u", WIRE_HELLO_SEQ, (unsigned)currentAdvertSeq());
+        message += seq;
+    }
+    std::string mac = " MAC: " + macToString(getMacAddress());
 
-    radio_begin_packet();
-    radio_write(message.c_str(), message.size());
-    radio_end_packet();
+    // DR unicast yang kita minta dari tiap tetangga (ADR, dari SNR link);
+    // Hello tetap di bawah dwell time: tetangga yang tidak muat memakai DR 0
+    DvLinkInfo nbrs[ROUTING_MAX_NEIGHBORS];
+    int nn = loraDrCount() > 1 ? dvNeighbors(nbrs, ROUTING_MAX_NEIGHBORS) : 0;
+    bool first = true;
+    for (int i = 0; i < nn; i++) {
+        if (nbrs[i].rxDr == 0) continue;
+        snprintf(seq, sizeof(seq), "%d.%u", nbrs[i].id, (unsigned)nbrs[i].rxDr);
+        std::string entry = (first ? std::string(" ") + WIRE_HELLO_DR : std::string(",")) + seq;
+        if (message.size() + entry.size() + mac.size() > s_maxFrameLen) break;
+        message += entry;
+        first = false;
+    }
+    message += mac;
 
+    // Hello berikutnya datang sendiri: bila jatah habis cukup dibuang
+    if (!radio_send(AirClass::Hello, TxPrio::Beacon, message.data(), message.size())) {
+        ESP_LOGW(TAG, "Hello dropped: airtime budget");
+        return;
+    }
+    s_helloSeq++;   // Hello yang dibuang di sini tidak terhitung hilang oleh tetangga
     ESP_LOGI(TAG, "Sending a Hello message: %s", message.c_str());
 }
 
 // -------------------- RX Handler --------------------
-static bool isAsciiClean(const std::string& s) {
+// Semua parser bekerja langsung pada buffer RX driver (sx1276_rx_view):
+// tidak ada std::string, substr, atau alokasi per paket.
+static bool isAsciiClean(std::string_view s) {
     for (unsigned char c : s) {
         if (c < 32 || c > 126) return false;
     }
     return true;
 }
 
+// angka setelah token Hello ("AS:12", "HS:7"); token harus sebelum "MAC:" (macPos)
+static bool helloToken(std::string_view hello, const char* token, size_t macPos, unsigned& out) {
+    auto at = hello.find(token);
+    if (at == std::string_view::npos || at >= macPos) return false;
+    at += strlen(token);
+    const char* end = hello.data() + macPos;
+    return std::from_chars(hello.data() + at, end, out).ec == std::errc();
+}
+
+// DR yang diminta pengirim Hello untuk node ini ("DR:3.2,7.1"), 0 = tidak ada
+static uint8_t helloRate(std::string_view hello, size_t macPos) {
+    auto at = hello.find(WIRE_HELLO_DR);
+    if (at == std::string_view::npos || at >= macPos) return 0;
+    const char* p   = hello.data() + at + strlen(WIRE_HELLO_DR);
+    const char* end = hello.data() + macPos;
+    unsigned id, dr;
+    while (p < end) {
+        auto r = std::from_chars(p, end, id);
+        if (r.ec != std::errc() || r.ptr >= end || *r.ptr != '.') return 0;
+        r = std::from_chars(r.ptr + 1, end, dr);
+        if (r.ec != std::errc()) return 0;
+        if (id == (unsigned)NODE_ID) return (uint8_t)std::min(dr, 255u);
+        if (r.ptr >= end || *r.ptr != ',') return 0;
+        p = r.ptr + 1;
+    }
+    return 0;
+}
+
+// Frame dari radio, atau datagram hasil rakitan fragmen (reassembled)
+static void dispatchFrame(uint8_t* raw, size_t len, const Sx1276RxView& pkt, bool reassembled);
+
 void onDataRecv(int packetSize) {
     if (packetSize <= 0) return;
 
-    std::string received;
-    received.reserve((size_t)packetSize);
-    while (true) {
-        int b = radio_read_byte();
-        if (b < 0) break;
-        received.push_back((char)b);
-        if ((int)received.size() >= packetSize) break;
-    }
+    Sx1276RxView pkt = radio_rx_view();
+    if (pkt.len == 0) return;
+
+    statInc(Stat::RxFrames);
+    statInc(Stat::RxBytes, (uint32_t)pkt.len);
+    statInc(Stat::RxAirtimeUs, loraTimeOnAirUs(loraModemConfigForDr(pkt.dr), pkt.len));
 
     // sanitasi dasar
-    if (received.size() > 230) { ESP_LOGW(TAG, "Drop: oversize"); return; }
-    if (!isAsciiClean(received))  { ESP_LOGW(TAG, "Drop: non-ASCII"); return; }
+    if (pkt.len > WIRE_MAX_FRAME_LEN) { ESP_LOGW(TAG, "Drop: oversize"); statInc(Stat::RxOversize); return; }
+    dispatchFrame(pkt.data, pkt.len, pkt, false);
+}
+
+// fragmen untuk node ini (atau broadcast); datagram lengkap diproses seperti
+// frame tunggal
+static void onFragment(const uint8_t* raw, size_t len, const Sx1276RxView& pkt) {
+    WireFragView f;
+    if (!wireDecodeFrag(raw, len, f)) { ESP_LOGW(TAG, "Drop: malformed fragment"); statInc(Stat::RxMalformed); return; }
+    if ((f.linkDst >= 0 && f.linkDst != NODE_ID) || f.linkSrc == NODE_ID) return;
+
+    uint8_t* dgram;
+    size_t   dlen;
+    if (!fragInput(f, now_ms(), &dgram, &dlen)) return;
+    statInc(Stat::FragReassembled);
+    ESP_LOGI(TAG, "Datagram %u B reassembled from NODE_%d (id %u)", (unsigned)dlen, f.linkSrc, (unsigned)f.id);
+    dispatchFrame(dgram, dlen, pkt, true);
+}
 
-    ESP_LOGI(TAG, "Message received: %s", received.c_str());
+static void dispatchFrame(uint8_t* raw, size_t len, const Sx1276RxView& pkt, bool reassembled) {
+    // estimasi link (dan pilihan DR) hanya dari SNR yang terukur di DR dasar
+    const int snrX4 = pkt.dr == 0 ? pkt.snr_x4 : LINK_SNR_UNKNOWN;
+
+    // ---- Frame biner (bit7 byte pertama = 1) ----
+    if (wireIsBinary(raw, len)) {
+        switch (raw[0]) {
+            case WIRE_TYPE_ROUTING_V1:
+            case WIRE_TYPE_ROUTING_FULL:
+            case WIRE_TYPE_ROUTING_DELTA:
+                parseAndUpdateRoutingTableBin(raw, len, pkt.rssi, snrX4);
+                printRoutingTableId();
+                break;
+            case WIRE_TYPE_ROUTING_RESYNC:
+                onResyncRequest(raw, len);
+                break;
+            case WIRE_TYPE_DATA:
+                onDataFrame(raw, len);
+                break;
+            case WIRE_TYPE_ACK:
+                onAck(raw, len);
+                break;
+            case WIRE_TYPE_FRAG:
+                if (reassembled) { ESP_LOGW(TAG, "Drop: nested fragment"); statInc(Stat::RxMalformed); break; }
+                onFragment(raw, len, pkt);
+                break;
+            default:
+                ESP_LOGW(TAG, "Drop: unknown binary type 0x%02X", raw[0]);
+                statInc(Stat::RxUnknownType);
+                break;
+        }
+        return;
+    }
+
+    std::string_view received((const char*)raw, len);
+    if (!isAsciiClean(received))  { ESP_LOGW(TAG, "Drop: non-ASCII"); statInc(Stat::RxNonAscii); return; }
+
+    ESP_LOGI(TAG, "Message received: %.*s", (int)received.size(), received.data());
 
     // ---- ROUTINGID (baru) ----
     if (received.rfind("ROUTINGID|", 0) == 0) { // startsWith
-        int rssi_to_sender = radio_packet_rssi();
-        parseAndUpdateRoutingTableId(received, rssi_to_sender);
+        parseAndUpdateRoutingTableId(received, pkt.rssi, snrX4);
         printRoutingTableId();
         return;
     }
@@ -143,301 +434,580 @@ void onDataRecv(int packetSize) {
 
     // ---- HELLO (ambil MAC & RSSI tetangga) ----
     auto pos = received.find("MAC:");
-    if (pos != std::string::npos) {
-        std::string macString = received.substr(pos + 5);
-        macString = upper(macString);
-        ESP_LOGI(TAG, "From MAC: %s", macString.c_str());
-
-        int rssi = radio_packet_rssi();
-        ESP_LOGI(TAG, "Received RSSI value: %d", rssi);
-
-        // update RSSI table
-        {
-            uint32_t currentTime = now_ms();
-            int nid = macToNodeId(macString);
-
-            // update kalau sudah ada
-            for (int i = 0; i < 10; i++) {
-                if (routingTable[i].macAddress == macString) {
-                    routingTable[i].rssi = rssi;
-                    routingTable[i].cost = -rssi;                // cost link ke tetangga
-                    routingTable[i].lastUpdated = currentTime;
-                    routingTable[i].nextHop = macString;         // tetangga langsung
-                    routingTable[i].nextHopId = nid;             // id tetangga langsung
-                    routingTable[i].destination = (nid >= 0 ? nid : routingTable[i].destination);
-                    goto done_update;
-                }
-            }
+    if (pos != std::string_view::npos) {
+        std::string_view macText = received.substr(std::min(pos + 5, received.size()));
+        ESP_LOGI(TAG, "From MAC: %.*s", (int)macText.size(), macText.data());
 
-            // atau buat entri baru
-            for (int i = 0; i < 10; i++) {
-                if (routingTable[i].macAddress.empty()) {
-                    routingTable[i].macAddress  = macString;
-                    routingTable[i].rssi        = rssi;
-                    routingTable[i].cost        = -rssi;
-                    routingTable[i].nextHop     = macString;
-                    routingTable[i].nextHopId   = nid;
-                    routingTable[i].destination = (nid >= 0 ? nid : getDestinationFromMac(macString));
-                    routingTable[i].lastUpdated = currentTime;
-                    break;
-                }
-            }
+        int rssi = pkt.rssi;
+        ESP_LOGI(TAG, "Received RSSI value: %d (SNR %d.%02d dB)", rssi,
+                 pkt.snr_x4 / 4, (pkt.snr_x4 < 0 ? -pkt.snr_x4 : pkt.snr_x4) % 4 * 25);
+
+        uint8_t mac[6];
+        int nid = parseMac(macText.data(), macText.size(), mac) ? macToNodeId(mac) : -1;
+        if (!RoutingTable<ROUTING_MAX_NODES>::inRange(nid) || nid == NODE_ID) {
+            ESP_LOGW(TAG, "Hello from unknown/out-of-range node (id %d), ignored", nid);
+            statInc(Stat::RxUnknownNode);
+            return;
         }
-        done_update:;
-        // sinkronkan nextHopId untuk neighbor
-        int nid = macToNodeId(macString);
-        if (nid >= 0) {
-            for (int i = 0; i < 10; i++) {
-                if (routingTable[i].macAddress == macString || routingTable[i].destination == nid) {
-                    routingTable[i].nextHopId = nid;
-                    break;
-                }
-            }
+
+        // kapabilitas format biner (token sebelum "MAC:")
+        auto cap = received.find(WIRE_HELLO_CAP);
+        bool binCapable = (cap != std::string_view::npos && cap < pos);
+        s_legacyPeerSeen[nid] = binCapable ? 0 : (now_ms() | 1u);
+        auto arq = received.find(WIRE_HELLO_ARQ);
+        s_arqPeer[nid] = (arq != std::string_view::npos && arq < pos);
+
+        // link ke tetangga langsung (biaya dari RSSI/SNR/ETX, distance_vector.h)
+        if (!dvLinkUpdate(nid, rssi, snrX4, now_ms())) return;
+
+        unsigned num;
+        if (binCapable && helloToken(received, WIRE_HELLO_NUM, pos, num)) dvHelloSeq(nid, (uint16_t)num);
+        dvHelloInterval(nid, helloToken(received, WIRE_HELLO_IVL, pos, num) ? num * 1000u : 0);
+        dvNeighborTxDr(nid, helloRate(received, pos));
+
+        // nomor urut tujuan milik tetangga (rute langsung ke dia)
+        if (helloToken(received, WIRE_HELLO_DSEQ, pos, num)) {
+            s_noDseqPeerSeen[nid] = 0;
+            dvDestSeq(nid, (int)(uint8_t)num);
+            // nomor urutnya tertinggal dari penarikan yang kita kenal (reboot,
+            // atau dia tidak mendengar rutenya diracuni): kirim ulang penarikan
+            int fd = dvFeasibleSeq(nid);
+            if (fd >= 0 && wireSeq8After((uint8_t)fd, (uint8_t)num)) kickDestSeq(nid);
+        } else {
+            s_noDseqPeerSeen[nid] = now_ms() | 1u;
+            dvDestSeq(nid, -1);
         }
-    }
-}
 
-// -------------------- Bellman-Ford --------------------
-void runBellmanFord() {
-    ESP_LOGI(TAG, "Running Bellman-Ford to update routing table...");
-    std::string myMac = macToString(getMacAddress());
-
-    // init cost & nexthop
-    for (int i = 0; i < 10; i++) {
-        if (routingTable[i].macAddress == myMac) {
-            routingTable[i].cost = 0;
-            routingTable[i].nextHop = myMac;
-            routingTable[i].nextHopId = NODE_ID;
-        } else if (!routingTable[i].macAddress.empty()) {
-            routingTable[i].cost    = -routingTable[i].rssi;               // tetangga langsung
-            routingTable[i].nextHop = routingTable[i].macAddress;
-            routingTable[i].nextHopId = macToNodeId(routingTable[i].nextHop);
+        // nomor urut iklan tetangga: deteksi delta yang terlewat saat kanal sepi
+        uint16_t have;
+        if (binCapable && helloToken(received, WIRE_HELLO_SEQ, pos, num) &&
+            (!dvAdvertGetSeq(nid, have) || have != (uint16_t)num)) {
+            requestResync(nid);
         }
+        recomputeRoutes();
     }
+}
 
-    // relax N-1
-    for (int k = 0; k < 9; k++) {
-        for (int i = 0; i < 10; i++) {
-            if (routingTable[i].macAddress.empty() || routingTable[i].macAddress == myMac) continue;
-            for (int j = 0; j < 10; j++) {
-                if (routingTable[j].macAddress.empty() || i == j) continue;
-                // split horizon: jangan lewat tetangga yang nextHop ke kita
-                if (routingTable[j].nextHop == myMac) continue;
-
-                int costToNeighbor = -routingTable[j].rssi;
-                int totalCost = costToNeighbor + routingTable[j].cost;
-                if (totalCost < routingTable[i].cost) {
-                    routingTable[i].cost    = totalCost;
-                    routingTable[i].nextHop = routingTable[j].macAddress;
-                    routingTable[i].nextHopId = macToNodeId(routingTable[j].macAddress);
-                }
-            }
-        }
+// -------------------- Rekomputasi rute --------------------
+// Hanya tujuan yang terdampak perubahan link/iklan (lihat distance_vector.h).
+// Rute yang berubah memicu iklan (triggered update) tanpa menunggu timer dan
+// mengembalikan timer Trickle ke Imin. true = rute / himpunan tetangga berubah.
+static void scheduleTriggeredUpdate();
+static void trickleInconsistent(bool nbrChanged);
+static void advertConsistent();
+static int  s_nbrCount = 0;
+
+static bool recomputeRoutes() {
+    int64_t t0 = esp_timer_get_time();
+    int changed = dvRecompute(now_ms());
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    statInc(Stat::BfRuns);
+    statInc(Stat::BfTimeUs, us);
+    statMax(Stat::BfMaxUs, us);
+    if (changed > 0) {
+        statInc(Stat::RouteChanges, (uint32_t)changed);
+        ESP_LOGI(TAG, "%d route(s) changed", changed);
+        scheduleTriggeredUpdate();
     }
+    int  nbrs       = dvNeighborCount();
+    bool nbrChanged = nbrs != s_nbrCount;
+    s_nbrCount = nbrs;
+    if (changed > 0 || nbrChanged) trickleInconsistent(nbrChanged);
+    return changed > 0 || nbrChanged;
+}
+
+// Sweep penuh (semua tujuan) sebagai jaring pengaman; jarang dipanggil.
+void runBellmanFord() {
+    ESP_LOGI(TAG, "Running Bellman-Ford to update routing table...");
+    dvMarkAll();
+    recomputeRoutes();
     ESP_LOGI(TAG, "Routing table updated.");
     printRoutingTableId();
+    printNeighborTable();
 }
 
 // -------------------- Timeout / Aging --------------------
 void checkRoutingTableTimeout() {
-    uint32_t currentTime = now_ms();
-    const uint32_t timeout = 60000;
-
-    for (int i = 0; i < 10; i++) {
-        if (!routingTable[i].macAddress.empty() &&
-            currentTime - routingTable[i].lastUpdated > timeout) {
-            ESP_LOGW(TAG, "Entry timeout: %s", routingTable[i].macAddress.c_str());
-            routingTable[i] = RoutingEntry{}; // reset ke default
-        }
+    dvExpire(now_ms(), NEIGHBOR_TIMEOUT_MS);
+    recomputeRoutes();
+}
+
+// -------------------- Data plane (by node_id) --------------------
+// Frame data biner (routing_wire.h): originator menulis header sekali,
+// setiap relay hanya mengganti next hop + ttl di buffer RX lalu mengirim
+// ulang buffer yang sama. Tiap hop dijamin ARQ (lora_arq.h): next hop
+// menjawab ACK, pengirim mengirim ulang sampai ARQ_MAX_RETRIES kali.
+static DataRecvHandler s_dataHandler    = nullptr;
+static void*           s_dataHandlerArg = nullptr;
+static uint16_t        s_dataSeq        = 0;
+
+static void dataInit() {
+    s_dataSeq = (uint16_t)esp_random();
+}
+
+void setDataRecvHandler(DataRecvHandler cb, void* arg) {
+    s_dataHandler    = cb;
+    s_dataHandlerArg = arg;
+}
+
+size_t dataMaxPayload() {
+    return s_maxDatagramLen - WIRE_DATA_HDR_LEN;
+}
+
+// frame data yang disusun originator (bisa > satu frame: dipecah saat kirim)
+static uint8_t s_dataFrame[FRAG_MAX_DATAGRAM];
+
+// next hop ke destId, atau -1 jika tidak ada rute yang masih hidup
+static int dataNextHop(int destId) {
+    const RoutingEntry* e = routingTable.find(destId);
+    if (!e || e->nextHopId < 0 || e->cost >= ROUTE_COST_INF) return -1;
+    if (now_ms() - e->lastUpdated > dvNeighborTimeoutMs(e->nextHopId, NEIGHBOR_TIMEOUT_MS)) {
+        return -1;                                                     // belum di-aging
     }
+    return e->nextHopId;
 }
 
-// -------------------- Forwarding (by node_id) --------------------
-void forwardData(int targetNode) {
-    for (int i = 0; i < 10; i++) {
-        if (routingTable[i].destination == targetNode) {
-            uint32_t now = now_ms();
-            if (now - routingTable[i].lastUpdated > 10000) {
-                ESP_LOGW(TAG, "Route stale. Abort forwarding.");
-                return;
+// Kirim frame data (header sudah ditulis) ke next hop nh; tetangga yang
+// menjawab ACK disimpan di jendela ARQ untuk dikirim ulang. prio: Local
+// (frame kita) / Relay (frame node lain)
+static bool sendDataFrame(const uint8_t* frame, size_t len, int nh, TxPrio prio) {
+    if (!radio_send_datagram(AirClass::Data, prio, frame, len, nh)) return false;
+    if (!ARQ_ENABLE || !s_arqPeer[nh]) return true;
+
+    WireDataView v;
+    wireDecodeData(frame, len, v);
+    uint32_t airMs = (datagramAirUs(len, dvTxDr(nh)) + 999) / 1000;
+    if (!arqTrack(nh, v.src, v.seq, frame, len, airMs, now_ms())) {
+        statInc(Stat::ArqWindowFull);
+        ESP_LOGD(TAG, "ARQ window full, data NODE_%d seq %u sent unacknowledged", v.src, (unsigned)v.seq);
+    }
+    return true;
+}
+
+// ACK ke pengirim frame data yang baru diterima (siapa pun dia: ACK tidak
+// beralamat, lihat routing_wire.h)
+static void sendAck(const WireDataView& v) {
+    uint8_t ack[WIRE_ACK_LEN];
+    size_t n = wireEncodeAck(ack, sizeof(ack), { NODE_ID, v.src, v.seq });
+    if (n == 0) return;
+    if (radio_send(AirClass::Data, TxPrio::Urgent, ack, n)) statInc(Stat::AckSent);
+}
+
+static void onAck(const uint8_t* raw, size_t len) {
+    WireAck a;
+    if (!wireDecodeAck(raw, len, a)) { ESP_LOGW(TAG, "Drop: malformed ack"); statInc(Stat::RxMalformed); return; }
+    if (!arqAck(a.from, a.src, a.seq, now_ms())) return;   // bukan untuk kita / sudah lewat
+    dvLinkTxResult(a.from, true);
+    statInc(Stat::DataAcked);
+    ESP_LOGI(TAG, "Data NODE_%d seq %u acked by NODE_%d", a.src, (unsigned)a.seq, a.from);
+}
+
+// RTO yang lewat: kirim ulang ke next hop yang sama, atau lepaskan frame.
+// Tiap timeout setelah frame benar-benar terkirim menaikkan ETX link itu;
+// kiriman ulang yang ditolak batas kita sendiri (jatah airtime, dwell,
+// antrean) ditunda tanpa memakai percobaan atau menyalahkan link. Rute
+// dihitung ulang setelah frame gagal supaya frame berikutnya bisa memakai
+// jalur lain.
+static int32_t runArq(uint32_t now) {
+    bool failed = false;
+    ArqFrame f;
+    for (ArqEvent ev; (ev = arqPoll(now, f)) != ArqEvent::None;) {
+        if (f.lost) dvLinkTxResult(f.nbrId, false);
+        if (ev == ArqEvent::Retransmit) {
+            if (!radio_send_datagram(AirClass::Data, TxPrio::Relay, f.data, f.len, f.nbrId)) {
+                uint32_t wait = airtimeWaitMs(AirClass::Data, datagramAirUs(f.len, dvTxDr(f.nbrId)));
+                if (arqDefer(f.nbrId, f.src, f.seq, wait, now)) {
+                    ESP_LOGD(TAG, "Retransmit data NODE_%d seq %u to NODE_%d deferred %u ms",
+                             f.src, (unsigned)f.seq, f.nbrId, (unsigned)wait);
+                } else {
+                    ESP_LOGW(TAG, "Data NODE_%d seq %u to NODE_%d dropped: retransmit refused %d times",
+                             f.src, (unsigned)f.seq, f.nbrId, ARQ_MAX_DEFERS + 1);
+                }
+                continue;
             }
-            char destinationNode[16];
-            snprintf(destinationNode, sizeof(destinationNode), "NODE_%d", targetNode);
+            statInc(Stat::DataRetx);
+            ESP_LOGI(TAG, "Retransmit data NODE_%d seq %u to NODE_%d (try %u)",
+                     f.src, (unsigned)f.seq, f.nbrId, (unsigned)f.tries);
+        } else {
+            statInc(Stat::DataLinkFail);
+            ESP_LOGW(TAG, "Data NODE_%d seq %u not acked by NODE_%d, giving up",
+                     f.src, (unsigned)f.seq, f.nbrId);
+            failed = true;
+        }
+    }
+    if (failed) recomputeRoutes();
+    uint32_t wait = arqWaitMs(now);
+    return wait > (uint32_t)INT32_MAX ? INT32_MAX : (int32_t)wait;
+}
 
-            ESP_LOGI(TAG, "Forwarding to next hop (ID %d) MAC %s",
-                     routingTable[i].nextHopId, routingTable[i].nextHop.c_str());
+static void deliverData(const WireDataView& v) {
+    ESP_LOGI(TAG, "Data from NODE_%d (seq %u, %u B)", v.src, (unsigned)v.seq, (unsigned)v.len);
+    statInc(Stat::DataDelivered);
+    // laporan statistik dari node lain (node ini kolektor)
+    StatsReport report;
+    if (statsDecode(v.payload, v.len, report)) statsLog(report);
+    if (s_dataHandler) s_dataHandler(v.src, v.payload, v.len, s_dataHandlerArg);
+}
 
-            std::string payload = std::string("Data to ") + destinationNode;
-            radio_begin_packet();
-            radio_write(payload.c_str(), payload.size());
-            radio_end_packet();
+bool sendData(int destId, const void* payload, size_t len) {
+    if (len > dataMaxPayload()) {
+        ESP_LOGW(TAG, "Data to NODE_%d: %u B exceeds %u B payload limit",
+                 destId, (unsigned)len, (unsigned)dataMaxPayload());
+        return false;
+    }
+    if (destId == NODE_ID) {
+        WireDataView v;
+        v.src = v.dst = NODE_ID;
+        v.seq = s_dataSeq++;
+        v.payload = (const uint8_t*)payload;
+        v.len = len;
+        deliverData(v);
+        return true;
+    }
+    int nh = dataNextHop(destId);
+    if (nh < 0) {
+        ESP_LOGW(TAG, "Data to NODE_%d: no route", destId);
+        statInc(Stat::DataDropNoRoute);
+        return false;
+    }
 
-            ESP_LOGI(TAG, "Data successfully forwarded to node: %s", destinationNode);
-            return;
+    size_t n = wireEncodeDataHeader(s_dataFrame, sizeof(s_dataFrame), NODE_ID, destId, nh,
+                                    (uint8_t)DATA_TTL, s_dataSeq);
+    if (n == 0) return false;
+    if (len) memcpy(s_dataFrame + n, payload, len);
+    if (!sendDataFrame(s_dataFrame, n + len, nh, TxPrio::Local)) {
+        ESP_LOGW(TAG, "Data to NODE_%d dropped: airtime budget / TX queue", destId);
+        return false;
+    }
+    s_dataSeq++;
+    statInc(Stat::DataSent);
+    ESP_LOGI(TAG, "Data to NODE_%d via NODE_%d (%u B)", destId, nh, (unsigned)len);
+    return true;
+}
+
+// frame data dari radio / rakitan fragmen; frame menunjuk ke buffer RX
+// (atau buffer rakitan) dan boleh diubah
+// Teruskan frame data ke hop berikutnya; true = sudah diantrekan
+static bool relayData(uint8_t* frame, size_t len, const WireDataView& v) {
+    if (v.src == NODE_ID) {
+        ESP_LOGW(TAG, "Drop data to NODE_%d: looped back to source", v.dst);
+        statInc(Stat::DataDropLoop);
+        return false;
+    }
+    if (v.ttl <= 1) {
+        ESP_LOGW(TAG, "Drop data NODE_%d->NODE_%d: TTL expired", v.src, v.dst);
+        statInc(Stat::DataDropTtl);
+        return false;
+    }
+    int nh = dataNextHop(v.dst);
+    if (nh < 0) {
+        ESP_LOGW(TAG, "Drop data NODE_%d->NODE_%d: no route", v.src, v.dst);
+        statInc(Stat::DataDropNoRoute);
+        return false;
+    }
+    wireDataRelay(frame, nh);
+    if (!sendDataFrame(frame, len, nh, TxPrio::Relay)) {
+        ESP_LOGW(TAG, "Drop data NODE_%d->NODE_%d: airtime budget / TX queue", v.src, v.dst);
+        return false;
+    }
+    statInc(Stat::DataRelayed);
+    ESP_LOGI(TAG, "Relay data NODE_%d->NODE_%d via NODE_%d", v.src, v.dst, nh);
+    return true;
+}
+
+static void onDataFrame(uint8_t* frame, size_t len) {
+    WireDataView v;
+    if (!wireDecodeData(frame, len, v)) { ESP_LOGW(TAG, "Drop: malformed data frame"); statInc(Stat::RxMalformed); return; }
+
+    // frame kita yang diteruskan next hop (ke mana pun, termasuk balik ke kita)
+    if (ARQ_ENABLE) {
+        int nbr = arqAckForwarded(v.src, v.seq, v.ttl, v.nextHop, now_ms());
+        if (nbr >= 0) {
+            dvLinkTxResult(nbr, true);
+            statInc(Stat::DataAcked);
         }
     }
-    ESP_LOGW(TAG, "Destination node not found in routing table!");
+    if (v.nextHop != NODE_ID) return;           // terdengar, bukan untuk kita
+
+    // kiriman ulang karena ACK (implisit) kita tidak terdengar: sudah diproses
+    if (ARQ_ENABLE && arqDuplicate(v.src, v.seq)) {
+        statInc(Stat::DataDupRx);
+        sendAck(v);
+        return;
+    }
+    if (v.dst == NODE_ID) {
+        if (ARQ_ENABLE) sendAck(v);
+        deliverData(v);
+        return;
+    }
+    // frame satu-frame yang diteruskan menjadi ACK implisit bagi pengirimnya;
+    // fragmen diteruskan per hop (tidak terdengar utuh), dan frame yang
+    // dibuang tetap di-ACK supaya pengirim tidak mengulang percuma
+    bool forwarded = relayData(frame, len, v);
+    if (ARQ_ENABLE && (!forwarded || len > s_maxFrameLen)) sendAck(v);
+}
+
+// Kirim pesan uji "Data to NODE_x" ke targetNode lewat data plane
+void forwardData(int targetNode) {
+    char payload[24];
+    int len = snprintf(payload, sizeof(payload), "Data to NODE_%d", targetNode);
+    if (sendData(targetNode, payload, (size_t)len)) {
+        ESP_LOGI(TAG, "Data to NODE_%d queued for next hop", targetNode);
+    }
 }
 
 // -------------------- ROUTINGID Serializer --------------------
+static bool peerSeenWithin(const uint32_t* seen, uint32_t now) {
+    for (int id = 0; id < ROUTING_MAX_NODES; id++) {
+        if (seen[id] != 0 && now - seen[id] < LEGACY_PEER_TIMEOUT_MS) return true;
+    }
+    return false;
+}
+
 std::string serializeRoutingTableWithSenderId(int targetNextHopId) {
-    // Format: ROUTINGID|<sender_id>|<dest_id,rssi,cost,next_hop_id>|...|
+    // Format: ROUTINGID|<sender_id>|<dest_id,rssi,cost,next_hop_id[,seq]>|...|
+    // seq (nomor urut tujuan) hanya bila semua tetangga memahaminya
     char head[32];
     snprintf(head, sizeof(head), "ROUTINGID|%d|", NODE_ID);
     std::string msg = head;
+    bool withSeq = !peerSeenWithin(s_noDseqPeerSeen, now_ms());
 
-    for (int i = 0; i < 10; i++) {
-        if (routingTable[i].destination < 0) continue;
-
-        int nhId = routingTable[i].nextHopId >= 0
-                 ? routingTable[i].nextHopId
-                 : macToNodeId(routingTable[i].nextHop);
+    for (const RoutingEntry& e : routingTable) {
+        if (!e.used() || !e.feasible) continue;   // jalur cadangan tidak diiklankan
 
         // split horizon by ID
-        if (targetNextHopId >= 0 && nhId == targetNextHopId) continue;
+        if (targetNextHopId >= 0 && e.nextHopId == targetNextHopId) continue;
 
         char buf[64];
-        snprintf(buf, sizeof(buf), "%d,%d,%d,%d|",
-                 routingTable[i].destination,
-                 routingTable[i].rssi,
-                 routingTable[i].cost,
-                 nhId);
+        if (withSeq) {
+            snprintf(buf, sizeof(buf), "%d,%d,%d,%d,%u|",
+                     e.destination, e.rssi, (int)e.cost, e.nextHopId, (unsigned)e.seqNo);
+        } else {
+            snprintf(buf, sizeof(buf), "%d,%d,%d,%d|",
+                     e.destination, e.rssi, (int)e.cost, e.nextHopId);
+        }
         msg += buf;
     }
     return msg;
 }
 
+size_t serializeRoutingTableBin(uint8_t* out, size_t cap, int targetNextHopId) {
+    size_t n = wireEncodeRoutingHeader(out, cap, NODE_ID);
+    if (n == 0) return 0;
+
+    for (const RoutingEntry& e : routingTable) {
+        if (!e.used() || !e.feasible) continue;   // jalur cadangan tidak diiklankan
+
+        // split horizon by ID
+        if (targetNextHopId >= 0 && e.nextHopId == targetNextHopId) continue;
+
+        WireRouteEntry w{ e.destination, e.nextHopId, (int)e.cost, e.rssi };
+        n += wireEncodeRouteEntry(out + n, cap - n, w);
+    }
+    return n;
+}
+
+static bool isLegacyPeer(int id, uint32_t now) {
+    uint32_t seen = s_legacyPeerSeen[id];
+    return seen != 0 && now - seen < LEGACY_PEER_TIMEOUT_MS;
+}
+
+// Negosiasi: biner kecuali ada tetangga firmware lama yang masih terdengar
+// (Hello tanpa WIRE_HELLO_CAP); broadcast harus dipahami semua tetangga.
+static bool useBinaryWire(int neighborId) {
+#if ROUTING_WIRE_MODE == 0
+    (void)neighborId;
+    return false;
+#elif ROUTING_WIRE_MODE == 2
+    (void)neighborId;
+    return true;
+#else
+    uint32_t now = now_ms();
+    if (neighborId >= 0) {
+        return !RoutingTable<ROUTING_MAX_NODES>::inRange(neighborId) || !isLegacyPeer(neighborId, now);
+    }
+    return !peerSeenWithin(s_legacyPeerSeen, now);
+#endif
+}
+
+// Kelas antrean TX iklan (prio) selalu dari pemanggil: Beacon untuk iklan
+// periodik, Urgent untuk triggered update (penarikan rute) dan balasan resync
+static uint8_t s_routingFrame[WIRE_MAX_FRAME_LEN];
+
+// Tabel utuh (v1 biner / teks) sebagai satu datagram; bila lebih panjang
+// dari satu frame dipecah jadi fragmen broadcast
+static uint8_t s_routingDatagram[FRAG_MAX_DATAGRAM];
+
+// jatah airtime semua fragmen diambil sekaligus (radio_send_datagram)
+static bool sendRoutingTable(int neighborId, TxPrio prio) {
+    if (useBinaryWire(neighborId)) {
+        size_t len = serializeRoutingTableBin(s_routingDatagram, sizeof(s_routingDatagram), neighborId);
+        if (!radio_send_datagram(AirClass::Routing, prio, s_routingDatagram, len, -1)) return false;
+        ESP_LOGI(TAG, "RoutingID (bin, %u B) sent.", (unsigned)len);
+        return true;
+    }
+    std::string payload = serializeRoutingTableWithSenderId(neighborId);
+    return radio_send_datagram(AirClass::Routing, prio, (const uint8_t*)payload.data(), payload.size(), -1);
+}
+
+// status triggered update (lihat runPeriodicTasks)
+static bool     s_triggerPending = false;
+static uint32_t s_dueTrigger     = 0;
+static TxPrio   s_pendingPrio    = TxPrio::Urgent;   // kelas iklan tertunda (s_triggerPending)
+static uint32_t s_lastAdvertMs   = 0;
+
 void sendRoutingTableId() {
-    std::string payload = serializeRoutingTableWithSenderId(-1);
-    radio_begin_packet();
-    radio_write(payload.c_str(), payload.size());
-    radio_end_packet();
+    sendRoutingUpdate(true, TxPrio::Beacon);
     ESP_LOGI(TAG, "RoutingID broadcast sent.");
 }
 
 void sendRoutingTableToId(int neighborId) {
-    std::string payload = serializeRoutingTableWithSenderId(neighborId);
-    radio_begin_packet();
-    radio_write(payload.c_str(), payload.size());
-    radio_end_packet();
+    if (!sendRoutingTable(neighborId, TxPrio::Urgent)) {
+        ESP_LOGW(TAG, "RoutingID to NODE_%d dropped: airtime budget", neighborId);
+        return;
+    }
     ESP_LOGI(TAG, "RoutingID sent to NODE_%d.", neighborId);
 }
 
 // -------------------- ROUTINGID Parser --------------------
-static bool stoi_safe(const std::string& s, int &out) {
+static bool stoi_safe(std::string_view s, int &out) {
     if (s.empty()) return false;
-    char *end = nullptr;
-    long v = strtol(s.c_str(), &end, 10);
-    if (end == s.c_str() || *end != '\0') return false;
-    out = (int)v;
-    return true;
+    auto r = std::from_chars(s.data(), s.data() + s.size(), out);
+    return r.ec == std::errc() && r.ptr == s.data() + s.size();
 }
 
-void parseAndUpdateRoutingTableId(const std::string& message, int rssiToSender) {
-    auto p1 = message.find('|'); if (p1 == std::string::npos) return;
-    auto p2 = message.find('|', p1 + 1); if (p2 == std::string::npos) return;
+// terapkan satu entri iklan tetangga (dipakai parser teks & biner);
+// seq = nomor urut tujuan, -1 jika tidak dibawa
+static void applyAdvertisedRoute(int senderId, int destId, int rssi, int neighborCost, int nextHopId,
+                                 int seq) {
+    // Skip filler seperti "0,0,0,0" kecuali self-entry si pengirim
+    if ((destId == 0 && rssi == 0 && neighborCost == 0 && nextHopId == 0) ||
+        (neighborCost <= 0 && destId != senderId)) {
+        return;
+    }
+    // [PATCH] Abaikan entri untuk diri sendiri;
+    // kita tidak perlu menyimpan/overwrite self-route dari tetangga
+    if (destId == NODE_ID) {
+        // rute ke kita ditarik dengan nomor urut lebih baru (ganjil): terbitkan
+        // nomor urut genap berikutnya supaya rute lewat link yang masih hidup
+        // kembali layak
+        if (seq >= 0 && wireSeq8After((uint8_t)seq, s_destSeq)) {
+            s_destSeq = (uint8_t)((seq | 1) + 1);
+            statInc(Stat::DestSeqBumps);
+            ESP_LOGI(TAG, "Own route poisoned by NODE_%d, seqno now %u", senderId, (unsigned)s_destSeq);
+            helloSoon();
+        }
+        return;
+    }
+    dvAdvertEntry(senderId, destId, neighborCost, nextHopId, seq);
+}
+
+void parseAndUpdateRoutingTableId(std::string_view message, int rssiToSender, int snrX4) {
+    auto p1 = message.find('|'); if (p1 == std::string_view::npos) return;
+    auto p2 = message.find('|', p1 + 1); if (p2 == std::string_view::npos) return;
 
     int senderId = -1;
     if (!stoi_safe(message.substr(p1 + 1, p2 - (p1 + 1)), senderId) || senderId < 0) return;
 
-    std::string senderMac = nodeIdToMac(senderId);
-
     // gunakan RSSI paket ini sebagai biaya ke neighbor
-    int costToNeighbor = -rssiToSender;
-
-    // segarkan/insert entri untuk tetangga pengirim
-    bool haveSender = false;
-    for (int i = 0; i < 10; i++) {
-        if (routingTable[i].destination == senderId || routingTable[i].macAddress == senderMac) {
-            routingTable[i].destination = senderId;
-            routingTable[i].macAddress  = senderMac;
-            routingTable[i].rssi        = rssiToSender;
-            routingTable[i].cost        = -rssiToSender;
-            routingTable[i].nextHopId   = senderId;
-            routingTable[i].nextHop     = senderMac;
-            routingTable[i].lastUpdated = now_ms();
-            haveSender = true;
-            break;
-        }
-    }
-    if (!haveSender) {
-        for (int i = 0; i < 10; i++) {
-            if (routingTable[i].destination < 0 && routingTable[i].macAddress.empty()) {
-                routingTable[i].destination = senderId;
-                routingTable[i].macAddress  = senderMac;
-                routingTable[i].rssi        = rssiToSender;
-                routingTable[i].cost        = -rssiToSender;
-                routingTable[i].nextHopId   = senderId;
-                routingTable[i].nextHop     = senderMac;
-                routingTable[i].lastUpdated = now_ms();
-                break;
-            }
-        }
-    }
+    if (!dvLinkUpdate(senderId, rssiToSender, snrX4, now_ms())) return;
+    dvAdvertBegin(senderId, true);
 
     size_t start = p2 + 1;
     while (start < message.size()) {
         size_t pipe = message.find('|', start);
-        if (pipe == std::string::npos) break;
-        std::string e = message.substr(start, pipe - start);
+        if (pipe == std::string_view::npos) break;
+        std::string_view e = message.substr(start, pipe - start);
         start = pipe + 1;
         if (e.empty()) continue;
 
-        size_t c1 = e.find(','); size_t c2 = e.find(',', c1 + 1); size_t c3 = e.find(',', c2 + 1);
-        if (c1==std::string::npos || c2==std::string::npos || c3==std::string::npos) continue;
+        size_t c1 = e.find(','); if (c1 == std::string_view::npos) continue;
+        size_t c2 = e.find(',', c1 + 1); if (c2 == std::string_view::npos) continue;
+        size_t c3 = e.find(',', c2 + 1); if (c3 == std::string_view::npos) continue;
+
+        size_t c4 = e.find(',', c3 + 1);   // seq opsional
 
-        int destId=-1, rssi=0, neighborCost=0, nextHopId=-1;
+        int destId=-1, rssi=0, neighborCost=0, nextHopId=-1, seq=-1;
         if (!stoi_safe(e.substr(0, c1), destId)) continue;
         if (!stoi_safe(e.substr(c1+1, c2-(c1+1)), rssi)) continue;
         if (!stoi_safe(e.substr(c2+1, c3-(c2+1)), neighborCost)) continue;
-        if (!stoi_safe(e.substr(c3+1), nextHopId)) continue;
+        if (!stoi_safe(e.substr(c3+1, c4 == std::string_view::npos ? std::string_view::npos : c4-(c3+1)),
+                       nextHopId)) continue;
+        if (c4 != std::string_view::npos && (!stoi_safe(e.substr(c4+1), seq) || seq < 0 || seq > 0xFF)) continue;
 
-        // Skip filler seperti "0,0,0,0" kecuali self-entry si pengirim
-        if ((destId == 0 && rssi == 0 && neighborCost == 0 && nextHopId == 0) ||
-            (neighborCost <= 0 && destId != senderId)) {
-            continue;
-        }
-        // [PATCH] Abaikan entri untuk diri sendiri;
-        // kita tidak perlu menyimpan/overwrite self-route dari tetangga
-        if (destId == NODE_ID) {
-            continue;
-        }
-        int totalCost = costToNeighbor + neighborCost;
-
-        bool updated = false;
-        for (int i = 0; i < 10; i++) {
-            if (routingTable[i].destination == destId) {
-                if (totalCost < routingTable[i].cost) {
-                    routingTable[i].destination = destId;
-                    routingTable[i].rssi        = rssi;
-                    routingTable[i].cost        = totalCost;
-                    routingTable[i].nextHopId   = senderId;      // next hop = pengirim
-                    routingTable[i].nextHop     = senderMac;
-                    routingTable[i].macAddress  = nodeIdToMac(destId);
-                    routingTable[i].lastUpdated = now_ms();
-                }
-                updated = true;
-                break;
-            }
-        }
-        if (!updated) {
-            for (int i = 0; i < 10; i++) {
-                if (routingTable[i].destination < 0 && routingTable[i].macAddress.empty()) {
-                    routingTable[i].destination = destId;
-                    routingTable[i].rssi        = rssi;
-                    routingTable[i].cost        = totalCost;
-                    routingTable[i].nextHopId   = senderId;
-                    routingTable[i].nextHop     = senderMac;
-                    routingTable[i].macAddress  = nodeIdToMac(destId);
-                    routingTable[i].lastUpdated = now_ms();
-                    break;
-                }
-            }
-        }
+        applyAdvertisedRoute(senderId, destId, rssi, neighborCost, nextHopId, seq);
     }
+    dvAdvertEnd(senderId, true);
+    if (!recomputeRoutes()) advertConsistent();
     ESP_LOGI(TAG, "Routing table (ID) updated from neighbor!");
 }
 
+// Versi biner: entri didekode langsung dari buffer RX (tanpa substr/strtol)
+void parseAndUpdateRoutingTableBin(const uint8_t* data, size_t len, int rssiToSender, int snrX4) {
+    WireRoutingView view;
+    if (!wireDecodeRouting(data, len, view)) {
+        ESP_LOGW(TAG, "Drop: malformed binary routing frame (%u B)", (unsigned)len);
+        statInc(Stat::RxMalformed);
+        return;
+    }
+    int senderId = view.sender;
+    if (!RoutingTable<ROUTING_MAX_NODES>::inRange(senderId)) return;
+    s_legacyPeerSeen[senderId] = 0;   // pengirim jelas paham biner
+
+    if (!dvLinkUpdate(senderId, rssiToSender, snrX4, now_ms())) return;
+
+    // v1: selalu satu frame penuh. v2: frame penuh bisa dipecah (FIRST..LAST).
+    // Entri di frame mana pun adalah nilai terbaru pengirim, jadi selalu
+    // diterapkan; nomor urut hanya menentukan apakah state kita lengkap
+    // (sinkron) atau ada perubahan yang terlewat dan perlu resync.
+    bool full  = view.type != WIRE_TYPE_ROUTING_DELTA;
+    bool first = full && (!view.sequenced || (view.flags & WIRE_FLAG_FIRST));
+    bool last  = full && (!view.sequenced || (view.flags & WIRE_FLAG_LAST));
+    DvSeq r = view.sequenced ? dvAdvertCheck(senderId, view.seq, view.base, first) : DvSeq::Apply;
+    if (r == DvSeq::Duplicate) {
+        recomputeRoutes();
+        return;
+    }
+
+    dvAdvertBegin(senderId, first);
+    for (size_t k = 0; k < view.count; k++) {
+        WireRouteEntry e = view.entry(k);
+        if (e.dest < 0) continue;
+        applyAdvertisedRoute(senderId, e.dest, e.rssi, e.cost, e.nextHop, e.seq);
+    }
+    // frame tengah iklan penuh terlewat: jangan tarik tujuan yang tidak terlihat
+    dvAdvertEnd(senderId, last && r == DvSeq::Apply);
+
+    if (r == DvSeq::Gap) {
+        ESP_LOGW(TAG, "Advert gap from NODE_%d (seq %u base %u)",
+                 senderId, (unsigned)view.seq, (unsigned)view.base);
+        requestResync(senderId);
+    } else if (view.sequenced) {
+        dvAdvertSetSeq(senderId, view.seq);
+        if (last || !full) cancelResync(senderId);
+    }
+    if (!recomputeRoutes() && r == DvSeq::Apply) advertConsistent();
+    ESP_LOGI(TAG, "Routing table (ID, bin) updated from neighbor!");
+}
+
+// -------------------- Print tetangga (kualitas link) --------------------
+static void printNeighborTable() {
+    DvLinkInfo nbr[ROUTING_MAX_NEIGHBORS];
+    int n = dvNeighbors(nbr, ROUTING_MAX_NEIGHBORS);
+    ESP_LOGI(TAG, "Neighbors: %d", n);
+    ESP_LOGI(TAG, "NbrID  RSSI   SNR  Hello%%  Ack%%   ETX  Cost");
+    for (int i = 0; i < n; i++) {
+        const DvLinkInfo& l = nbr[i];
+        if (l.snrX4 == LINK_SNR_UNKNOWN) {
+            ESP_LOGI(TAG, "%5d %5d     ? %6d %5d %5d.%02d %5d", l.id, l.rssi, l.deliveryPct, l.ackPct,
+                     l.etxX100 / 100, l.etxX100 % 100, l.cost);
+        } else {
+            ESP_LOGI(TAG, "%5d %5d %5d %6d %5d %5d.%02d %5d", l.id, l.rssi, l.snrX4 / 4, l.deliveryPct,
+                     l.ackPct, l.etxX100 / 100, l.etxX100 % 100, l.cost);
+        }
+    }
+}
+
 // -------------------- Print (by Node ID) --------------------
 void printRoutingTableId() {
     ESP_LOGI(TAG, "Routing Table (by Node ID):");
@@ -445,18 +1015,652 @@ void printRoutingTableId() {
     ESP_LOGI(TAG, "DestID  RSSI  NextHopID  Cost  LastUpdated(ms)");
     ESP_LOGI(TAG, "------------------------------------------------");
     uint32_t now = now_ms();
-    for (int i = 0; i < 10; i++) {
+    for (const RoutingEntry& e : routingTable) {
         // [PATCH] jangan tampilkan self-route
-        if (routingTable[i].destination >= 0 &&
-            routingTable[i].destination != NODE_ID) {
+        if (e.used() && e.destination != NODE_ID) {
             ESP_LOGI(TAG, "%6d %5d %10d %6d %14u",
-                     routingTable[i].destination,
-                     routingTable[i].rssi,
-                     routingTable[i].nextHopId,
-                     routingTable[i].cost,
-                     (unsigned)(now - routingTable[i].lastUpdated));
+                     e.destination, e.rssi, e.nextHopId, (int)e.cost,
+                     (unsigned)(now - e.lastUpdated));
         }
     }
     ESP_LOGI(TAG, "------------------------------------------------");
 }
 
+// -------------------- Timer periodik --------------------
+// Jitter diundi sekali saat timer dijadwal ulang (bukan tiap polling), jadi
+// penyebaran waktu kirim antar node nyata. Hello dan iklan periodik memakai
+// Trickle (trickle.h): Imin = interval loop() lama, titik kirim acak di
+// paruh kedua interval.
+static constexpr uint32_t HELLO_MS = 10000u;
+static constexpr uint32_t ROUTE_MS = 9000u;
+static constexpr uint32_t BF_MS    = 60000u;   // sweep penuh, bukan jalur utama
+static constexpr uint32_t AGING_MS = 2000u;
+
+// triggered update: tunda sebentar (kumpulkan perubahan beruntun, hindari
+// semua tetangga mengirim bersamaan) dan beri jarak minimum antar iklan
+static constexpr uint32_t TRIGGER_HOLDOFF_MS = 500u, TRIGGER_JITTER_MS = 1500u;
+static constexpr uint32_t TRIGGER_MIN_GAP_MS = 5000u;
+
+static_assert((HELLO_MS << TRICKLE_HELLO_DOUBLINGS) <= LQ_HELLO_IVL_MAX_MS,
+              "timeout tetangga (distance_vector.h) harus mengikuti Imax Hello");
+static Trickle  s_helloTrickle = { HELLO_MS, TRICKLE_HELLO_DOUBLINGS, 0 };
+static Trickle  s_advTrickle   = { ROUTE_MS, TRICKLE_ADVERT_DOUBLINGS, TRICKLE_ADVERT_K };
+static uint32_t s_dueBF, s_dueAging;
+static bool     s_timersArmed = false;
+
+// laporan statistik berkala ke kolektor
+static int      s_statsCollector = STATS_COLLECTOR_ID;
+static uint32_t s_statsReportMs  = STATS_REPORT_MS;
+static uint32_t s_dueStats       = 0;
+static bool     s_statsArmed     = false;
+
+static inline uint32_t urand(uint32_t max_exclusive) {
+    return (uint32_t)(esp_random() % (max_exclusive ? max_exclusive : 1));
+}
+
+static inline uint32_t nextDue(uint32_t now, uint32_t period, uint32_t jitter) {
+    return now + period + (jitter ? urand(jitter) : 0);
+}
+
+// kelas antrean TX yang lebih mendesak (TxPrio kecil = lebih dulu)
+static inline TxPrio urgentPrio(TxPrio a, TxPrio b) {
+    return (uint8_t)a < (uint8_t)b ? a : b;
+}
+
+static void scheduleTriggeredUpdate() {
+    uint32_t now = now_ms();
+    uint32_t due = nextDue(now, TRIGGER_HOLDOFF_MS, TRIGGER_JITTER_MS);
+    uint32_t gap = s_lastAdvertMs + TRIGGER_MIN_GAP_MS;
+    if (s_lastAdvertMs != 0 && (int32_t)(gap - due) > 0) due = gap;
+    if (!s_triggerPending || (int32_t)(due - s_dueTrigger) < 0) s_dueTrigger = due;
+    s_triggerPending = true;
+    s_pendingPrio    = TxPrio::Urgent;
+}
+
+// Hello lebih awal (nomor urut tujuan baru), tetap dengan jitter
+static void helloSoon() {
+    if (!s_timersArmed) return;
+    uint32_t now = now_ms();
+    trickleReset(s_helloTrickle, now);
+    trickleFireBy(s_helloTrickle, nextDue(now, TRIGGER_HOLDOFF_MS, TRIGGER_JITTER_MS));
+}
+
+// interval Hello sekarang bila di atas Imin (token WIRE_HELLO_IVL), selain itu 0
+static uint32_t helloIntervalMs() {
+    uint32_t ivl = std::min(s_helloTrickle.interval, trickleImax(s_helloTrickle));
+    return ivl > s_helloTrickle.imin ? ivl : 0;
+}
+
+// rute berubah: iklan kembali ke Imin; tetangga datang/hilang: Hello juga
+static void trickleInconsistent(bool nbrChanged) {
+    if (!s_timersArmed) return;
+    uint32_t now = now_ms();
+    if (nbrChanged) trickleReset(s_helloTrickle, now);
+    trickleReset(s_advTrickle, now);
+}
+
+// iklan tetangga yang tidak mengubah rute kita (hitungan supresi Trickle)
+static void advertConsistent() {
+    trickleHeard(s_advTrickle);
+}
+
+// true (dan jadwal ulang) jika due sudah lewat
+static bool timerFired(uint32_t now, uint32_t& due, uint32_t period, uint32_t jitter) {
+    if ((int32_t)(now - due) < 0) return false;
+    due = nextDue(now, period, jitter);
+    return true;
+}
+
+// -------------------- Iklan delta (v2) --------------------
+// Sender menyimpan snapshot apa yang terakhir diiklankan per tujuan. Iklan
+// periodik/triggered hanya dikirim bila ada entri yang berubah, dan hanya
+// membawa entri yang berubah sejak iklan penuh periodik SEBELUM yang terakhir
+// (delta kumulatif, base = seq iklan penuh itu). Delta yang hilang tertutup
+// oleh delta berikutnya, dan satu iklan penuh yang terlewat juga tidak
+// membuat penerima kehilangan sinkron; selain itu penerima minta resync.
+// Iklan penuh dikirim jauh lebih jarang (saat timer Trickle iklan mencapai
+// Imax, bila tidak ditekan), atau saat delta kumulatif sudah sebesar iklan
+// penuh.
+static constexpr uint32_t RESYNC_HOLDOFF_MS = 200u, RESYNC_JITTER_MS = 800u;
+// permintaan resync ditunda acak supaya tetangga yang kehilangan frame yang
+// sama tidak bertabrakan; yang mendengar permintaan setara menahan miliknya
+static constexpr uint32_t RESYNC_ASK_HOLDOFF_MS = 100u, RESYNC_ASK_JITTER_MS = 2000u;
+// jarak minimum permintaan ke tetangga yang sama (sinkron / belum pernah sinkron)
+static constexpr uint32_t RESYNC_RETRY_MS = 10000u, RESYNC_FULL_RETRY_MS = 30000u;
+
+static uint16_t s_advSeq      = 0;
+static uint16_t s_advBase     = 0;                  // base delta kumulatif
+static uint16_t s_advLastFull = 0;                  // seq frame LAST iklan penuh periodik terakhir
+static uint16_t s_advCost[ROUTING_MAX_NODES];       // INF = tidak diiklankan
+static uint8_t  s_advHop[ROUTING_MAX_NODES];
+static int8_t   s_advRssi[ROUTING_MAX_NODES];
+static uint8_t  s_advDseq[ROUTING_MAX_NODES];       // nomor urut tujuan yang diiklankan
+static uint16_t s_advChanged[ROUTING_MAX_NODES];    // seq delta terakhir yang membawa entri
+static std::bitset<ROUTING_MAX_NODES> s_advPending; // berubah, belum diiklankan
+static std::bitset<ROUTING_MAX_NODES> s_advForce;   // iklankan ulang walau tidak berubah
+static uint32_t s_advKickMs[ROUTING_MAX_NODES];     // kickDestSeq() terakhir per tetangga
+
+static bool     s_fullPending = false;              // iklan penuh tertunda (jatah airtime)
+static uint32_t s_lastFullMs  = 0;                  // iklan penuh (rebase) terakhir
+static bool     s_resyncPending = false, s_resyncFull = false;
+static uint16_t s_resyncHave = 0;
+static uint32_t s_dueResync = 0;
+static uint32_t s_resyncAskedMs[ROUTING_MAX_NODES];
+static uint32_t s_resyncAskDue[ROUTING_MAX_NODES];   // 0 = tidak ada permintaan tertunda
+
+static void advertInit() {
+    s_advSeq  = (uint16_t)esp_random();   // seq baru tiap boot: tetangga pasti resync
+    s_advBase = s_advLastFull = s_advSeq;
+    for (int d = 0; d < ROUTING_MAX_NODES; d++) {
+        s_advCost[d]    = ROUTE_COST_INF;
+        s_advHop[d]     = WIRE_NODE_NONE;
+        s_advRssi[d]    = 0;
+        s_advChanged[d] = s_advSeq;
+    }
+    s_advPending.reset();
+}
+
+static bool helloCarriesSeq() { return useBinaryWire(-1); }
+static uint16_t currentAdvertSeq() { return s_advSeq; }
+
+// bandingkan routingTable dengan snapshot; entri yang berubah signifikan
+// ditandai pending. refreshAll: iklan penuh menyalin semua biaya terbaru.
+static void snapshotRoutes(bool refreshAll) {
+    for (int d = 0; d < ROUTING_MAX_NODES; d++) {
+        const RoutingEntry* e = (d != NODE_ID) ? routingTable.find(d) : nullptr;
+        bool     live = e && e->feasible;   // jalur cadangan diiklankan sebagai ditarik
+        uint16_t cost = live ? (uint16_t)std::min<int32_t>(e->cost, ROUTE_COST_INF) : ROUTE_COST_INF;
+        uint8_t  hop  = (e && e->nextHopId >= 0) ? (uint8_t)e->nextHopId : WIRE_NODE_NONE;
+        // rute yang ditarik membawa nomor urut FD
+        int      fd   = dvFeasibleSeq(d);
+        uint8_t  dseq = live ? e->seqNo : (uint8_t)(fd >= 0 ? fd : s_advDseq[d]);
+        bool had = s_advCost[d] < ROUTE_COST_INF;
+        bool has = cost < ROUTE_COST_INF;
+        // sama seperti triggered update: next hop yang berganti dengan biaya
+        // hampir sama cukup terbawa di iklan penuh berikutnya; nomor urut
+        // baru selalu diiklankan
+        bool changed = had != has || s_advForce.test(d) ||
+                       (has && (dseq != s_advDseq[d] ||
+                                std::abs((int)cost - (int)s_advCost[d]) >= DV_TRIGGER_COST_DELTA));
+        if (changed) s_advPending.set(d);
+        if (changed || (refreshAll && has)) {
+            s_advCost[d] = cost;
+            s_advHop[d]  = hop;
+            s_advRssi[d] = (int8_t)std::max<int>(-128, std::min<int>(127, e ? e->rssi : 0));
+            s_advDseq[d] = dseq;
+        }
+    }
+    s_advForce.reset();
+}
+
+// Entri tujuan nbrId (penarikan dengan nomor urut FD) ikut iklan berikutnya,
+// supaya tetangga itu mendengar nomor urutnya sendiri diracuni dan
+// menaikkannya. Paling sering sekali per DSEQ_KICK_MS per tetangga.
+static constexpr uint32_t DSEQ_KICK_MS = 30000u;
+
+static void kickDestSeq(int nbrId) {
+    uint32_t now = now_ms();
+    if (s_advKickMs[nbrId] != 0 && now - s_advKickMs[nbrId] < DSEQ_KICK_MS) return;
+    s_advKickMs[nbrId] = now | 1u;
+    s_advForce.set(nbrId);
+    scheduleTriggeredUpdate();
+}
+
+static size_t putAdvertEntry(size_t n, int d) {
+    bool has = s_advCost[d] < ROUTE_COST_INF;
+    WireRouteEntry w{ d, s_advHop[d] == WIRE_NODE_NONE ? -1 : s_advHop[d],
+                      has ? (int)s_advCost[d] : (int)WIRE_COST_WITHDRAWN, s_advRssi[d], s_advDseq[d] };
+    return wireEncodeRouteEntry(s_routingFrame + n, sizeof(s_routingFrame) - n, w);
+}
+
+// jatah semua frame iklan sudah dicek lewat routingAirtimeWaitMs() sebelum
+// state iklan diubah.
+// false = tidak diantrekan; pemanggil belum mengubah seq, tinggal ulangi.
+static bool transmitRoutingFrame(TxPrio prio, size_t len) {
+    return radio_send(AirClass::Routing, prio, s_routingFrame, len, true);
+}
+
+// entri per frame iklan v2 (dibatasi panjang frame & dwell time)
+static inline size_t advertMaxEntries() {
+    return (s_maxFrameLen - WIRE_ROUTING_V2_HDR_LEN) / WIRE_ROUTING_ENTRY_LEN;
+}
+
+// ms sampai jatah routing cukup untuk frames frame terpanjang (0 = sekarang).
+// Iklan yang lebih panjang dari bucket cukup menunggu bucket penuh; sisanya
+// jadi utang yang dibayar isi ulang, bukan ditunggu selamanya.
+static uint32_t routingAirtimeWaitMs(size_t frames) {
+    uint64_t need = (uint64_t)frames * loraTimeOnAirUs(sx1276_modem_config(), s_maxFrameLen);
+    need = std::min<uint64_t>(need, airtimeBurstUs(AirClass::Routing));
+    return airtimeWaitMs(AirClass::Routing, (uint32_t)need);
+}
+
+// rute yang masuk iklan penuh menurut snapshot
+static size_t advertisedRoutes() {
+    size_t total = 0;
+    for (int d = 0; d < ROUTING_MAX_NODES; d++) total += s_advCost[d] < ROUTE_COST_INF;
+    return total;
+}
+
+// frame iklan penuh untuk total rute (tabel kosong tetap satu frame FIRST|LAST)
+static size_t fullAdvertFrames(size_t total) {
+    size_t per = advertMaxEntries();
+    return total ? (total + per - 1) / per : 1;
+}
+
+// jeda coba lagi saat antrean TX penuh: kira-kira satu frame iklan di udara
+static uint32_t advertRetryMs() {
+    return std::max<uint32_t>(1, loraTimeOnAirUs(sx1276_modem_config(), s_maxFrameLen) / 1000);
+}
+
+// frame iklan yang boleh masuk kelas prio sekarang: hanya slot kosong (kelas
+// drop-oldest tidak boleh menggusur frame iklan ini sendiri), satu slot
+// disisakan untuk ACK / Hello
+static size_t advertRoom(TxPrio prio) {
+    uint32_t reserve = sx1276_tx_depth(prio) > 1 ? 1 : 0;
+    uint32_t free    = sx1276_tx_free(prio);
+    return free > reserve ? free - reserve : 0;
+}
+
+// Iklan penuh yang sedang dikirim. Frame FIRST..LAST masuk antrean per
+// ronde sebanyak advertRoom(), sisanya menyusul setelah radio mengirim;
+// iklan tabel besar (SF tinggi, ROUTING_MAX_NODES besar) bisa lebih panjang
+// dari kedalaman kelasnya. Seq dan rebase baru maju untuk frame yang benar-
+// benar diantrekan. Selama berjalan iklan lain menunggu (seq berurutan).
+static bool     s_fullTxActive = false;
+static bool     s_fullTxRebase = false;
+static TxPrio   s_fullTxPrio   = TxPrio::Beacon;
+static size_t   s_fullTxTotal  = 0;
+static size_t   s_fullTxFrames = 0, s_fullTxSent = 0;
+static int      s_fullTxNext   = 0;                 // tujuan pertama frame berikutnya
+static uint32_t s_fullTxDue    = 0;
+
+static void finishFullAdvert() {
+    // rute yang ditarik tidak ada di iklan penuh; penerima menariknya di LAST
+    for (int d = 0; d < ROUTING_MAX_NODES; d++) {
+        if (s_advPending.test(d)) s_advChanged[d] = s_advSeq;
+    }
+    if (s_fullTxRebase) {
+        s_lastFullMs  = now_ms();
+        s_advBase     = s_advLastFull;
+        s_advLastFull = s_advSeq;
+        for (uint16_t& c : s_advChanged) {
+            if (!wireSeqAfter(c, s_advBase)) c = s_advBase;   // cegah wrap-around seq lama
+        }
+    }
+    s_advPending.reset();
+    s_fullTxActive = false;
+    ESP_LOGI(TAG, "Full advert: %u entries, %u frame(s), seq %u",
+             (unsigned)s_fullTxTotal, (unsigned)s_fullTxFrames, (unsigned)s_advSeq);
+}
+
+// satu ronde iklan penuh; 0 = selesai, selain itu ms sampai ronde berikutnya.
+// Jatah airtime dicek sekali saat iklan dimulai; ronde hanya menunggu antrean.
+static uint32_t continueFullAdvert() {
+    size_t room = std::min(advertRoom(s_fullTxPrio), s_fullTxFrames - s_fullTxSent);
+    if (room == 0) return advertRetryMs();
+
+    size_t per = advertMaxEntries();
+    for (size_t k = 0; k < room; k++) {
+        size_t   f     = s_fullTxSent;
+        uint16_t seq   = s_advSeq + 1;
+        uint8_t  flags = (f == 0 ? WIRE_FLAG_FIRST : 0) | (f + 1 == s_fullTxFrames ? WIRE_FLAG_LAST : 0);
+        size_t n = wireEncodeRoutingHeaderV2(s_routingFrame, sizeof(s_routingFrame),
+                                             WIRE_TYPE_ROUTING_FULL, NODE_ID, seq, s_advSeq, flags);
+        int d = s_fullTxNext;
+        for (size_t count = 0; d < ROUTING_MAX_NODES && count < per; d++) {
+            if (s_advCost[d] >= ROUTE_COST_INF) continue;
+            n += putAdvertEntry(n, d);
+            count++;
+        }
+        if (!transmitRoutingFrame(s_fullTxPrio, n)) return advertRetryMs();
+        s_advSeq     = seq;
+        s_fullTxNext = d;
+        s_fullTxSent++;
+    }
+    if (s_fullTxSent < s_fullTxFrames) {
+        ESP_LOGD(TAG, "Full advert: %u/%u frame(s) queued, seq %u",
+                 (unsigned)s_fullTxSent, (unsigned)s_fullTxFrames, (unsigned)s_advSeq);
+        return advertRetryMs();
+    }
+    finishFullAdvert();
+    return 0;
+}
+
+static void runFullAdvert(uint32_t now) {
+    uint32_t wait = continueFullAdvert();
+    if (wait > 0) s_fullTxDue = now + wait;
+}
+
+// iklan penuh, dipecah per advertMaxEntries() (FIRST .. LAST). rebase: delta
+// berikutnya dihitung dari iklan ini. Balasan resync tidak rebase, supaya
+// tetangga yang tidak mendengarnya tetap bisa menerapkan delta berikutnya.
+static void sendFullAdvert(TxPrio prio, bool rebase) {
+    snapshotRoutes(true);
+    size_t total = advertisedRoutes();
+
+    s_fullTxActive = true;
+    s_fullTxRebase = rebase;
+    s_fullTxPrio   = prio;
+    s_fullTxTotal  = total;
+    s_fullTxFrames = fullAdvertFrames(total);
+    s_fullTxSent   = 0;
+    s_fullTxNext   = 0;
+    runFullAdvert(now_ms());
+}
+
+// entri delta kumulatif: berubah sejak s_advBase, plus yang belum diiklankan
+// bila withPending (delta baru)
+static bool inCumulativeDelta(int d, bool withPending) {
+    return (withPending && s_advPending.test(d)) || wireSeqAfter(s_advChanged[d], s_advBase);
+}
+
+// false jika tidak muat satu frame, atau sudah mencakup lebih dari separuh
+// tabel (iklan penuh sekalian, supaya base maju)
+static bool cumulativeDeltaFits(bool withPending) {
+    size_t count = 0, total = 0;
+    for (int d = 0; d < ROUTING_MAX_NODES; d++) {
+        count += inCumulativeDelta(d, withPending);
+        total += s_advCost[d] < ROUTE_COST_INF;
+    }
+    return count <= advertMaxEntries() && count * 2 <= total + 1;
+}
+
+// delta kumulatif dengan nomor urut seq; false = tidak diantrekan
+static bool transmitCumulativeDelta(TxPrio prio, uint16_t seq, bool withPending) {
+    size_t count = 0;
+    size_t n = wireEncodeRoutingHeaderV2(s_routingFrame, sizeof(s_routingFrame),
+                                         WIRE_TYPE_ROUTING_DELTA, NODE_ID, seq, s_advBase, 0);
+    for (int d = 0; d < ROUTING_MAX_NODES; d++) {
+        if (!inCumulativeDelta(d, withPending)) continue;
+        n += putAdvertEntry(n, d);
+        count++;
+    }
+    if (!transmitRoutingFrame(prio, n)) return false;
+    ESP_LOGI(TAG, "Delta advert: %u entries, seq %u base %u",
+             (unsigned)count, (unsigned)seq, (unsigned)s_advBase);
+    return true;
+}
+
+// rute hidup di routingTable (yang akan diiklankan iklan penuh berikutnya),
+// tanpa menyentuh snapshot
+static size_t liveRoutes() {
+    size_t total = 0;
+    for (int d = 0; d < ROUTING_MAX_NODES; d++) {
+        const RoutingEntry* e = (d != NODE_ID) ? routingTable.find(d) : nullptr;
+        total += e && e->feasible && e->cost < ROUTE_COST_INF;
+    }
+    return total;
+}
+
+// frame iklan berkala/triggered berikutnya: satu delta, atau iklan penuh bila
+// full / delta kumulatif (menurut pending terakhir) tidak muat
+static size_t nextAdvertFrames(bool full) {
+    if (!full && cumulativeDeltaFits(true)) return 1;
+    return fullAdvertFrames(liveRoutes());
+}
+
+// iklan berkala/triggered: tidak mengirim apa pun bila tidak ada perubahan.
+// false = delta tidak diantrekan (state tidak berubah, coba lagi nanti)
+static bool sendDeltaAdvert(TxPrio prio) {
+    snapshotRoutes(false);
+    if (s_advPending.none()) return true;
+    if (!cumulativeDeltaFits(true)) {
+        sendFullAdvert(prio, true);
+        return true;
+    }
+
+    uint16_t seq = s_advSeq + 1;
+    if (!transmitCumulativeDelta(prio, seq, true)) return false;
+    for (int d = 0; d < ROUTING_MAX_NODES; d++) {
+        if (s_advPending.test(d)) s_advChanged[d] = seq;
+    }
+    s_advPending.reset();
+    s_advSeq = seq;
+    return true;
+}
+
+// balasan resync perlu iklan penuh: peminta tidak punya iklan penuh terakhir
+// (have < s_advBase), atau delta kumulatif tidak muat
+static bool resyncNeedsFull(uint16_t have, bool full) {
+    return full || wireSeqAfter(s_advBase, have) || !cumulativeDeltaFits(false);
+}
+
+static size_t resyncReplyFrames(uint16_t have, bool full) {
+    return resyncNeedsFull(have, full) ? fullAdvertFrames(liveRoutes()) : 1;
+}
+
+// balasan resync: delta kumulatif cukup bila peminta punya iklan penuh
+// terakhir (have >= s_advBase), selain itu iklan penuh. false = delta tidak
+// diantrekan.
+static bool sendResyncReply(uint16_t have, bool full) {
+    if (resyncNeedsFull(have, full)) {
+        sendFullAdvert(TxPrio::Urgent, false);
+        return true;
+    }
+    return transmitCumulativeDelta(TxPrio::Urgent, s_advSeq, false);
+}
+
+// permintaan node lain ke tetangga yang sama: balasannya (broadcast) ikut
+// menyinkronkan kita bila permintaan itu penuh, atau 'have'-nya tidak lebih baru
+static void overheardResync(const WireResync& r) {
+    if (!RoutingTable<ROUTING_MAX_NODES>::inRange(r.target) || s_resyncAskDue[r.target] == 0) return;
+    uint16_t have;
+    bool synced = dvAdvertGetSeq(r.target, have);
+    if ((r.flags & WIRE_RESYNC_FULL) || (synced && !wireSeqAfter(r.have, have))) {
+        s_resyncAskDue[r.target]  = 0;
+        s_resyncAskedMs[r.target] = now_ms() | 1u;
+    }
+}
+
+static void onResyncRequest(const uint8_t* raw, size_t len) {
+    WireResync r;
+    if (!wireDecodeResync(raw, len, r)) {
+        ESP_LOGW(TAG, "Drop: malformed resync frame (%u B)", (unsigned)len);
+        statInc(Stat::RxMalformed);
+        return;
+    }
+    if (r.target != NODE_ID) {
+        overheardResync(r);
+        return;
+    }
+    if (!useBinaryWire(-1)) return;                           // mode teks: selalu penuh
+
+    bool full = (r.flags & WIRE_RESYNC_FULL) != 0;
+    if (!full && r.have == s_advSeq) return;                  // peminta sudah sinkron
+    // 'have' di depan kita: kita reboot sejak peminta terakhir sinkron
+    full = full || !wireSeqAfter(s_advSeq, r.have);
+
+    // kumpulkan permintaan beruntun jadi satu balasan (broadcast)
+    if (!s_resyncPending) {
+        s_resyncPending = true;
+        s_resyncFull    = full;
+        s_resyncHave    = r.have;
+        s_dueResync     = nextDue(now_ms(), RESYNC_HOLDOFF_MS, RESYNC_JITTER_MS);
+    } else {
+        s_resyncFull = s_resyncFull || full;
+        if (wireSeqAfter(s_resyncHave, r.have)) s_resyncHave = r.have;
+    }
+    ESP_LOGI(TAG, "Resync requested by NODE_%d (have %u%s)",
+             r.requester, (unsigned)r.have, full ? ", full" : "");
+}
+
+static void requestResync(int nbrId) {
+    if (!RoutingTable<ROUTING_MAX_NODES>::inRange(nbrId) || s_resyncAskDue[nbrId] != 0) return;
+    uint32_t now = now_ms();
+    uint32_t asked = s_resyncAskedMs[nbrId];
+    uint16_t have;
+    // belum pernah sinkron: entri dari delta tetap dipakai, iklan penuh boleh
+    // ditunggu lebih lama (iklan periodik juga akan datang)
+    uint32_t retry = dvAdvertGetSeq(nbrId, have) ? RESYNC_RETRY_MS : RESYNC_FULL_RETRY_MS;
+    if (asked != 0 && now - asked < retry) return;
+    s_resyncAskDue[nbrId] = nextDue(now, RESYNC_ASK_HOLDOFF_MS, RESYNC_ASK_JITTER_MS) | 1u;
+}
+
+// iklan dari nbrId berhasil diterapkan: permintaan tertunda tidak perlu lagi
+static void cancelResync(int nbrId) {
+    s_resyncAskDue[nbrId] = 0;
+}
+
+static void sendResyncAsk(int nbrId) {
+    WireResync r{ NODE_ID, nbrId, 0, 0 };
+    if (!dvAdvertGetSeq(nbrId, r.have)) r.flags = WIRE_RESYNC_FULL;
+    size_t n = wireEncodeResync(s_routingFrame, sizeof(s_routingFrame), r);
+    if (n == 0 || !radio_send(AirClass::Routing, TxPrio::Urgent, s_routingFrame, n)) {
+        // jatah routing habis: coba lagi saat cukup
+        uint32_t wait = airtimeWaitMs(AirClass::Routing, loraTimeOnAirUs(sx1276_modem_config(), n));
+        s_resyncAskDue[nbrId] = (now_ms() + std::max<uint32_t>(wait, 1)) | 1u;
+        return;
+    }
+    s_resyncAskDue[nbrId] = 0;
+    s_resyncAskedMs[nbrId] = now_ms() | 1u;
+    statInc(Stat::ResyncAsks);
+    ESP_LOGI(TAG, "Resync request to NODE_%d (have %u%s)",
+             nbrId, (unsigned)r.have, (r.flags & WIRE_RESYNC_FULL) ? ", full" : "");
+}
+
+// kirim permintaan resync yang sudah jatuh tempo; kembalikan jarak ke due
+// terdekat (INT32_MAX jika tidak ada)
+static int32_t runResyncAsks(uint32_t now) {
+    int32_t wait = INT32_MAX;
+    for (int id = 0; id < ROUTING_MAX_NODES; id++) {
+        if (s_resyncAskDue[id] == 0) continue;
+        if ((int32_t)(now - s_resyncAskDue[id]) >= 0) sendResyncAsk(id);
+        else wait = std::min(wait, (int32_t)(s_resyncAskDue[id] - now));
+    }
+    return wait;
+}
+
+// -------------------- Laporan statistik --------------------
+void setStatsReport(int collectorId, uint32_t intervalMs) {
+    s_statsCollector = intervalMs ? collectorId : -1;
+    s_statsReportMs  = intervalMs;
+    s_statsArmed     = false;
+}
+
+static void sendStatsReport() {
+    uint8_t snap[STATS_SNAPSHOT_LEN];
+    size_t n = statsSnapshot(snap, sizeof(snap), NODE_ID);
+    if (s_statsCollector == NODE_ID) {
+        StatsReport r;
+        if (statsDecode(snap, n, r)) statsLog(r);
+        return;
+    }
+    if (!sendData(s_statsCollector, snap, n)) {
+        ESP_LOGW(TAG, "Stats report to NODE_%d not sent", s_statsCollector);
+    }
+}
+
+// tunda update: perubahan tetap menunggu di snapshot
+static void deferRoutingUpdate(bool full, TxPrio prio, uint32_t wait) {
+    uint32_t due = now_ms() + std::max<uint32_t>(wait, 1);
+    if (!s_triggerPending || (int32_t)(due - s_dueTrigger) > 0) s_dueTrigger = due;
+    s_triggerPending = true;
+    s_pendingPrio = prio;
+    s_fullPending = full;
+}
+
+// iklan periodik (Beacon) / triggered (Urgent): delta bila semua tetangga
+// paham biner, tabel penuh teks bila masih ada firmware lama
+static void sendRoutingUpdate(bool full, TxPrio prio) {
+    full = full || s_fullPending;
+    // iklan ini juga membawa update tertunda: kelasnya ikut yang paling mendesak
+    if (s_triggerPending) prio = urgentPrio(prio, s_pendingPrio);
+    if (s_fullTxActive) {
+        // iklan penuh sebelumnya belum habis diantrekan
+        int32_t left = (int32_t)(s_fullTxDue - now_ms());
+        deferRoutingUpdate(full, prio, left > 0 ? (uint32_t)left : 1);
+        return;
+    }
+    // jatah untuk seluruh iklan (semua frame) dicek di depan; tabel teks
+    // dihitung sepanjang datagram terpanjang
+    size_t   frames = useBinaryWire(-1) ? nextAdvertFrames(full)
+                                        : std::max<size_t>(1, fragCount(s_maxDatagramLen, s_maxFrameLen));
+    uint32_t wait   = routingAirtimeWaitMs(frames);
+    if (wait > 0) {
+        ESP_LOGW(TAG, "Routing update deferred %u ms: airtime budget", (unsigned)wait);
+        deferRoutingUpdate(full, prio, wait);
+        return;
+    }
+    bool sent = true;
+    if (!useBinaryWire(-1))  sent = sendRoutingTable(-1, prio);
+    else if (full)           sendFullAdvert(prio, true);
+    else                     sent = sendDeltaAdvert(prio);
+    if (!sent) {
+        ESP_LOGW(TAG, "Routing update deferred: TX queue full");
+        deferRoutingUpdate(full, prio, advertRetryMs());
+        return;
+    }
+    s_fullPending    = false;
+    s_triggerPending = false;
+    s_lastAdvertMs   = now_ms();
+}
+
+uint32_t runPeriodicTasks() {
+    uint32_t now = now_ms();
+    if (!s_timersArmed) {
+        trickleStart(s_helloTrickle, now);
+        trickleStart(s_advTrickle, now);
+        s_fullPending = true;                    // iklan pertama selalu penuh
+        s_dueBF    = nextDue(now, BF_MS, 0);
+        s_dueAging = nextDue(now, AGING_MS, 0);
+        s_timersArmed = true;
+    }
+
+    for (TrickleEvent ev; (ev = trickleRun(s_helloTrickle, now)) != TrickleEvent::None;) {
+        if (ev == TrickleEvent::Send) sendHelloMessages();
+    }
+    // iklan periodik: delta bila ada perubahan tertunda; penyegaran penuh di
+    // Imax, atau bila reset beruntun membuat Imax tidak pernah tercapai
+    for (TrickleEvent ev; (ev = trickleRun(s_advTrickle, now)) != TrickleEvent::None;) {
+        if (ev == TrickleEvent::Send) {
+            sendRoutingUpdate(trickleAtMax(s_advTrickle) || now - s_lastFullMs >= trickleImax(s_advTrickle),
+                              TxPrio::Beacon);
+        } else if (ev == TrickleEvent::Suppressed) {
+            statInc(Stat::AdvertSuppressed);
+            ESP_LOGD(TAG, "Periodic advert suppressed");
+        }
+    }
+    if (s_fullTxActive && (int32_t)(now - s_fullTxDue) >= 0) runFullAdvert(now);
+    if (s_triggerPending && (int32_t)(now - s_dueTrigger) >= 0) {
+        ESP_LOGI(TAG, "Triggered routing update");
+        sendRoutingUpdate(false, s_pendingPrio);
+    }
+    if (s_resyncPending && (int32_t)(now - s_dueResync) >= 0) {
+        if (s_fullTxActive) {
+            s_dueResync = s_fullTxDue;
+        } else if (!useBinaryWire(-1)) {
+            s_resyncPending = false;
+        } else if (uint32_t airWait = routingAirtimeWaitMs(resyncReplyFrames(s_resyncHave, s_resyncFull))) {
+            s_dueResync = now + airWait;
+        } else if (sendResyncReply(s_resyncHave, s_resyncFull)) {
+            s_resyncPending = false;
+        } else {
+            s_dueResync = now + advertRetryMs();
+        }
+    }
+    int32_t askWait = runResyncAsks(now);
+    int32_t arqWait = runArq(now);
+    if (timerFired(now, s_dueBF, BF_MS, 0))                     runBellmanFord();
+    if (timerFired(now, s_dueAging, AGING_MS, 0))               checkRoutingTableTimeout();
+    if (s_statsCollector >= 0) {
+        if (!s_statsArmed) {
+            s_dueStats   = nextDue(now, s_statsReportMs, s_statsReportMs / 10);
+            s_statsArmed = true;
+        }
+        if (timerFired(now, s_dueStats, s_statsReportMs, s_statsReportMs / 10)) sendStatsReport();
+    }
+
+    int32_t wait = INT32_MAX;
+    for (uint32_t due : { s_dueBF, s_dueAging }) {
+        wait = std::min(wait, (int32_t)(due - now));
+    }
+    wait = std::min(wait, (int32_t)trickleWaitMs(s_helloTrickle, now));
+    wait = std::min(wait, (int32_t)trickleWaitMs(s_advTrickle, now));
+    if (s_fullTxActive)   wait = std::min(wait, (int32_t)(s_fullTxDue - now));
+    if (s_triggerPending) wait = std::min(wait, (int32_t)(s_dueTrigger - now));
+    if (s_resyncPending)  wait = std::min(wait, (int32_t)(s_dueResync - now));
+    if (s_statsCollector >= 0) wait = std::min(wait, (int32_t)(s_dueStats - now));
+    wait = std::min(wait, askWait);
+    wait = std::min(wait, arqWait);
+    return wait > 0 ? (uint32_t)wait : 0;
+}
@@ -1,17 +1,10 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <cstdint>
+#include <cstddef>
 
-// Maks 10 entri seperti versi Arduino
-struct RoutingEntry {
-    std::string macAddress;   // MAC destinasi "AA:BB:CC:DD:EE:FF"
-    int destination = -1;     // node_id tujuan
-    int rssi = 0;
-    int cost = 10000;
-    std::string nextHop;      // MAC next hop
-    int nextHopId = -1;       // node_id next hop
-    uint32_t lastUpdated = 0; // ms
-};
+#include "routing_table.h"
 
 // ===== API utama yang dipanggil dari main.cpp =====
 void initLoRa();
@@ -19,22 +12,72 @@ void sendHelloMessages();
 void onDataRecv(int packetSize);
 
 void runBellmanFord();
-void forwardData(int targetNode);
+void forwardData(int targetNode);              // pesan uji "Data to NODE_x"
 void checkRoutingTableTimeout();
 
 void sendRoutingTableId();                     // broadcast sekali
 void sendRoutingTableToId(int neighborId);     // targeted (split horizon by id)
-void parseAndUpdateRoutingTableId(const std::string& msg, int rssiToSender);
+void parseAndUpdateRoutingTableId(std::string_view msg, int rssiToSender,
+                                  int snrX4 = LINK_SNR_UNKNOWN);
+void parseAndUpdateRoutingTableBin(const uint8_t* data, size_t len, int rssiToSender,
+                                   int snrX4 = LINK_SNR_UNKNOWN);
 void printRoutingTableId();
-int  LoRa_ParsePacket();  // wrapper untuk polling RX dari main.cpp
+int  LoRa_ParsePacket();                     // RX non-blocking
+int  LoRa_WaitPacket(uint32_t timeoutMs);    // tunggu paket (ISR DIO0) maks timeoutMs
+
+// ===== Data plane multi-hop (frame WIRE_TYPE_DATA, lihat routing_wire.h) =====
+// hop maksimum sebelum frame data dibuang
+#ifndef DATA_TTL
+#define DATA_TTL 16
+#endif
+
+// Kirim payload aplikasi ke destId lewat tabel routing. false = tidak ada
+// rute, payload > dataMaxPayload(), atau jatah airtime data habis.
+bool   sendData(int destId, const void* payload, size_t len);
+size_t dataMaxPayload();                       // dibatasi dwell time modem
+
+// dipanggil (konteks task routing) untuk frame data yang tujuannya node ini
+typedef void (*DataRecvHandler)(int srcId, const uint8_t* payload, size_t len, void* arg);
+void   setDataRecvHandler(DataRecvHandler cb, void* arg);
+
+// ===== Statistik runtime (counter di lora_stats.h) =====
+// Kirim snapshot statistik ke collectorId tiap intervalMs lewat data plane
+// (-1 = mati; collectorId == NODE_ID = hanya dicatat ke log sendiri).
+// Kolektor mencatat laporan yang diterimanya. Default dari
+// STATS_COLLECTOR_ID / STATS_REPORT_MS.
+void   setStatsReport(int collectorId, uint32_t intervalMs);
+
+// ===== Timer Trickle Hello & iklan (trickle.h) =====
+// Hello: interval 10 s berlipat dua sampai 10 s << TRICKLE_HELLO_DOUBLINGS
+// selama himpunan tetangga tetap; kembali ke 10 s saat tetangga datang/hilang.
+// Tanpa supresi (Hello juga tanda hidup & sampel ETX).
+#ifndef TRICKLE_HELLO_DOUBLINGS
+#define TRICKLE_HELLO_DOUBLINGS  1
+#endif
+// Iklan: timer periodik 9 s berlipat dua sampai 9 s << TRICKLE_ADVERT_DOUBLINGS;
+// iklan penuh (penyegaran) di Imax, atau setelah Imax tanpa iklan penuh,
+// dan ditekan bila sudah terdengar TRICKLE_ADVERT_K iklan tetangga yang tidak
+// mengubah rute kita (0 = tidak pernah ditekan). Perubahan tetap dikirim
+// sebagai delta.
+#ifndef TRICKLE_ADVERT_DOUBLINGS
+#define TRICKLE_ADVERT_DOUBLINGS 5
+#endif
+#ifndef TRICKLE_ADVERT_K
+#define TRICKLE_ADVERT_K         2
+#endif
+
+// Jalankan hello/routing/Bellman-Ford/aging yang jatuh tempo;
+// kembalikan ms sampai tenggat berikutnya (dipakai sebagai timeout RX)
+uint32_t runPeriodicTasks();
 
 // ===== Util =====
 std::string macToString(const uint8_t *macAddr);
 int         getDestinationFromMac(const std::string& mac);
 std::string serializeRoutingTableWithSenderId(int targetNextHopId = -1);
+size_t      serializeRoutingTableBin(uint8_t* out, size_t cap, int targetNextHopId = -1);
 
-// Tabel routing global
-extern RoutingEntry routingTable[10];
+// Tabel routing global (diindeks node_id, lihat routing_table.h)
+extern RoutingTable<ROUTING_MAX_NODES> routingTable;
 
 // NODE_ID & mapping MAC<->ID disediakan oleh node.{h,cpp}
 extern int          NODE_ID;
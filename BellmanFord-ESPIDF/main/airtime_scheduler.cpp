@@ -0,0 +1,133 @@
+#include "airtime_scheduler.h"
+
+#include "esp_timer.h"
+
+// ===============================
+//  State bucket
+// ===============================
+// Level disimpan dalam satuan 1e-9 us airtime: jatah per us waktu nyata
+// = DUTY_PPM * SHARE_PERMIL satuan, tanpa floating point.
+static constexpr int64_t UNITS_PER_US = 1000000000LL;
+static constexpr int64_t WINDOW_US    = (int64_t)AIRTIME_BUCKET_WINDOW_S * 1000000LL;
+
+static constexpr uint32_t kShare[AIR_CLASS_COUNT] = {
+    AIRTIME_SHARE_DATA, AIRTIME_SHARE_ROUTING, AIRTIME_SHARE_HELLO
+};
+
+struct Bucket {
+    int64_t  level = 0;
+    int64_t  cap   = 0;
+    uint64_t usedUs = 0;
+    uint32_t denied = 0;
+};
+
+static Bucket  s_bucket[AIR_CLASS_COUNT];
+static int64_t s_lastUs = 0;
+static bool    s_init = false;
+
+// isi ulang dikurangi sebesar burst: cap + rate x periode = duty x periode
+static inline int64_t rateOf(int c) {
+    return (int64_t)AIRTIME_DUTY_PPM * kShare[c] *
+           (AIRTIME_DUTY_PERIOD_S - AIRTIME_BUCKET_WINDOW_S) / AIRTIME_DUTY_PERIOD_S;
+}
+
+static inline int64_t capOf(int c) {
+    return (int64_t)AIRTIME_DUTY_PPM * kShare[c] * WINDOW_US;
+}
+
+static void refill() {
+    int64_t now = esp_timer_get_time();
+    if (!s_init) {
+        for (int c = 0; c < AIR_CLASS_COUNT; c++) {
+            s_bucket[c].cap   = capOf(c);
+            s_bucket[c].level = s_bucket[c].cap;   // boot: bucket penuh
+        }
+        s_lastUs = now;
+        s_init = true;
+        return;
+    }
+    int64_t elapsed = now - s_lastUs;
+    if (elapsed <= 0) return;
+    s_lastUs = now;
+    if (elapsed > WINDOW_US) elapsed = WINDOW_US;  // lebih lama dari ini pasti penuh
+
+    // isi ulang per kelas; kelebihan di atas cap dikumpulkan
+    int64_t spill = 0;
+    for (int c = 0; c < AIR_CLASS_COUNT; c++) {
+        Bucket& b = s_bucket[c];
+        b.level += rateOf(c) * elapsed;
+        if (b.level > b.cap) {
+            spill  += b.level - b.cap;
+            b.level = b.cap;
+        }
+    }
+    // tumpahan dibagikan berurutan prioritas
+    for (int c = 0; c < AIR_CLASS_COUNT && spill > 0; c++) {
+        Bucket& b = s_bucket[c];
+        int64_t room = b.cap - b.level;
+        if (room <= 0) continue;
+        int64_t add = spill < room ? spill : room;
+        b.level += add;
+        spill   -= add;
+    }
+}
+
+// ===============================
+//  API
+// ===============================
+bool airtimeDwellOk(uint32_t toaUs) {
+    return toaUs <= (uint32_t)AIRTIME_MAX_DWELL_MS * 1000u;
+}
+
+bool airtimeAcquire(AirClass cls, uint32_t toaUs) {
+    int c = (int)cls;
+    refill();
+    Bucket& b = s_bucket[c];
+#if AIRTIME_ENFORCE
+    if (b.level < (int64_t)toaUs * UNITS_PER_US) {
+        b.denied++;
+        return false;
+    }
+#endif
+    b.level  -= (int64_t)toaUs * UNITS_PER_US;
+    b.usedUs += toaUs;
+    return true;
+}
+
+void airtimeCharge(AirClass cls, uint32_t toaUs) {
+    int c = (int)cls;
+    refill();
+    s_bucket[c].level  -= (int64_t)toaUs * UNITS_PER_US;
+    s_bucket[c].usedUs += toaUs;
+}
+
+uint32_t airtimeWaitMs(AirClass cls, uint32_t toaUs) {
+#if AIRTIME_ENFORCE
+    int c = (int)cls;
+    refill();
+    int64_t need = (int64_t)toaUs * UNITS_PER_US - s_bucket[c].level;
+    if (need <= 0) return 0;
+    // batas atas: hanya isi ulang kelas ini sendiri (tumpahan bisa mempercepat)
+    int64_t us = (need + rateOf(c) - 1) / rateOf(c);
+    return (uint32_t)((us + 999) / 1000);
+#else
+    (void)cls;
+    (void)toaUs;
+    return 0;
+#endif
+}
+
+uint32_t airtimeBurstUs(AirClass cls) {
+    return (uint32_t)(capOf((int)cls) / UNITS_PER_US);
+}
+
+AirtimeStats airtimeStats() {
+    refill();
+    AirtimeStats st{};
+    for (int c = 0; c < AIR_CLASS_COUNT; c++) {
+        st.usedUs[c]      = s_bucket[c].usedUs;
+        st.denied[c]      = s_bucket[c].denied;
+        st.availableUs[c] = s_bucket[c].level / UNITS_PER_US;
+    }
+    return st;
+}
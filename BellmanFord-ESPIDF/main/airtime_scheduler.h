@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// ====== Scheduler airtime (duty cycle AS923) ======
+//
+// Token bucket per kelas trafik; token = mikrodetik airtime. Kedalaman
+// bucket (burst) + isi ulang selama satu periode observasi tidak pernah
+// melebihi AIRTIME_DUTY_PPM x AIRTIME_DUTY_PERIOD_S, jadi batas duty cycle
+// terpenuhi di jendela mana pun, termasuk tepat setelah boot. Jatah dibagi
+// ke tiap kelas sesuai AIRTIME_SHARE_*. Bucket kelas yang sudah penuh
+// menumpahkan isi ulangnya ke kelas lain berurutan prioritas
+// (Data -> Routing -> Hello),
+// jadi jatah yang tidak terpakai tidak hilang, tetapi trafik kontrol tidak
+// pernah bisa memakai jatah data yang masih dibutuhkan.
+//
+// Sebelum mengirim, pemanggil menghitung time-on-air (lora_airtime.h) lalu
+// airtimeAcquire(); bila ditolak, kontrol ditunda (airtimeWaitMs) atau
+// dibuang (Hello) -- data tidak pernah menunggu di belakang kontrol.
+// Frame yang melewati batas dwell time selalu ditolak.
+
+// 1% duty cycle (10000 ppm)
+#ifndef AIRTIME_DUTY_PPM
+#define AIRTIME_DUTY_PPM        10000
+#endif
+
+// dwell time maksimum per transmisi AS923 (ms)
+#ifndef AIRTIME_MAX_DWELL_MS
+#define AIRTIME_MAX_DWELL_MS    400
+#endif
+
+// periode observasi duty cycle (s)
+#ifndef AIRTIME_DUTY_PERIOD_S
+#define AIRTIME_DUTY_PERIOD_S   3600
+#endif
+
+// kedalaman bucket = jatah airtime selama jendela ini (burst maksimum)
+#ifndef AIRTIME_BUCKET_WINDOW_S
+#define AIRTIME_BUCKET_WINDOW_S 600
+#endif
+
+static_assert(AIRTIME_BUCKET_WINDOW_S < AIRTIME_DUTY_PERIOD_S,
+              "burst harus lebih pendek dari periode duty cycle");
+
+// pembagian jatah per kelas (permil, total 1000)
+#ifndef AIRTIME_SHARE_DATA
+#define AIRTIME_SHARE_DATA      600
+#endif
+#ifndef AIRTIME_SHARE_ROUTING
+#define AIRTIME_SHARE_ROUTING   250
+#endif
+#ifndef AIRTIME_SHARE_HELLO
+#define AIRTIME_SHARE_HELLO     150
+#endif
+
+// 0 = hanya menghitung pemakaian (tidak pernah menolak selain dwell time)
+#ifndef AIRTIME_ENFORCE
+#define AIRTIME_ENFORCE         1
+#endif
+
+static_assert(AIRTIME_SHARE_DATA + AIRTIME_SHARE_ROUTING + AIRTIME_SHARE_HELLO == 1000,
+              "jatah kelas airtime harus berjumlah 1000 permil");
+
+// urutan = prioritas (indeks bucket)
+enum class AirClass : uint8_t { Data = 0, Routing, Hello };
+static constexpr int AIR_CLASS_COUNT = 3;
+
+// true jika frame sepanjang toaUs boleh dikirim sama sekali (dwell time)
+bool     airtimeDwellOk(uint32_t toaUs);
+
+// Minta jatah untuk satu frame: true = boleh kirim sekarang (jatah sudah
+// dipotong), false = jatah kelas ini belum cukup.
+bool     airtimeAcquire(AirClass cls, uint32_t toaUs);
+
+// Potong jatah tanpa cek: frame lanjutan dari satu kiriman yang sudah
+// diizinkan (iklan multi-frame). Bucket boleh negatif (utang dibayar dari
+// isi ulang berikutnya).
+void     airtimeCharge(AirClass cls, uint32_t toaUs);
+
+// ms sampai jatah kelas ini cukup untuk toaUs (0 = sekarang)
+uint32_t airtimeWaitMs(AirClass cls, uint32_t toaUs);
+
+// kedalaman bucket kelas ini (us): jatah terbesar yang pernah tersedia sekaligus
+uint32_t airtimeBurstUs(AirClass cls);
+
+struct AirtimeStats {
+    uint64_t usedUs[AIR_CLASS_COUNT];     // airtime terpakai sejak boot
+    uint32_t denied[AIR_CLASS_COUNT];     // airtimeAcquire() ditolak
+    int64_t  availableUs[AIR_CLASS_COUNT];
+};
+AirtimeStats airtimeStats();
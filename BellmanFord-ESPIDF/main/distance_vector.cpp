@@ -0,0 +1,589 @@
+#include "distance_vector.h"
+#include "LoRaRouting.h"   // routingTable
+#include "node.h"          // NODE_ID
+#include "routing_wire.h"  // wireSeqAfter
+#include "lora_stats.h"
+#include "lora_airtime.h"  // loraDrForSnr
+
+#include <algorithm>
+#include <bitset>
+#include <cstdlib>
+
+#include "esp_log.h"
+
+static const char* TAG = "DV";
+
+using Table = RoutingTable<ROUTING_MAX_NODES>;
+
+// ===============================
+//  State per tetangga
+// ===============================
+struct Neighbor {
+    int16_t  id        = -1;              // -1 = slot kosong
+    int16_t  rssi      = 0;               // EWMA dibulatkan (dBm)
+    int32_t  link      = ROUTE_COST_INF;  // biaya link (linkCost)
+    uint32_t lastHeard = 0;               // ms
+
+    // kualitas link (fixed point, lihat linkCost)
+    int32_t  rssiQ     = 0;               // dBm x16
+    int32_t  snrQ      = LINK_SNR_UNKNOWN;// snr_x4 x16
+    int32_t  delivery  = 0;               // rasio Hello, Q16 (65536 = 100%)
+    int32_t  ackRatio  = 0;               // rasio ACK frame data (ARQ), Q16
+    uint16_t helloSeq  = 0;
+    bool     helloSeen = false;
+    uint32_t helloIvl  = 0;               // interval Hello pengirim (ms, 0 = dasar)
+    uint8_t  rxDr      = 0;               // DR yang kita minta (loraDrForSnr)
+    uint8_t  txDr      = 0;               // DR yang diminta tetangga
+    uint16_t adv[ROUTING_MAX_NODES];      // biaya iklan ke tiap tujuan (INF = tidak ada)
+    uint8_t  dseq[ROUTING_MAX_NODES];     // nomor urut tujuan di iklan
+    std::bitset<ROUTING_MAX_NODES> dseqKnown;
+    bool     noDseq    = false;           // firmware lama: Hello tanpa nomor urut tujuan
+
+    // iklan v2
+    uint16_t advSeq    = 0;               // seq terakhir yang sudah diterapkan
+    bool     synced    = false;
+    bool     fullOpen  = false;           // iklan penuh multi-frame sedang diterima
+    std::bitset<ROUTING_MAX_NODES> seen;  // tujuan di iklan penuh yang sedang diterima
+};
+
+static_assert(ROUTE_COST_INF <= 0xFFFF, "adv[] disimpan sebagai u16");
+
+static Neighbor s_nbr[ROUTING_MAX_NEIGHBORS];
+// node_id -> slot+1 (0 = bukan tetangga), valid sejak zero-init
+static uint8_t  s_slotOf[ROUTING_MAX_NODES];
+
+static std::bitset<ROUTING_MAX_NODES> s_dirty;   // tujuan yang perlu dihitung ulang
+
+// stabilitas rute per tujuan (lihat DV_FLAP_* di distance_vector.h)
+static uint32_t s_switchMs[ROUTING_MAX_NODES];   // pergantian next hop terakhir
+static uint16_t s_flap[ROUTING_MAX_NODES];       // penalti flap saat s_flapMs
+static uint32_t s_flapMs[ROUTING_MAX_NODES];
+static std::bitset<ROUTING_MAX_NODES> s_suppressed;
+
+// jarak kelayakan (FD) per tujuan: nomor urut + biaya terkecil rute yang dipakai
+static uint8_t  s_fdSeq[ROUTING_MAX_NODES];
+static uint16_t s_fdCost[ROUTING_MAX_NODES];
+static uint32_t s_lostMs[ROUTING_MAX_NODES];     // rute terakhir hilang (GC FD)
+static std::bitset<ROUTING_MAX_NODES> s_fdValid;
+
+static inline int slotOf(int id) {
+    return Table::inRange(id) ? (int)s_slotOf[id] - 1 : -1;
+}
+
+// ===============================
+//  Kualitas link
+// ===============================
+static constexpr int32_t Q_ONE = 1 << 16;
+
+static inline int32_t ewma(int32_t avg, int32_t sample, int shift = LQ_EWMA_SHIFT) {
+    return avg + (sample - avg) / (1 << shift);
+}
+
+static uint32_t etxX100(int32_t delivery) {
+    if (delivery <= 0) return LQ_ETX_MAX_X100;
+    uint64_t d = (uint64_t)delivery;   // Q16
+    uint64_t etx = (100ull << 16) / d;   // 1 / d
+    return (uint32_t)std::min<uint64_t>(etx, LQ_ETX_MAX_X100);
+}
+
+// (-RSSI + penalti SNR) x ETX, dalam satuan dB seperti biaya iklan
+static int32_t linkCost(int32_t rssiQ, int32_t snrQ, int32_t delivery) {
+    int32_t base = -rssiQ / 16;
+    if (base < 1) base = 1;
+    if (snrQ != LINK_SNR_UNKNOWN) {
+        int32_t snrDb = snrQ / (16 * 4);
+        if (snrDb < LQ_SNR_GOOD_DB) base += (LQ_SNR_GOOD_DB - snrDb) * LQ_SNR_PENALTY;
+    }
+    int64_t c = (int64_t)base * etxX100(delivery) / 100;
+    return (int32_t)std::min<int64_t>(c, ROUTE_COST_INF - 1);
+}
+
+static inline int32_t linkCostOf(const Neighbor& n) {
+    return linkCost(n.rssiQ, n.snrQ, std::min(n.delivery, n.ackRatio));
+}
+
+// semua tujuan yang (mungkin) dicapai lewat tetangga di slot ini
+static void markVia(int slot) {
+    const Neighbor& n = s_nbr[slot];
+    for (int d = 0; d < ROUTING_MAX_NODES; d++) {
+        if (n.adv[d] < ROUTE_COST_INF) s_dirty.set(d);
+    }
+}
+
+static void removeSlot(int slot) {
+    Neighbor& n = s_nbr[slot];
+    markVia(slot);
+    s_slotOf[n.id] = 0;
+    n.id = -1;
+}
+
+// slot baru dengan sampel pertama link
+static int allocSlot(int id, int rssi, int snrX4) {
+    int32_t snrQ = snrX4 != LINK_SNR_UNKNOWN ? snrX4 * 16 : LINK_SNR_UNKNOWN;
+    int32_t delivery = Q_ONE / 100 * LQ_INIT_DELIVERY_PCT;
+    int32_t link = linkCost(rssi * 16, snrQ, delivery);
+
+    int worst = -1;
+    for (int k = 0; k < ROUTING_MAX_NEIGHBORS; k++) {
+        if (s_nbr[k].id < 0) { worst = k; break; }
+        if (worst < 0 || s_nbr[k].link > s_nbr[worst].link) worst = k;
+    }
+    if (s_nbr[worst].id >= 0) {
+        // tabel penuh: ganti tetangga terburuk hanya jika link baru lebih baik
+        if (s_nbr[worst].link <= link) {
+            statInc(Stat::NbrTableFull);
+            return -1;
+        }
+        ESP_LOGW(TAG, "Neighbor table full, evicting NODE_%d", s_nbr[worst].id);
+        statInc(Stat::NbrEvicted);
+        removeSlot(worst);
+    }
+    Neighbor& n = s_nbr[worst];
+    n.id        = (int16_t)id;
+    n.rssiQ     = rssi * 16;
+    n.snrQ      = snrQ;
+    n.delivery  = delivery;
+    n.ackRatio  = Q_ONE;
+    n.helloSeen = false;
+    n.helloIvl  = 0;
+    n.rxDr      = snrX4 != LINK_SNR_UNKNOWN ? loraDrForSnr(snrX4, 0) : 0;
+    n.txDr      = 0;
+    n.link      = link;
+    n.synced    = false;
+    n.fullOpen  = false;
+    for (uint16_t& a : n.adv) a = ROUTE_COST_INF;
+    n.adv[id] = 0;                        // tetangga itu sendiri
+    n.dseqKnown.reset();
+    n.noDseq    = false;
+    s_slotOf[id] = (uint8_t)(worst + 1);
+    s_dirty.set(id);
+    return worst;
+}
+
+// ===============================
+//  Input: link & iklan
+// ===============================
+// biaya link dihitung ulang dari estimasi terbaru
+static void relink(int slot) {
+    Neighbor& n = s_nbr[slot];
+    int32_t link = linkCostOf(n);
+    if (n.link != link) {
+        markVia(slot);
+        n.link = link;
+    }
+}
+
+bool dvLinkUpdate(int nbrId, int rssi, int snrX4, uint32_t now) {
+    if (!Table::inRange(nbrId) || nbrId == NODE_ID) return false;
+
+    int slot = slotOf(nbrId);
+    if (slot < 0) {
+        slot = allocSlot(nbrId, rssi, snrX4);
+        if (slot < 0) return false;
+    } else {
+        Neighbor& n = s_nbr[slot];
+        n.rssiQ = ewma(n.rssiQ, rssi * 16);
+        if (snrX4 != LINK_SNR_UNKNOWN) {
+            n.snrQ = n.snrQ == LINK_SNR_UNKNOWN ? snrX4 * 16 : ewma(n.snrQ, snrX4 * 16);
+            n.rxDr = loraDrForSnr(n.snrQ / 16, n.rxDr);
+        }
+        relink(slot);
+    }
+    Neighbor& n = s_nbr[slot];
+    n.rssi      = (int16_t)(n.rssiQ / 16);
+    n.lastHeard = now;
+
+    // rute lewat tetangga ini masih hidup
+    for (RoutingEntry& e : routingTable) {
+        if (e.used() && e.nextHopId == nbrId) e.lastUpdated = now;
+    }
+    return true;
+}
+
+void dvHelloSeq(int nbrId, uint16_t seq) {
+    int slot = slotOf(nbrId);
+    if (slot < 0) return;
+    Neighbor& n = s_nbr[slot];
+    uint16_t gap = (uint16_t)(seq - n.helloSeq);
+    bool first = !n.helloSeen;
+    n.helloSeen = true;
+    n.helloSeq  = seq;
+    // Hello pertama, duplikat, atau lompatan besar / mundur (reboot): tidak ada
+    // informasi kehilangan
+    if (first || gap == 0 || gap > LQ_HELLO_GAP_MAX) return;
+
+    for (uint16_t k = 1; k < gap; k++) n.delivery = ewma(n.delivery, 0, LQ_HELLO_EWMA_SHIFT);
+    n.delivery = ewma(n.delivery, Q_ONE, LQ_HELLO_EWMA_SHIFT);
+    relink(slot);
+}
+
+void dvLinkTxResult(int nbrId, bool acked) {
+    int slot = slotOf(nbrId);
+    if (slot < 0) return;
+    Neighbor& n = s_nbr[slot];
+    n.ackRatio = ewma(n.ackRatio, acked ? Q_ONE : 0, LQ_ACK_EWMA_SHIFT);
+    relink(slot);
+}
+
+void dvHelloInterval(int nbrId, uint32_t ivlMs) {
+    int slot = slotOf(nbrId);
+    if (slot < 0) return;
+    s_nbr[slot].helloIvl = std::min<uint32_t>(ivlMs, LQ_HELLO_IVL_MAX_MS);
+}
+
+void dvNeighborTxDr(int nbrId, uint8_t dr) {
+    int slot = slotOf(nbrId);
+    if (slot < 0) return;
+    s_nbr[slot].txDr = dr < loraDrCount() ? dr : 0;
+}
+
+uint8_t dvTxDr(int nbrId) {
+    int slot = slotOf(nbrId);
+    return slot < 0 ? 0 : s_nbr[slot].txDr;
+}
+
+void dvDestSeq(int nbrId, int seq) {
+    int slot = slotOf(nbrId);
+    if (slot < 0) return;
+    Neighbor& n = s_nbr[slot];
+    if (seq < 0) {
+        if (!n.noDseq) s_dirty.set(nbrId);
+        n.noDseq = true;
+    } else if (!n.dseqKnown.test(nbrId) || n.dseq[nbrId] != (uint8_t)seq) {
+        n.dseqKnown.set(nbrId);
+        n.dseq[nbrId] = (uint8_t)seq;
+        s_dirty.set(nbrId);
+    }
+}
+
+int dvNeighbors(DvLinkInfo* out, int max) {
+    int c = 0;
+    for (const Neighbor& n : s_nbr) {
+        if (n.id < 0 || c >= max) continue;
+        DvLinkInfo& i = out[c++];
+        i.id          = n.id;
+        i.rssi        = n.rssi;
+        i.snrX4       = n.snrQ != LINK_SNR_UNKNOWN ? n.snrQ / 16 : LINK_SNR_UNKNOWN;
+        i.deliveryPct = (int)((int64_t)n.delivery * 100 / Q_ONE);
+        i.ackPct      = (int)((int64_t)n.ackRatio * 100 / Q_ONE);
+        i.etxX100     = (int)etxX100(std::min(n.delivery, n.ackRatio));
+        i.cost        = n.link;
+        i.lastHeard   = n.lastHeard;
+        i.rxDr        = n.rxDr;
+        i.txDr        = n.txDr;
+    }
+    return c;
+}
+
+void dvAdvertBegin(int nbrId, bool full) {
+    int slot = slotOf(nbrId);
+    if (slot < 0 || !full) return;
+    s_nbr[slot].seen.reset();
+    s_nbr[slot].fullOpen = true;
+}
+
+void dvAdvertEntry(int nbrId, int destId, int cost, int nextHopId, int seq) {
+    int slot = slotOf(nbrId);
+    if (slot < 0 || !Table::inRange(destId) || destId == NODE_ID || destId == nbrId) return;
+
+    // poisoned reverse: tetangga merutekan tujuan ini lewat kita
+    uint16_t c = (cost < 0 || cost >= ROUTE_COST_INF || nextHopId == NODE_ID)
+                 ? (uint16_t)ROUTE_COST_INF : (uint16_t)cost;
+    Neighbor& n = s_nbr[slot];
+    if (n.fullOpen) n.seen.set(destId);
+
+    uint16_t& a = n.adv[destId];
+    if (a != c) {
+        a = c;
+        s_dirty.set(destId);
+    }
+    bool known = seq >= 0;
+    if (n.dseqKnown.test(destId) != known || (known && n.dseq[destId] != (uint8_t)seq)) {
+        n.dseqKnown.set(destId, known);
+        n.dseq[destId] = (uint8_t)seq;
+        s_dirty.set(destId);
+        // penarikan dengan nomor urut lebih baru (poisoning): semua rute dengan
+        // nomor urut lama tidak layak lagi, penarikan menyebar
+        if (known && c >= ROUTE_COST_INF && s_fdValid.test(destId) &&
+            wireSeq8After((uint8_t)seq, s_fdSeq[destId])) {
+            s_fdSeq[destId]  = (uint8_t)seq;
+            s_fdCost[destId] = ROUTE_COST_INF;
+        }
+    }
+}
+
+void dvAdvertEnd(int nbrId, bool last) {
+    int slot = slotOf(nbrId);
+    if (slot < 0) return;
+    Neighbor& n = s_nbr[slot];
+    if (!last || !n.fullOpen) return;
+    n.fullOpen = false;
+    for (int d = 0; d < ROUTING_MAX_NODES; d++) {
+        if (d != nbrId && !n.seen.test(d) && n.adv[d] < ROUTE_COST_INF) {
+            n.adv[d] = ROUTE_COST_INF;    // tidak diiklankan lagi
+            s_dirty.set(d);
+        }
+    }
+}
+
+DvSeq dvAdvertCheck(int nbrId, uint16_t seq, uint16_t base, bool first) {
+    int slot = slotOf(nbrId);
+    if (slot < 0) return DvSeq::Gap;
+    const Neighbor& n = s_nbr[slot];
+    if (first) return DvSeq::Apply;
+    if (!n.synced) return DvSeq::Gap;
+    if (seq == n.advSeq) return DvSeq::Duplicate;
+    // frame lebih baru dan dimulai dari state yang sudah kita punya
+    if (wireSeqAfter(seq, n.advSeq) && !wireSeqAfter(base, n.advSeq)) return DvSeq::Apply;
+    return DvSeq::Gap;   // ada frame terlewat, atau pengirim reboot (seq mundur)
+}
+
+void dvAdvertSetSeq(int nbrId, uint16_t seq) {
+    int slot = slotOf(nbrId);
+    if (slot < 0) return;
+    s_nbr[slot].advSeq = seq;
+    s_nbr[slot].synced = true;
+}
+
+bool dvAdvertGetSeq(int nbrId, uint16_t& seq) {
+    int slot = slotOf(nbrId);
+    if (slot < 0 || !s_nbr[slot].synced) return false;
+    seq = s_nbr[slot].advSeq;
+    return true;
+}
+
+static inline uint32_t timeoutOf(const Neighbor& n, uint32_t timeoutMs) {
+    return std::max<uint32_t>(timeoutMs, n.helloIvl * LQ_TIMEOUT_HELLOS);
+}
+
+uint32_t dvNeighborTimeoutMs(int nbrId, uint32_t timeoutMs) {
+    int slot = slotOf(nbrId);
+    return slot < 0 ? timeoutMs : timeoutOf(s_nbr[slot], timeoutMs);
+}
+
+void dvExpire(uint32_t now, uint32_t timeoutMs) {
+    for (int k = 0; k < ROUTING_MAX_NEIGHBORS; k++) {
+        if (s_nbr[k].id >= 0 && now - s_nbr[k].lastHeard > timeoutOf(s_nbr[k], timeoutMs)) {
+            ESP_LOGW(TAG, "Neighbor timeout: NODE_%d", s_nbr[k].id);
+            statInc(Stat::NbrTimeout);
+            removeSlot(k);
+        }
+    }
+    // FD tujuan yang sudah lama tanpa rute (juga cadangan): iklan basi sudah
+    // hilang dari jaringan
+    for (int d = 0; d < ROUTING_MAX_NODES; d++) {
+        if (s_fdValid.test(d) && !routingTable.find(d) && now - s_lostMs[d] > DV_FD_HOLD_MS) {
+            s_fdValid.reset(d);
+            s_dirty.set(d);
+        }
+    }
+}
+
+void dvMarkAll() {
+    s_dirty.set();
+}
+
+int dvNeighborCount() {
+    int c = 0;
+    for (const Neighbor& n : s_nbr) c += (n.id >= 0);
+    return c;
+}
+
+// ===============================
+//  Flap damping
+// ===============================
+// penalti meluruh: separuh tiap half-life, linear di antaranya
+static uint32_t flapDecay(int d, uint32_t now) {
+    uint32_t p  = s_flap[d];
+    uint32_t dt = now - s_flapMs[d];
+    if (p == 0) return 0;
+    uint32_t halves = dt / DV_FLAP_HALFLIFE_MS;
+    if (halves >= 16) return 0;
+    p >>= halves;
+    p -= (uint32_t)((uint64_t)p * (dt % DV_FLAP_HALFLIFE_MS) / (2 * DV_FLAP_HALFLIFE_MS));
+    return p;
+}
+
+static void flapUpdate(int d, uint32_t now, bool flapped) {
+    uint32_t p = flapDecay(d, now) + (flapped ? DV_FLAP_PENALTY : 0);
+    s_flap[d]   = (uint16_t)std::min<uint32_t>(p, 0xFFFF);
+    s_flapMs[d] = now;
+    if (!s_suppressed.test(d) && p >= DV_FLAP_SUPPRESS) {
+        ESP_LOGW(TAG, "Route to NODE_%d flapping, damped (penalty %u)", d, (unsigned)p);
+        s_suppressed.set(d);
+        statInc(Stat::RouteDampened);
+    } else if (s_suppressed.test(d) && p < DV_FLAP_REUSE) {
+        s_suppressed.reset(d);
+    }
+}
+
+int dvFlapPenalty(int destId, uint32_t now, bool* suppressed) {
+    if (!Table::inRange(destId)) return 0;
+    flapUpdate(destId, now, false);
+    if (suppressed) *suppressed = s_suppressed.test(destId);
+    return s_flap[destId];
+}
+
+// Pertahankan next hop sekarang (biaya curCost) daripada pindah ke jalur best?
+static bool holdNextHop(int d, const Neighbor& cur, int32_t curCost, int32_t best, uint32_t now) {
+    if (curCost >= ROUTE_COST_INF) return false;            // next hop putus
+    // Hello Trickle bisa berjarak sampai 1,5 interval
+    uint32_t fresh = std::max<uint32_t>(DV_HOLD_FRESH_MS, cur.helloIvl * 8 / 5);
+    if (now - cur.lastHeard > fresh) return false;              // next hop basi
+    flapUpdate(d, now, false);
+    if (s_suppressed.test(d)) return true;
+    if (s_switchMs[d] != 0 && now - s_switchMs[d] < DV_HOLDDOWN_MS) return true;
+    int32_t margin = std::max<int32_t>(DV_SWITCH_MIN_DELTA, curCost * DV_SWITCH_PCT / 100);
+    return best > curCost - margin;
+}
+
+// ===============================
+//  Kelayakan (nomor urut tujuan)
+// ===============================
+// nomor urut iklan tetangga untuk d; tanpa nomor urut = sama dengan FD
+static inline uint8_t advSeqOf(const Neighbor& n, int d) {
+    return n.dseqKnown.test(d) ? n.dseq[d] : s_fdSeq[d];
+}
+
+// jalur lewat n tidak mungkin kembali lewat node ini
+static bool feasible(const Neighbor& n, int d) {
+    if (!s_fdValid.test(d)) return true;
+    uint8_t seq = advSeqOf(n, d);
+    // link langsung tidak bisa loop, tetapi nomor urut tujuan yang tertinggal
+    // dari FD (reboot, atau rute ke dia sedang diracuni) harus dinaikkan dulu
+    if (d == n.id) return !wireSeq8After(s_fdSeq[d], seq);
+    if (seq != s_fdSeq[d]) return wireSeq8After(seq, s_fdSeq[d]);
+    return n.adv[d] < s_fdCost[d];
+}
+
+// FD hanya maju (nomor urut lebih baru) atau mengecil (nomor urut sama)
+static void fdUpdate(int d, uint8_t seq, int32_t cost) {
+    uint16_t c = (uint16_t)std::min<int32_t>(cost, ROUTE_COST_INF);
+    if (s_fdValid.test(d) && wireSeq8After(s_fdSeq[d], seq)) return;
+    if (!s_fdValid.test(d) || seq != s_fdSeq[d]) {
+        s_fdValid.set(d);
+        s_fdSeq[d]  = seq;
+        s_fdCost[d] = c;
+    } else if (c < s_fdCost[d]) {
+        s_fdCost[d] = c;
+    }
+}
+
+int dvFeasibleSeq(int destId) {
+    return (Table::inRange(destId) && s_fdValid.test(destId)) ? s_fdSeq[destId] : -1;
+}
+
+// ===============================
+//  Rekomputasi tujuan dirty
+// ===============================
+// Rute layak ke d putus (hilang, atau tinggal jalur cadangan): tarik dengan
+// nomor urut ganjil = FD + 1 supaya penarikan menang atas semua iklan lama
+static void poison(int d) {
+    if (!s_fdValid.test(d) || (s_fdSeq[d] & 1)) return;   // sudah diracuni
+    s_fdSeq[d]++;
+    s_fdCost[d] = ROUTE_COST_INF;
+    statInc(Stat::RoutePoisoned);
+}
+
+int dvRecompute(uint32_t now) {
+    if (s_dirty.none()) return 0;
+
+    int changed = 0;
+    for (int d = 0; d < ROUTING_MAX_NODES; d++) {
+        if (!s_dirty.test(d) || d == NODE_ID) continue;
+
+        RoutingEntry* e = routingTable.find(d);
+        int curHop = e ? e->nextHopId : -1;
+
+        int32_t best = ROUTE_COST_INF, curCost = ROUTE_COST_INF, spareCost = ROUTE_COST_INF;
+        int     bestSlot = -1, curSlot = -1, spareSlot = -1;
+        for (int k = 0; k < ROUTING_MAX_NEIGHBORS; k++) {
+            const Neighbor& n = s_nbr[k];
+            if (n.id < 0 || n.adv[d] >= ROUTE_COST_INF) continue;
+            int32_t c = n.link + n.adv[d];
+            if (!feasible(n, d)) {
+                if (c < spareCost) {
+                    spareCost = c;
+                    spareSlot = k;
+                }
+                continue;
+            }
+            if (n.id == curHop) {
+                curCost = c;
+                curSlot = k;
+            }
+            // seri: pertahankan next hop sekarang
+            if (c < best || (c == best && n.id == curHop)) {
+                best = c;
+                bestSlot = k;
+            }
+        }
+
+        bool fallback = false;
+        if (bestSlot < 0 || best >= ROUTE_COST_INF) {
+            if (spareSlot < 0) {
+                if (e) {
+                    ESP_LOGI(TAG, "Route lost: NODE_%d", d);
+                    if (e->feasible) poison(d);
+                    s_lostMs[d] = now;
+                    routingTable.erase(d);
+                    flapUpdate(d, now, true);
+                    changed++;
+                }
+                continue;
+            }
+            // Hanya jalur yang tidak layak tersisa: tetap dipakai data plane
+            // sebagai cadangan, tetapi diiklankan sebagai ditarik (tidak ada
+            // yang merutekan lewat kita di atasnya).
+            if (!e || e->feasible) {
+                ESP_LOGI(TAG, "Route to NODE_%d unfeasible, fallback via NODE_%d", d, s_nbr[spareSlot].id);
+                if (e) poison(d);
+                s_lostMs[d] = now;
+            }
+            best     = spareCost;
+            bestSlot = spareSlot;
+            fallback = true;
+        } else if (curSlot >= 0 && bestSlot != curSlot &&
+                   !wireSeq8After(advSeqOf(s_nbr[bestSlot], d), advSeqOf(s_nbr[curSlot], d)) &&
+                   holdNextHop(d, s_nbr[curSlot], curCost, best, now)) {
+            // hysteresis / hold-down / damping: jalur lama tetap dipakai, kecuali
+            // jalur baru membawa nomor urut yang lebih baru
+            statInc(Stat::RouteSwitchHeld);
+            best     = curCost;
+            bestSlot = curSlot;
+        }
+
+        const Neighbor& n = s_nbr[bestSlot];
+        if (!e) e = routingTable.upsert(d);
+        // Link langsung yang Hello ber-nomor-urutnya belum terdengar langsung
+        // dipakai; diiklankan dengan nomor urut FD, atau belum diiklankan sama
+        // sekali bila FD belum ada / sedang diracuni (nomor urut karangan bisa
+        // mengalahkan nomor urut asli di node lain). advSeqOf() link seperti
+        // itu = nomor urut FD, jadi lolos feasible().
+        bool seqUnknown = d == n.id && !n.dseqKnown.test(d) && !n.noDseq;
+        if (seqUnknown && (!s_fdValid.test(d) || (s_fdSeq[d] & 1))) fallback = true;
+        // Jalur cadangan membawa nomor urut FD (iklan penarikan).
+        uint8_t seq = fallback ? s_fdSeq[d] : advSeqOf(n, d);
+        // Tetangga hanya melihat biaya kita; next hop yang berganti dengan biaya
+        // hampir sama tidak perlu diiklankan segera (iklan periodik cukup).
+        // Nomor urut baru ikut iklan berikutnya (snapshot iklan), tidak
+        // memicu triggered update sendiri.
+        bool significant = curHop < 0 || e->feasible == fallback ||
+                           std::abs((int)(e->cost - best)) >= DV_TRIGGER_COST_DELTA;
+        if (!fallback && !seqUnknown) fdUpdate(d, seq, best);
+        e->feasible    = !fallback;
+        e->seqNo       = seq;
+        e->cost        = best;
+        e->nextHopId   = n.id;
+        e->rssi        = n.rssi;              // RSSI link ke next hop
+        e->lastUpdated = n.lastHeard;
+        if (significant) changed++;
+        if (curHop >= 0 && curHop != n.id) {
+            statInc(Stat::NextHopChanges);
+            flapUpdate(d, now, true);
+            s_switchMs[d] = now | 1u;
+        }
+    }
+    s_dirty.reset();
+    return changed;
+}
@@ -0,0 +1,227 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+#include "routing_table.h"
+
+// ====== Distance vector inkremental (pengganti Bellman-Ford periodik) ======
+//
+// Per tetangga disimpan biaya link (dari RSSI) dan vektor biaya yang terakhir
+// diiklankannya (indeks = node_id tujuan). Rute ke tujuan d:
+//
+//     cost(d) = min_k ( link(k) + adv(k, d) ),  adv(k, k) = 0
+//
+// Perubahan link / iklan hanya menandai tujuan yang terdampak ("dirty");
+// dvRecompute() menghitung ulang tujuan dirty saja, O(dirty x tetangga),
+// lalu menulis hasilnya ke routingTable. Entri iklan yang next hop-nya
+// adalah node ini sendiri dianggap tak terjangkau (poisoned reverse) supaya
+// rute tidak memantul balik saat link putus. Node sendiri = NODE_ID.
+//
+// Biaya link = (-RSSI + penalti SNR) x ETX. RSSI dan SNR dihaluskan EWMA
+// dari setiap frame tetangga. ETX = 1 / d, d = rasio Hello yang sampai
+// (EWMA, dihitung dari nomor urut Hello; hanya arah terima yang terukur).
+// Jadi satu sampel berisik tidak membalik rute, dan link kuat yang sering
+// kehilangan paket tetap mahal. Link yang dipakai frame data juga terukur
+// di arah kirim: tiap percobaan ARQ (lora_arq.h) yang di-ACK / timeout
+// menjadi sampel rasio ACK, dan ETX memakai rasio terendah dari keduanya.
+//
+// Bebas loop (nomor urut tujuan, gaya DSDV/Babel): tiap tujuan menerbitkan
+// nomor urut genap untuk dirinya sendiri (routing_wire.h). Per tujuan
+// disimpan "jarak kelayakan" (FD) = (nomor urut, biaya terkecil) rute yang
+// pernah dipakai. Iklan tetangga hanya layak dipakai bila nomor urutnya lebih
+// baru dari FD, atau sama dan biaya iklannya < biaya FD; jalur yang kembali
+// lewat node ini selalu gagal syarat itu, jadi count-to-infinity tidak
+// terjadi. Rute layak yang putus ditarik dengan nomor urut ganjil FD + 1
+// (poisoning); penarikan itu lebih baru dari semua iklan lama, jadi tetangga
+// yang mendengarnya ikut menarik dan rute ke node yang mati hilang dari
+// seluruh jaringan dalam beberapa interval iklan. Tujuan yang masih hidup
+// menjawab dengan nomor urut genap berikutnya. Selama itu jalur terbaik yang
+// tidak layak tetap dipakai data plane sebagai cadangan
+// (RoutingEntry::feasible = false) tetapi tidak pernah diiklankan, jadi loop
+// tidak terbentuk di control plane. Tetangga langsung yang nomor urutnya
+// tertinggal dari FD (reboot) diingatkan lewat iklan ulang penarikan itu.
+// FD dilupakan DV_FD_HOLD_MS setelah rute terakhir, termasuk cadangan, hilang.
+
+#ifndef ROUTING_MAX_NEIGHBORS
+#define ROUTING_MAX_NEIGHBORS 16
+#endif
+
+// perubahan biaya sekecil ini (dB) tidak dianggap "rute berubah"
+#ifndef DV_TRIGGER_COST_DELTA
+#define DV_TRIGGER_COST_DELTA 10
+#endif
+
+// ---- Stabilitas rute ----
+// Next hop hanya diganti bila jalur baru lebih murah setidaknya
+// max(DV_SWITCH_MIN_DELTA, DV_SWITCH_PCT% biaya sekarang), paling cepat
+// DV_HOLDDOWN_MS setelah pergantian sebelumnya. Tiap pergantian / rute hilang
+// menambah penalti flap per tujuan (DV_FLAP_PENALTY) yang meluruh
+// eksponensial (half-life DV_FLAP_HALFLIFE_MS). Di atas DV_FLAP_SUPPRESS rute
+// "diredam": next hop dipertahankan sampai penalti turun di bawah
+// DV_FLAP_REUSE. Next hop yang putus (biaya INF) atau yang tidak terdengar
+// lebih dari DV_HOLD_FRESH_MS selalu langsung diganti: menahan jalur basi
+// lebih merugikan daripada satu kali flap.
+// Tujuan yang tertahan dievaluasi lagi pada perubahan berikutnya atau sweep
+// penuh (dvMarkAll).
+#ifndef DV_SWITCH_MIN_DELTA
+#define DV_SWITCH_MIN_DELTA  10
+#endif
+#ifndef DV_SWITCH_PCT
+#define DV_SWITCH_PCT        10
+#endif
+#ifndef DV_HOLDDOWN_MS
+#define DV_HOLDDOWN_MS       3000
+#endif
+#ifndef DV_FLAP_PENALTY
+#define DV_FLAP_PENALTY      1000
+#endif
+#ifndef DV_FLAP_SUPPRESS
+#define DV_FLAP_SUPPRESS     6000
+#endif
+#ifndef DV_FLAP_REUSE
+#define DV_FLAP_REUSE        2000
+#endif
+#ifndef DV_FLAP_HALFLIFE_MS
+#define DV_FLAP_HALFLIFE_MS  60000
+#endif
+#ifndef DV_HOLD_FRESH_MS
+#define DV_HOLD_FRESH_MS     12000
+#endif
+
+static_assert(DV_FLAP_REUSE < DV_FLAP_SUPPRESS, "ambang reuse harus di bawah suppress");
+
+// FD tujuan yang tidak lagi punya rute dilupakan setelah ini (ms); harus lebih
+// lama dari waktu iklan basi hilang dari jaringan (timeout tetangga)
+#ifndef DV_FD_HOLD_MS
+#define DV_FD_HOLD_MS        120000
+#endif
+
+// ---- Estimasi kualitas link ----
+// bobot sampel baru EWMA RSSI/SNR = 1 / 2^LQ_EWMA_SHIFT
+#ifndef LQ_EWMA_SHIFT
+#define LQ_EWMA_SHIFT        3
+#endif
+// EWMA rasio Hello lebih lambat (~32 Hello): satu tabrakan tidak menggeser ETX
+#ifndef LQ_HELLO_EWMA_SHIFT
+#define LQ_HELLO_EWMA_SHIFT  5
+#endif
+// tiap dB SNR di bawah LQ_SNR_GOOD_DB menambah biaya LQ_SNR_PENALTY
+#ifndef LQ_SNR_GOOD_DB
+#define LQ_SNR_GOOD_DB       0
+#endif
+#ifndef LQ_SNR_PENALTY
+#define LQ_SNR_PENALTY       3
+#endif
+// EWMA rasio ACK (~8 percobaan): data jarang, kegagalan harus cepat terasa
+#ifndef LQ_ACK_EWMA_SHIFT
+#define LQ_ACK_EWMA_SHIFT    3
+#endif
+// rasio Hello awal tetangga baru (%): link baru belum terbukti
+#ifndef LQ_INIT_DELIVERY_PCT
+#define LQ_INIT_DELIVERY_PCT 75
+#endif
+// batas atas ETX (x100)
+#ifndef LQ_ETX_MAX_X100
+#define LQ_ETX_MAX_X100      1000
+#endif
+// lompatan nomor Hello lebih dari ini = tetangga reboot (tidak dihitung hilang)
+#ifndef LQ_HELLO_GAP_MAX
+#define LQ_HELLO_GAP_MAX     16
+#endif
+// Interval Hello tetangga tidak tetap (Trickle, trickle.h); tetangga
+// mengumumkannya di Hello (dvHelloInterval), paling lama LQ_HELLO_IVL_MAX_MS.
+// Tetangga baru dianggap hilang setelah diam max(timeout, LQ_TIMEOUT_HELLOS x
+// interval itu), dan next hop baru dianggap basi setelah diam lebih dari
+// satu jarak Hello terpanjang.
+#ifndef LQ_TIMEOUT_HELLOS
+#define LQ_TIMEOUT_HELLOS    4
+#endif
+#ifndef LQ_HELLO_IVL_MAX_MS
+#define LQ_HELLO_IVL_MAX_MS  40000
+#endif
+
+// Frame dari tetangga terdengar dengan RSSI / SNR ini (snrX4 boleh
+// LINK_SNR_UNKNOWN). Hanya frame broadcast (DR 0) yang dipakai, jadi SNR
+// selalu terukur di BW dasar. false jika tabel tetangga penuh dan link ini tidak
+// lebih baik dari yang terburuk.
+bool dvLinkUpdate(int nbrId, int rssi, int snrX4, uint32_t now);
+
+// Nomor urut Hello tetangga: Hello yang terlewat menurunkan rasio
+// pengiriman (ETX naik)
+void dvHelloSeq(int nbrId, uint16_t seq);
+
+// Hasil satu percobaan kirim frame data ke tetangga (ARQ): acked = ACK
+// datang sebelum RTO. Kegagalan menaikkan ETX link (arah kirim)
+void dvLinkTxResult(int nbrId, bool acked);
+
+// Interval Hello tetangga saat ini (token WIRE_HELLO_IVL), 0 = interval dasar
+void dvHelloInterval(int nbrId, uint32_t ivlMs);
+
+// Data rate (ADR, lora_airtime.h) yang diminta tetangga untuk frame unicast
+// kita kepadanya (token Hello WIRE_HELLO_DR; 0 = DR dasar). DR yang kita
+// minta darinya dipilih sendiri dari EWMA SNR link (DvLinkInfo::rxDr).
+void    dvNeighborTxDr(int nbrId, uint8_t dr);
+// DR untuk frame unicast ke nbrId (0 bila bukan tetangga)
+uint8_t dvTxDr(int nbrId);
+
+// Nomor urut tujuan milik tetangga itu sendiri (token Hello WIRE_HELLO_DSEQ);
+// -1 = Hello tanpa token (firmware lama). Rute langsung ke tetangga baru
+// langsung dipakai, tetapi baru diiklankan setelah salah satunya terdengar.
+void dvDestSeq(int nbrId, int seq);
+
+struct DvLinkInfo {
+    int      id;
+    int      rssi;          // EWMA, dBm
+    int      snrX4;         // EWMA, 0.25 dB (LINK_SNR_UNKNOWN jika belum ada)
+    int      deliveryPct;   // rasio Hello yang sampai
+    int      ackPct;        // rasio percobaan ARQ yang di-ACK (100 = belum ada kegagalan)
+    int      etxX100;
+    int      cost;          // biaya link yang dipakai routing
+    uint32_t lastHeard;     // ms
+    uint8_t  rxDr;          // DR yang kita minta dari tetangga (dari SNR)
+    uint8_t  txDr;          // DR yang diminta tetangga dari kita
+};
+// isi out dengan tetangga aktif; kembalikan jumlahnya
+int  dvNeighbors(DvLinkInfo* out, int max);
+
+// Iklan dari tetangga: Begin, Entry berulang, End.
+//  - iklan penuh: Begin(full=true) ... End(last=true); tujuan yang sebelumnya
+//    diiklankan tetapi tidak muncul lagi dianggap hilang. Iklan penuh boleh
+//    dipecah beberapa frame (Begin(false)/End(false) untuk frame tengah).
+//  - delta: Begin(false) ... End(false); hanya entri yang dikirim berubah.
+void dvAdvertBegin(int nbrId, bool full);
+// seq = nomor urut tujuan dari iklan, -1 jika pengirim tidak membawanya
+// (teks / v1: dianggap sama dengan FD, hanya biaya yang dibandingkan)
+void dvAdvertEntry(int nbrId, int destId, int cost, int nextHopId, int seq = -1);
+void dvAdvertEnd(int nbrId, bool last);
+
+// Nomor urut iklan v2 per tetangga (lihat routing_wire.h)
+enum class DvSeq { Apply, Duplicate, Gap };
+
+// Apakah frame (seq, base) bisa diterapkan di atas state kita? first = frame
+// pertama iklan penuh (selalu bisa). Gap -> perlu resync.
+DvSeq dvAdvertCheck(int nbrId, uint16_t seq, uint16_t base, bool first);
+void  dvAdvertSetSeq(int nbrId, uint16_t seq);
+// false jika belum pernah sinkron dengan tetangga ini
+bool  dvAdvertGetSeq(int nbrId, uint16_t& seq);
+
+// hapus tetangga yang diam lebih dari timeoutMs (diperpanjang untuk
+// tetangga yang Hello-nya jarang, LQ_TIMEOUT_HELLOS)
+void dvExpire(uint32_t now, uint32_t timeoutMs);
+// timeout efektif tetangga nbrId untuk timeoutMs dasar
+uint32_t dvNeighborTimeoutMs(int nbrId, uint32_t timeoutMs);
+
+// tandai semua tujuan (sweep penuh)
+void dvMarkAll();
+
+// hitung ulang tujuan dirty; kembalikan jumlah rute yang berubah signifikan
+// (baru/hilang, atau biaya bergeser >= DV_TRIGGER_COST_DELTA)
+int  dvRecompute(uint32_t now);
+
+// penalti flap tujuan destId saat ini (0 = stabil), dan apakah sedang diredam
+int  dvFlapPenalty(int destId, uint32_t now, bool* suppressed = nullptr);
+
+// nomor urut FD tujuan (dibawa iklan penarikan rute), -1 jika belum ada
+int  dvFeasibleSeq(int destId);
+
+int  dvNeighborCount();
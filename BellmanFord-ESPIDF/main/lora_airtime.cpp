@@ -0,0 +1,144 @@
+#include "lora_airtime.h"
+#include "board.h"
+
+// ===============================
+//  Konfigurasi modem
+// ===============================
+LoraModemConfig loraModemConfigDefault() {
+    LoraModemConfig cfg{};
+    cfg.sf              = (uint8_t)LORA_SF;
+    cfg.bw_hz           = (uint32_t)LORA_BW;
+    cfg.cr              = (uint8_t)(LORA_CODING_RATE - 4);
+    cfg.preamble        = (uint16_t)LORA_PREAMBLE_LEN;
+    cfg.implicit_header = false;
+    cfg.crc_on          = LORA_CRC_ON != 0;
+    return loraModemNormalize(cfg);
+}
+
+LoraModemConfig loraModemNormalize(LoraModemConfig cfg) {
+    // BW: hanya 125k / 250k / 500k yang dipetakan set_modem()
+    if (cfg.bw_hz >= 500000)      cfg.bw_hz = 500000;
+    else if (cfg.bw_hz >= 250000) cfg.bw_hz = 250000;
+    else                          cfg.bw_hz = 125000;
+
+    if (cfg.sf < 6)  cfg.sf = 6;
+    if (cfg.sf > 12) cfg.sf = 12;
+    if (cfg.cr < 1)  cfg.cr = 1;
+    if (cfg.cr > 4)  cfg.cr = 4;
+    if (cfg.preamble < 6) cfg.preamble = 6;
+
+    cfg.ldro = loraSymbolTimeUs(cfg) > 16000;
+    return cfg;
+}
+
+uint32_t loraSymbolTimeUs(const LoraModemConfig& cfg) {
+    return (uint32_t)(((uint64_t)1000000u << cfg.sf) / cfg.bw_hz);
+}
+
+// ===============================
+//  Time-on-air
+// ===============================
+// Dihitung dalam satuan 1/4 simbol supaya preamble +4.25 simbol tetap
+// eksak tanpa floating point.
+uint32_t loraTimeOnAirUs(const LoraModemConfig& cfg, size_t payloadLen) {
+    const int sf = cfg.sf;
+    const int de = cfg.ldro ? 1 : 0;
+    const int ih = cfg.implicit_header ? 1 : 0;
+    const int crc = cfg.crc_on ? 1 : 0;
+
+    int32_t num = 8 * (int32_t)payloadLen - 4 * sf + 28 + 16 * crc - 20 * ih;
+    int32_t den = 4 * (sf - 2 * de);
+    int32_t blocks = num > 0 ? (num + den - 1) / den : 0;
+    uint64_t nsym4 = 4u * ((uint64_t)cfg.preamble + 8u + (uint64_t)blocks * (cfg.cr + 4)) + 17u;
+
+    // (nsym4 / 4) * 2^SF / BW, dibulatkan
+    uint64_t num_us = (nsym4 * 1000000u) << sf;
+    uint64_t den_us = 4u * (uint64_t)cfg.bw_hz;
+    return (uint32_t)((num_us + den_us / 2) / den_us);
+}
+
+size_t loraMaxPayloadForAirtime(const LoraModemConfig& cfg, uint32_t maxUs) {
+    if (loraTimeOnAirUs(cfg, 0) > maxUs) return 0;
+    size_t lo = 0, hi = 255;
+    while (lo < hi) {                       // ToA naik monoton terhadap panjang
+        size_t mid = (lo + hi + 1) / 2;
+        if (loraTimeOnAirUs(cfg, mid) <= maxUs) lo = mid;
+        else hi = mid - 1;
+    }
+    return lo;
+}
+
+// ===============================
+//  Data rate adaptif (ADR)
+// ===============================
+// anak tangga berikutnya dari cfg; false bila sudah SF7/LORA_ADR_MAX_BW
+static bool drStep(LoraModemConfig& cfg) {
+    if (cfg.sf > 7)              cfg.sf--;
+    else if (cfg.bw_hz < 500000 && cfg.bw_hz * 2 <= (uint32_t)LORA_ADR_MAX_BW) cfg.bw_hz *= 2;
+    else                         return false;
+    return true;
+}
+
+struct DrLadder {
+    LoraModemConfig cfg[LORA_DR_MAX];
+    uint8_t         count;
+};
+
+static DrLadder buildLadder() {
+    DrLadder l{};
+    l.cfg[l.count++] = loraModemConfigDefault();
+    LoraModemConfig cfg = l.cfg[0];
+    while (l.count < LORA_DR_MAX && l.count <= LORA_ADR_STEPS && drStep(cfg))
+        l.cfg[l.count++] = loraModemNormalize(cfg);
+    return l;
+}
+
+// tangga tanpa perpanjangan preamble (dihitung sekali, aman lintas task)
+static const DrLadder& drLadder() {
+    static const DrLadder l = buildLadder();
+    return l;
+}
+
+uint8_t loraDrCount() {
+    return drLadder().count;
+}
+
+// CAD = ~2 simbol (datasheet: 1 simbol + pemrosesan)
+uint32_t loraCadTimeUs(const LoraModemConfig& cfg) {
+    return 2 * loraSymbolTimeUs(cfg);
+}
+
+uint32_t loraScanCycleUs() {
+    const DrLadder& l = drLadder();
+    if (l.count <= 1) return 0;
+    uint32_t us = 0;
+    for (uint8_t i = 0; i < l.count; i++) us += loraCadTimeUs(l.cfg[i]) + LORA_CAD_SWITCH_US;
+    return us;
+}
+
+LoraModemConfig loraModemConfigForDr(uint8_t dr) {
+    const DrLadder& l = drLadder();
+    LoraModemConfig cfg = l.cfg[dr < l.count ? dr : l.count - 1];
+    uint32_t tsym = loraSymbolTimeUs(cfg);
+    cfg.preamble = (uint16_t)(cfg.preamble + (loraScanCycleUs() + tsym - 1) / tsym);
+    return cfg;
+}
+
+// SX1276: -7.5 dB di SF7, turun 2.5 dB per SF
+int loraSnrFloorX4(const LoraModemConfig& cfg) {
+    return -20 - 10 * (cfg.sf - 6);
+}
+
+uint8_t loraDrForSnr(int snrX4, uint8_t cur) {
+    const DrLadder& l = drLadder();
+    uint8_t dr = 0;
+    for (uint8_t i = 1; i < l.count; i++) {
+        // SNR terukur di BW dasar; tiap BW dua kali lipat = noise +3 dB
+        int need = loraSnrFloorX4(l.cfg[i]) + 4 * LORA_ADR_MARGIN_DB;
+        for (uint32_t bw = l.cfg[0].bw_hz; bw < l.cfg[i].bw_hz; bw *= 2) need += 12;
+        if (i > cur) need += 4 * LORA_ADR_HYST_DB;
+        if (snrX4 < need) break;
+        dr = i;
+    }
+    return dr;
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// ====== Konfigurasi modem LoRa + time-on-air SX1276 ======
+//
+// Satu struct konfigurasi dipakai bersama oleh set_modem() (register
+// MODEM_CONFIG1..3 dan preamble), kalkulator time-on-air, scheduler airtime
+// dan simulator host, jadi durasi frame yang dihitung selalu sama dengan
+// yang benar-benar dipasang ke radio.
+//
+// Time-on-air (datasheet SX1276 §4.1.1.7):
+//   Tsym      = 2^SF / BW
+//   Tpreamble = (n_preamble + 4.25) * Tsym
+//   n_payload = 8 + max(ceil((8PL - 4SF + 28 + 16CRC - 20IH) / (4(SF - 2DE))) * (CR + 4), 0)
+//   ToA       = Tpreamble + n_payload * Tsym
+// DE (LowDataRateOptimize) wajib bila Tsym > 16 ms.
+
+// coding rate 4/5..4/8 -> 5..8
+#ifndef LORA_CODING_RATE
+#define LORA_CODING_RATE  5
+#endif
+
+#ifndef LORA_PREAMBLE_LEN
+#define LORA_PREAMBLE_LEN 8
+#endif
+
+// CRC payload (0 = off, seperti set_modem() lama)
+#ifndef LORA_CRC_ON
+#define LORA_CRC_ON       0
+#endif
+
+struct LoraModemConfig {
+    uint8_t  sf;              // 6..12
+    uint32_t bw_hz;           // 125000 / 250000 / 500000
+    uint8_t  cr;              // 1..4 (= 4/5..4/8)
+    uint16_t preamble;        // simbol preamble terprogram
+    bool     implicit_header;
+    bool     crc_on;
+    bool     ldro;            // LowDataRateOptimize
+};
+
+// konfigurasi dari board.h (LORA_SF, LORA_BW, LORA_CODING_RATE, ...)
+LoraModemConfig loraModemConfigDefault();
+
+// jepit ke nilai yang didukung set_modem() dan hitung LDRO dari Tsym
+LoraModemConfig loraModemNormalize(LoraModemConfig cfg);
+
+uint32_t loraSymbolTimeUs(const LoraModemConfig& cfg);
+
+// durasi frame dengan payload payloadLen byte di udara (us)
+uint32_t loraTimeOnAirUs(const LoraModemConfig& cfg, size_t payloadLen);
+
+// payload terbesar (<= 255) yang time-on-air-nya <= maxUs; 0 jika tidak ada
+size_t   loraMaxPayloadForAirtime(const LoraModemConfig& cfg, uint32_t maxUs);
+
+// ====== Data rate adaptif per link (ADR) ======
+//
+// DR 0 = konfigurasi dasar dari board.h, dipakai semua frame broadcast
+// (Hello, iklan routing) supaya tiap tetangga bisa mendengarnya. DR 1.. =
+// anak tangga yang makin cepat: SF turun satu per langkah sampai SF7, lalu
+// BW berlipat dua sampai LORA_ADR_MAX_BW. Frame unicast dikirim pada DR tercepat yang
+// masih andal untuk link itu; penerima memilihnya dari SNR frame DR 0 milik
+// tetangga (loraDrForSnr) dan mengumumkannya di Hello (WIRE_HELLO_DR).
+//
+// RX continuous SX1276 hanya mendengar satu SF/BW, jadi dengan lebih dari
+// satu DR radio memindai tangga DR dengan CAD bergiliran (lora_sx1276.cpp).
+// Preamble tiap DR diperpanjang sepanjang satu putaran pindai
+// (loraScanCycleUs) supaya frame yang mulai di tengah putaran tetap
+// terdeteksi; ongkos itu dibayar juga oleh DR 0.
+//
+// LORA_ADR_STEPS = 0 mematikan ADR: satu DR, RX continuous seperti semula.
+// Dengan SF7 dan BW dasar sebagai batas, tangga hanya berisi DR 0 (tidak ada
+// yang lebih cepat), jadi ADR otomatis mati tanpa ongkos preamble.
+#ifndef LORA_ADR_STEPS
+#define LORA_ADR_STEPS     3
+#endif
+// BW terlebar tangga DR (Hz). Default = BW dasar: BW lebih lebar hanya 2x
+// lebih cepat tetapi noise +3 dB, dan tidak semua regulasi kanal mengizinkannya
+#ifndef LORA_ADR_MAX_BW
+#define LORA_ADR_MAX_BW    LORA_BW
+#endif
+// cadangan SNR (dB) di atas batas demodulasi DR tujuan
+#ifndef LORA_ADR_MARGIN_DB
+#define LORA_ADR_MARGIN_DB 10
+#endif
+// DR hanya dinaikkan bila SNR melewati ambang + histeresis ini (dB)
+#ifndef LORA_ADR_HYST_DB
+#define LORA_ADR_HYST_DB   3
+#endif
+// jeda pindah DR + mode CAD per langkah pindai (SPI + PLL), us
+#ifndef LORA_CAD_SWITCH_US
+#define LORA_CAD_SWITCH_US 300
+#endif
+
+static constexpr uint8_t LORA_DR_MAX = 8;
+
+// jumlah DR yang dipakai (1 = ADR mati / tidak ada anak tangga lebih cepat)
+uint8_t  loraDrCount();
+
+// konfigurasi modem DR dr (dijepit ke loraDrCount() - 1), termasuk preamble
+// yang diperpanjang untuk pindai CAD. DR 0 = konfigurasi RX/broadcast.
+LoraModemConfig loraModemConfigForDr(uint8_t dr);
+
+// durasi satu CAD di modem cfg (us, tanpa jeda pindah mode)
+uint32_t loraCadTimeUs(const LoraModemConfig& cfg);
+
+// satu putaran pindai CAD seluruh tangga DR (us), 0 bila hanya satu DR
+uint32_t loraScanCycleUs();
+
+// SNR minimum demodulasi (0.25 dB, relatif ke noise di BW cfg)
+int      loraSnrFloorX4(const LoraModemConfig& cfg);
+
+// DR tercepat untuk link dengan SNR snrX4 (diukur pada DR 0) dengan cadangan
+// LORA_ADR_MARGIN_DB; cur = DR sekarang (naik butuh histeresis)
+uint8_t  loraDrForSnr(int snrX4, uint8_t cur);
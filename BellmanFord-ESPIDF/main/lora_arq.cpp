@@ -0,0 +1,185 @@
+#include "lora_arq.h"
+#include "routing_table.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+
+using Table = RoutingTable<ROUTING_MAX_NODES>;
+
+// ===============================
+//  RTT per tetangga (ms, tanpa airtime frame)
+// ===============================
+static uint16_t s_srtt[ROUTING_MAX_NODES];
+static uint16_t s_rttvar[ROUTING_MAX_NODES];
+static std::bitset<ROUTING_MAX_NODES> s_rttValid;
+
+static void rttSample(int nbrId, uint32_t rtt) {
+    rtt = std::min<uint32_t>(rtt, 0xFFFF);
+    if (!s_rttValid.test(nbrId)) {
+        s_srtt[nbrId]   = (uint16_t)rtt;
+        s_rttvar[nbrId] = (uint16_t)(rtt / 2);
+        s_rttValid.set(nbrId);
+        return;
+    }
+    // RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|, SRTT = 7/8 SRTT + 1/8 R
+    int32_t err = (int32_t)rtt - s_srtt[nbrId];
+    s_rttvar[nbrId] = (uint16_t)(s_rttvar[nbrId] + ((err < 0 ? -err : err) - s_rttvar[nbrId]) / 4);
+    s_srtt[nbrId]   = (uint16_t)(s_srtt[nbrId] + err / 8);
+}
+
+uint32_t arqRtoMs(int nbrId, uint32_t airMs) {
+    uint32_t srtt = ARQ_RTT_INIT_MS, rttvar = ARQ_RTT_INIT_MS / 2;
+    if (Table::inRange(nbrId) && s_rttValid.test(nbrId)) {
+        srtt   = s_srtt[nbrId];
+        rttvar = s_rttvar[nbrId];
+    }
+    uint32_t rto = airMs + srtt + 4 * rttvar;
+    return std::min<uint32_t>(std::max<uint32_t>(rto, ARQ_RTO_MIN_MS), ARQ_RTO_MAX_MS);
+}
+
+// ===============================
+//  Jendela in-flight
+// ===============================
+struct ArqSlot {
+    bool     used = false;
+    int16_t  nbrId = -1;
+    int16_t  src = -1;
+    uint16_t seq = 0;
+    uint8_t  tries = 0;
+    bool     onAir = false;  // percobaan terakhir benar-benar diantrekan
+    uint8_t  defers = 0;     // kiriman ulang yang ditunda (arqDefer)
+    uint32_t airMs = 0;
+    uint32_t sentMs = 0;     // kiriman pertama (sampel RTT)
+    uint32_t dueMs = 0;      // RTO berikutnya
+    uint16_t len = 0;
+    uint8_t  buf[FRAG_MAX_DATAGRAM];
+};
+
+static ArqSlot s_slots[ARQ_WINDOW];
+
+bool arqTrack(int nbrId, int src, uint16_t seq, const uint8_t* frame, size_t len,
+              uint32_t airMs, uint32_t now) {
+    if (!Table::inRange(nbrId) || len < WIRE_DATA_HDR_LEN || len > FRAG_MAX_DATAGRAM) return false;
+    for (ArqSlot& s : s_slots) {
+        if (s.used) continue;
+        s.used   = true;
+        s.nbrId  = (int16_t)nbrId;
+        s.src    = (int16_t)src;
+        s.seq    = seq;
+        s.tries  = 0;
+        s.onAir  = true;
+        s.defers = 0;
+        s.airMs  = airMs;
+        s.sentMs = now;
+        s.dueMs  = now + arqRtoMs(nbrId, airMs);
+        s.len    = (uint16_t)len;
+        memcpy(s.buf, frame, len);
+        return true;
+    }
+    return false;
+}
+
+static void release(ArqSlot& s, uint32_t now) {
+    if (s.tries == 0) {
+        uint32_t rtt = now - s.sentMs;
+        rttSample(s.nbrId, rtt > s.airMs ? rtt - s.airMs : 0);
+    }
+    s.used = false;
+}
+
+bool arqAck(int nbrId, int src, uint16_t seq, uint32_t now) {
+    for (ArqSlot& s : s_slots) {
+        if (!s.used || s.nbrId != nbrId || s.src != src || s.seq != seq) continue;
+        release(s, now);
+        return true;
+    }
+    return false;
+}
+
+int arqAckForwarded(int src, uint16_t seq, uint8_t ttl, int nextHop, uint32_t now) {
+    for (ArqSlot& s : s_slots) {
+        if (!s.used || s.src != src || s.seq != seq || s.nbrId == nextHop) continue;
+        if (ttl >= s.buf[WIRE_DATA_OFF_TTL]) continue;
+        int nbrId = s.nbrId;
+        release(s, now);
+        return nbrId;
+    }
+    return -1;
+}
+
+ArqEvent arqPoll(uint32_t now, ArqFrame& out) {
+    for (ArqSlot& s : s_slots) {
+        if (!s.used || (int32_t)(now - s.dueMs) < 0) continue;
+        out.nbrId = s.nbrId;
+        out.src   = s.src;
+        out.seq   = s.seq;
+        out.tries = s.tries;
+        out.data  = s.buf;
+        out.len   = s.len;
+        out.lost  = s.onAir;
+        if (s.tries >= ARQ_MAX_RETRIES) {
+            s.used = false;
+            return ArqEvent::Failed;
+        }
+        // backoff eksponensial RTO (tanpa sampel RTT dari kiriman ulang)
+        s.tries++;
+        s.onAir   = true;
+        out.tries = s.tries;
+        uint32_t rto = arqRtoMs(s.nbrId, s.airMs);
+        s.dueMs = now + std::min<uint32_t>(rto << s.tries, ARQ_RTO_MAX_MS);
+        return ArqEvent::Retransmit;
+    }
+    return ArqEvent::None;
+}
+
+bool arqDefer(int nbrId, int src, uint16_t seq, uint32_t waitMs, uint32_t now) {
+    for (ArqSlot& s : s_slots) {
+        if (!s.used || s.nbrId != nbrId || s.src != src || s.seq != seq) continue;
+        if (++s.defers > ARQ_MAX_DEFERS) {
+            s.used = false;
+            return false;
+        }
+        if (s.tries > 0) s.tries--;
+        s.onAir = false;
+        s.dueMs = now + std::max<uint32_t>(waitMs, arqRtoMs(s.nbrId, s.airMs));
+        return true;
+    }
+    return false;
+}
+
+uint32_t arqWaitMs(uint32_t now) {
+    uint32_t wait = UINT32_MAX;
+    for (const ArqSlot& s : s_slots) {
+        if (!s.used) continue;
+        int32_t w = (int32_t)(s.dueMs - now);
+        wait = std::min<uint32_t>(wait, w > 0 ? (uint32_t)w : 0);
+    }
+    return wait;
+}
+
+int arqInFlight() {
+    int n = 0;
+    for (const ArqSlot& s : s_slots) n += s.used;
+    return n;
+}
+
+// ===============================
+//  Duplikat di penerima
+// ===============================
+struct DupEntry {
+    int16_t  src = -1;
+    uint16_t seq = 0;
+};
+
+static DupEntry s_dup[ARQ_DUP_CACHE];
+static size_t   s_dupNext = 0;
+
+bool arqDuplicate(int src, uint16_t seq) {
+    for (const DupEntry& d : s_dup) {
+        if (d.src == src && d.seq == seq) return true;
+    }
+    s_dup[s_dupNext] = { (int16_t)src, seq };
+    s_dupNext = (s_dupNext + 1) % ARQ_DUP_CACHE;
+    return false;
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+#include "lora_frag.h"
+
+// ====== ARQ hop-by-hop untuk frame data unicast ======
+//
+// Relay yang meneruskan frame data satu-frame ke hop berikutnya tidak
+// mengirim ACK: pengirim sebelumnya mendengar frame itu diteruskan (ACK
+// implisit, arqAckForwarded). Frame ACK kecil (WIRE_TYPE_ACK, routing_wire.h)
+// hanya dikirim tujuan akhir, relay yang tidak meneruskan frame (dibuang /
+// dipecah fragmen), dan untuk kiriman ulang. Pengirim menyimpan salinan frame di
+// salah satu dari ARQ_WINDOW slot in-flight dan mengirim ulang ke next hop
+// yang sama bila ACK tidak datang dalam RTO; setelah ARQ_MAX_RETRIES kirim
+// ulang frame dilepas. Tidak ada retry end-to-end: tiap hop hanya menjamin
+// link-nya sendiri.
+//
+// RTO per tetangga (gaya RFC 6298): sampel RTT = waktu ACK - waktu kirim -
+// time-on-air frame (antrean + LBT + ACK), hanya dari frame yang tidak
+// dikirim ulang (Karn). RTO = airtime + SRTT + 4 x RTTVAR, dibatasi
+// [ARQ_RTO_MIN_MS, ARQ_RTO_MAX_MS], dan dilipatgandakan tiap kirim ulang.
+//
+// Kirim ulang bisa membuat next hop menerima frame yang sama dua kali;
+// penerima mengenali (src, seq) yang baru saja diproses (arqDuplicate) dan
+// hanya mengulang ACK-nya.
+//
+// Modul ini hanya menyimpan state; mengirim frame / ACK dan umpan balik ke
+// biaya link dilakukan pemanggil (LoRaRouting.cpp).
+
+#ifndef ARQ_ENABLE
+#define ARQ_ENABLE           1
+#endif
+
+// frame yang menunggu ACK sekaligus; frame di luar jendela dikirim tanpa ARQ
+#ifndef ARQ_WINDOW
+#define ARQ_WINDOW           4
+#endif
+
+#ifndef ARQ_MAX_RETRIES
+#define ARQ_MAX_RETRIES      2
+#endif
+
+// tebakan RTT (tanpa airtime frame) sebelum sampel pertama dari tetangga
+#ifndef ARQ_RTT_INIT_MS
+#define ARQ_RTT_INIT_MS      300
+#endif
+#ifndef ARQ_RTO_MIN_MS
+#define ARQ_RTO_MIN_MS       200
+#endif
+#ifndef ARQ_RTO_MAX_MS
+#define ARQ_RTO_MAX_MS       10000
+#endif
+
+// kiriman ulang yang ditolak batas lokal (arqDefer) sebelum frame dilepas
+#ifndef ARQ_MAX_DEFERS
+#define ARQ_MAX_DEFERS       1
+#endif
+
+// (src, seq) frame data terakhir yang diterima, untuk membuang kiriman ulang
+#ifndef ARQ_DUP_CACHE
+#define ARQ_DUP_CACHE        32
+#endif
+
+// Simpan salinan frame yang baru dikirim ke nbrId (src/seq dari header data).
+// airMs = time-on-air frame (semua fragmen). false = jendela penuh.
+bool arqTrack(int nbrId, int src, uint16_t seq, const uint8_t* frame, size_t len,
+              uint32_t airMs, uint32_t now);
+
+// ACK dari nbrId untuk (src, seq). true = cocok dengan frame in-flight
+// (slot dilepas, RTT diperbarui).
+bool arqAck(int nbrId, int src, uint16_t seq, uint32_t now);
+
+// Frame data (src, seq) dengan ttl terdengar dikirim ke nextHop: jika kita
+// menunggu ACK frame itu dari tetangga lain dan ttl-nya lebih kecil dari
+// salinan kita, tetangga itu sudah menerimanya dan meneruskannya (kiriman
+// ulang dari hop sebelum kita membawa ttl lebih besar). Kembalikan tetangga
+// yang di-ACK, atau -1.
+int  arqAckForwarded(int src, uint16_t seq, uint8_t ttl, int nextHop, uint32_t now);
+
+enum class ArqEvent : uint8_t { None, Retransmit, Failed };
+
+struct ArqFrame {
+    int            nbrId;
+    int            src;
+    uint16_t       seq;
+    uint8_t        tries;    // kirim ulang sejauh ini
+    bool           lost;     // RTO lewat setelah kiriman yang benar-benar diantrekan
+    const uint8_t* data;     // Retransmit: valid sampai panggilan arq* berikutnya
+    size_t         len;
+};
+
+// Frame yang RTO-nya lewat. Retransmit = kirim ulang out.data sekarang
+// (RTO berikutnya sudah dijadwalkan); Failed = percobaan habis, slot
+// dilepas. out.lost = false: percobaan sebelumnya ditunda (arqDefer), jadi
+// tidak ada yang hilang di link. Dipanggil dari loop sampai mengembalikan
+// None.
+ArqEvent arqPoll(uint32_t now, ArqFrame& out);
+
+// Kirim ulang dari arqPoll ditolak sebelum sampai ke radio (jatah airtime,
+// dwell time, antrean TX penuh): percobaan dikembalikan dan slot dicoba lagi
+// setelah max(waitMs, RTO) tanpa backoff. false = sudah ARQ_MAX_DEFERS kali
+// ditunda, slot dilepas (bukan kegagalan link).
+bool arqDefer(int nbrId, int src, uint16_t seq, uint32_t waitMs, uint32_t now);
+
+// ms sampai RTO terdekat (UINT32_MAX = tidak ada frame in-flight)
+uint32_t arqWaitMs(uint32_t now);
+
+// true jika (src, seq) sudah diterima baru-baru ini; jika belum, dicatat
+bool arqDuplicate(int src, uint16_t seq);
+
+int      arqInFlight();
+// RTO tetangga saat ini untuk frame dengan airtime airMs
+uint32_t arqRtoMs(int nbrId, uint32_t airMs);
@@ -0,0 +1,122 @@
+#include "lora_frag.h"
+
+#include <cstring>
+
+// ===============================
+//  Pemecah
+// ===============================
+static inline size_t chunkLen(size_t maxFrame) {
+    return maxFrame > WIRE_FRAG_HDR_LEN ? maxFrame - WIRE_FRAG_HDR_LEN : 0;
+}
+
+size_t fragCount(size_t len, size_t maxFrame) {
+    size_t chunk = chunkLen(maxFrame);
+    if (chunk == 0 || len == 0 || len > FRAG_MAX_DATAGRAM) return 0;
+    size_t n = (len + chunk - 1) / chunk;
+    return n <= WIRE_FRAG_MAX_COUNT ? n : 0;
+}
+
+size_t fragBuild(uint8_t* out, size_t cap, const uint8_t* dgram, size_t len, size_t maxFrame,
+                 int linkSrc, int linkDst, uint16_t id, size_t index) {
+    size_t count = fragCount(len, maxFrame);
+    if (index >= count) return 0;
+    size_t chunk  = chunkLen(maxFrame);
+    size_t offset = index * chunk;
+    size_t n      = (len - offset < chunk) ? len - offset : chunk;
+    if (cap < WIRE_FRAG_HDR_LEN + n) return 0;
+
+    size_t h = wireEncodeFragHeader(out, cap, linkSrc, linkDst, id, (uint8_t)index,
+                                    (uint8_t)count, (uint16_t)offset);
+    if (h == 0) return 0;
+    memcpy(out + h, dgram + offset, n);
+    return h + n;
+}
+
+// ===============================
+//  Perakit
+// ===============================
+struct ReasmSlot {
+    bool     used = false;
+    int      linkSrc = -1;
+    uint16_t id = 0;
+    uint8_t  count = 0;
+    uint64_t have = 0;         // bit per index fragmen
+    size_t   total = 0;        // 0 = fragmen terakhir belum datang
+    uint32_t startMs = 0;
+    uint8_t  buf[FRAG_MAX_DATAGRAM];
+};
+
+static ReasmSlot s_slots[FRAG_REASM_SLOTS];
+static FragStats s_stats{};
+
+static void expire(uint32_t nowMs) {
+    for (ReasmSlot& s : s_slots) {
+        if (s.used && nowMs - s.startMs > FRAG_REASM_TIMEOUT_MS) {
+            s.used = false;
+            s_stats.timedOut++;
+        }
+    }
+}
+
+// slot untuk (linkSrc, id); rakitan baru mengambil slot kosong atau menggusur
+// yang tertua
+static ReasmSlot* slotFor(const WireFragView& f, uint32_t nowMs) {
+    ReasmSlot* freeSlot = nullptr;
+    ReasmSlot* oldest = nullptr;
+    for (ReasmSlot& s : s_slots) {
+        if (!s.used) { if (!freeSlot) freeSlot = &s; continue; }
+        if (s.linkSrc == f.linkSrc && s.id == f.id) {
+            if (s.count == f.count) return &s;
+            s.used = false;                         // id dipakai ulang: mulai lagi
+            if (!freeSlot) freeSlot = &s;
+            continue;
+        }
+        if (!oldest || (int32_t)(s.startMs - oldest->startMs) < 0) oldest = &s;
+    }
+    ReasmSlot* s = freeSlot;
+    if (!s) {
+        s = oldest;
+        s_stats.evicted++;
+    }
+    s->used    = true;
+    s->linkSrc = f.linkSrc;
+    s->id      = f.id;
+    s->count   = f.count;
+    s->have    = 0;
+    s->total   = 0;
+    s->startMs = nowMs;
+    return s;
+}
+
+bool fragInput(const WireFragView& f, uint32_t nowMs, uint8_t** out, size_t* outLen) {
+    expire(nowMs);
+
+    size_t end = (size_t)f.offset + f.len;
+    bool last = (f.index + 1 == f.count);
+    if (end > FRAG_MAX_DATAGRAM) { s_stats.rejected++; return false; }
+
+    ReasmSlot* s = slotFor(f, nowMs);
+    uint64_t bit = 1ull << f.index;
+    if (s->have & bit) return false;                // duplikat
+    if ((last && s->total && end != s->total) || (!last && s->total && end > s->total)) {
+        s_stats.rejected++;
+        return false;
+    }
+
+    memcpy(s->buf + f.offset, f.chunk, f.len);
+    s->have |= bit;
+    if (last) s->total = end;
+
+    uint64_t all = (f.count == 64) ? ~0ull : ((1ull << f.count) - 1);
+    if (s->have != all || s->total == 0) return false;
+
+    s->used = false;                                // buffer tetap utuh sampai dipakai ulang
+    s_stats.completed++;
+    *out = s->buf;
+    *outLen = s->total;
+    return true;
+}
+
+FragStats fragStats() {
+    return s_stats;
+}
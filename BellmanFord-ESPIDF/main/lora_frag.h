@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+#include "routing_wire.h"
+
+// ====== Fragmentasi & perakitan ulang datagram ======
+//
+// Datagram (frame biasa: data, iklan routing teks/biner, ...) yang lebih
+// panjang dari satu frame radio dipecah menjadi frame WIRE_TYPE_FRAG
+// (format di routing_wire.h). Semua fragmen kecuali yang terakhir membawa
+// potongan berukuran sama, jadi offset = index * potongan.
+//
+// Penerima merakit di pool buffer berukuran tetap (FRAG_REASM_SLOTS x
+// FRAG_MAX_DATAGRAM, tanpa heap). Datagram yang belum lengkap setelah
+// FRAG_REASM_TIMEOUT_MS dibuang; bila pool penuh, rakitan tertua digusur.
+
+// datagram terpanjang yang bisa dipecah / dirakit
+#ifndef FRAG_MAX_DATAGRAM
+#define FRAG_MAX_DATAGRAM       1024
+#endif
+
+// rakitan paralel (pengirim / datagram berbeda)
+#ifndef FRAG_REASM_SLOTS
+#define FRAG_REASM_SLOTS        4
+#endif
+
+// umur maksimum rakitan yang belum lengkap (ms)
+#ifndef FRAG_REASM_TIMEOUT_MS
+#define FRAG_REASM_TIMEOUT_MS   10000
+#endif
+
+static_assert(FRAG_MAX_DATAGRAM <= 0xFFFF, "offset fragmen dikirim sebagai u16");
+
+// jumlah fragmen untuk datagram len byte dengan frame maksimum maxFrame
+// (0 = tidak bisa: terlalu panjang / frame terlalu kecil)
+size_t fragCount(size_t len, size_t maxFrame);
+
+// tulis fragmen ke-index ke out; kembalikan panjang frame (0 jika gagal)
+size_t fragBuild(uint8_t* out, size_t cap, const uint8_t* dgram, size_t len, size_t maxFrame,
+                 int linkSrc, int linkDst, uint16_t id, size_t index);
+
+// Masukkan satu fragmen. true = datagram lengkap: *out / *outLen menunjuk
+// buffer rakitan (valid sampai fragInput berikutnya; boleh diubah di tempat
+// untuk relay).
+bool fragInput(const WireFragView& f, uint32_t nowMs, uint8_t** out, size_t* outLen);
+
+struct FragStats {
+    uint32_t completed;   // datagram berhasil dirakit
+    uint32_t timedOut;    // dibuang karena FRAG_REASM_TIMEOUT_MS
+    uint32_t evicted;     // digusur karena pool penuh
+    uint32_t rejected;    // fragmen tidak valid (offset / panjang)
+};
+FragStats fragStats();
@@ -0,0 +1,93 @@
+#include "lora_stats.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char* TAG = "Stats";
+
+std::atomic<uint32_t> g_stats[STAT_COUNT];
+
+static const char* const kNames[] = {
+    "rx_frames", "rx_bytes", "rx_airtime_us", "rx_crc_error", "rx_overrun",
+    "rx_oversize", "rx_non_ascii", "rx_malformed", "rx_unknown_type", "rx_unknown_node",
+    "tx_frames", "tx_bytes", "tx_airtime_data_us", "tx_airtime_routing_us", "tx_airtime_hello_us",
+    "tx_queue_full", "tx_timeout", "tx_dwell_drop", "tx_budget_drop",
+    "data_sent", "data_delivered", "data_relayed", "data_drop_no_route", "data_drop_ttl",
+    "data_drop_loop", "frag_reassembled",
+    "route_changes", "nbr_table_full", "nbr_evicted", "nbr_timeout", "resync_asks",
+    "bf_runs", "bf_time_us", "bf_max_us", "next_hop_changes",
+    "route_switch_held", "route_dampened", "route_poisoned", "dest_seq_bumps",
+    "advert_suppressed", "tx_fast_dr", "tx_airtime_saved_us",
+    "tx_lbt_busy", "tx_lbt_drop",
+    "data_acked", "data_retx", "data_link_fail", "data_dup_rx", "arq_window_full", "ack_sent",
+    "tx_queue_evicted", "tx_aged_first", "app_msg_drop",
+};
+static_assert(sizeof(kNames) / sizeof(kNames[0]) == STAT_COUNT, "nama counter tidak lengkap");
+
+void statMax(Stat s, uint32_t v) {
+    std::atomic<uint32_t>& c = g_stats[(int)s];
+    uint32_t cur = c.load(std::memory_order_relaxed);
+    while (v > cur && !c.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {}
+}
+
+const char* statName(Stat s) {
+    return (int)s < STAT_COUNT ? kNames[(int)s] : "?";
+}
+
+void statsReset() {
+    for (std::atomic<uint32_t>& c : g_stats) c.store(0, std::memory_order_relaxed);
+}
+
+static inline void putU32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint32_t getU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+size_t statsSnapshot(uint8_t* out, size_t cap, int nodeId) {
+    if (!out || cap < STATS_SNAPSHOT_LEN) return 0;
+    out[0] = STATS_MAGIC0;
+    out[1] = STATS_MAGIC1;
+    out[2] = STATS_VERSION;
+    out[3] = (uint8_t)STAT_COUNT;
+    out[4] = (uint8_t)nodeId;
+    putU32(out + 5, (uint32_t)(esp_timer_get_time() / 1000000LL));
+    for (int i = 0; i < STAT_COUNT; i++) {
+        putU32(out + STATS_HDR_LEN + 4 * i, g_stats[i].load(std::memory_order_relaxed));
+    }
+    return STATS_SNAPSHOT_LEN;
+}
+
+bool statsDecode(const uint8_t* in, size_t len, StatsReport& out) {
+    if (!in || len < STATS_HDR_LEN) return false;
+    if (in[0] != STATS_MAGIC0 || in[1] != STATS_MAGIC1 || in[2] != STATS_VERSION) return false;
+    size_t count = in[3];
+    if (len != STATS_HDR_LEN + 4 * count) return false;
+
+    memset(&out, 0, sizeof(out));
+    out.node    = in[4];
+    out.uptimeS = getU32(in + 5);
+    for (size_t i = 0; i < count && i < (size_t)STAT_COUNT; i++) {
+        out.v[i] = getU32(in + STATS_HDR_LEN + 4 * i);
+    }
+    return true;
+}
+
+void statsLog(const StatsReport& r) {
+    uint32_t bf = r.get(Stat::BfRuns);
+    ESP_LOGI(TAG, "NODE_%d up %us: rx %u fr (crc %u, overrun %u), tx %u fr, air ms data/routing/hello %u/%u/%u, "
+                  "route changes %u, BF avg %u us max %u us",
+             r.node, (unsigned)r.uptimeS, (unsigned)r.get(Stat::RxFrames), (unsigned)r.get(Stat::RxCrcError),
+             (unsigned)r.get(Stat::RxOverrun), (unsigned)r.get(Stat::TxFrames),
+             (unsigned)(r.get(Stat::TxAirtimeDataUs) / 1000), (unsigned)(r.get(Stat::TxAirtimeRoutingUs) / 1000),
+             (unsigned)(r.get(Stat::TxAirtimeHelloUs) / 1000), (unsigned)r.get(Stat::RouteChanges),
+             (unsigned)(bf ? r.get(Stat::BfTimeUs) / bf : 0), (unsigned)r.get(Stat::BfMaxUs));
+    for (int i = 0; i < STAT_COUNT; i++) {
+        if (r.v[i]) ESP_LOGD(TAG, "  %-22s %u", kNames[i], (unsigned)r.v[i]);
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// ====== Statistik runtime radio & routing ======
+//
+// Satu blok counter u32 (std::atomic, relaxed): dinaikkan dari task radio
+// maupun task routing tanpa lock. Counter boleh wrap; kolektor menghitung
+// selisih antar snapshot (modulo 2^32). Snapshot biner ringkas dibaca
+// lewat statsSnapshot() atau dikirim berkala ke node kolektor lewat data
+// plane (setStatsReport(), LoRaRouting.h).
+
+// node kolektor laporan (-1 = laporan OTA mati)
+#ifndef STATS_COLLECTOR_ID
+#define STATS_COLLECTOR_ID   -1
+#endif
+
+// interval laporan ke kolektor (ms)
+#ifndef STATS_REPORT_MS
+#define STATS_REPORT_MS      300000
+#endif
+
+// urutan = posisi di snapshot: counter baru HANYA ditambahkan di akhir
+enum class Stat : uint8_t {
+    // RX (frame yang sampai ke onDataRecv)
+    RxFrames = 0,
+    RxBytes,
+    RxAirtimeUs,
+    RxCrcError,          // driver: CRC payload salah
+    RxOverrun,           // driver: antrean RX penuh
+    RxOversize,
+    RxNonAscii,
+    RxMalformed,         // frame biner gagal didekode
+    RxUnknownType,
+    RxUnknownNode,       // Hello dari node di luar registry / range
+    // TX (frame yang diserahkan ke driver)
+    TxFrames,
+    TxBytes,
+    TxAirtimeDataUs,
+    TxAirtimeRoutingUs,
+    TxAirtimeHelloUs,
+    TxQueueFull,
+    TxTimeout,           // driver: TxDone tidak datang
+    TxDwellDrop,
+    TxBudgetDrop,        // jatah airtime kelas habis
+    // data plane
+    DataSent,
+    DataDelivered,
+    DataRelayed,
+    DataDropNoRoute,
+    DataDropTtl,
+    DataDropLoop,
+    FragReassembled,
+    // routing
+    RouteChanges,
+    NbrTableFull,        // tetangga baru ditolak (tabel penuh)
+    NbrEvicted,
+    NbrTimeout,
+    ResyncAsks,
+    BfRuns,
+    BfTimeUs,
+    BfMaxUs,
+    NextHopChanges,      // rute yang berganti next hop (flapping)
+    RouteSwitchHeld,     // pergantian ditahan hysteresis / hold-down / damping
+    RouteDampened,       // rute masuk status diredam (flap penalty)
+    RoutePoisoned,       // rute layak putus, ditarik dengan nomor urut baru
+    DestSeqBumps,        // nomor urut node ini dinaikkan (rute ke kita diracuni)
+    AdvertSuppressed,    // iklan periodik ditekan Trickle (tetangga sudah konsisten)
+    TxFastDr,            // frame unicast dikirim di atas DR dasar (ADR)
+    TxAirtimeSavedUs,    // selisih time-on-air frame itu terhadap DR dasar
+    TxLbtBusy,           // driver: CAD sebelum TX menemukan kanal sibuk (backoff)
+    TxLbtDrop,           // driver: frame dibuang, kanal sibuk LORA_LBT_MAX_TRIES kali
+    DataAcked,           // frame data di-ACK next hop (ARQ)
+    DataRetx,            // kirim ulang karena RTO lewat
+    DataLinkFail,        // percobaan ARQ habis, frame dilepas
+    DataDupRx,           // kiriman ulang yang sudah diterima (hanya di-ACK ulang)
+    ArqWindowFull,       // jendela in-flight penuh: frame dikirim tanpa ARQ
+    AckSent,
+    TxQueueEvicted,      // driver: frame beacon terlama digusur frame baru (kelas penuh)
+    TxAgedFirst,         // driver: kepala antrean yang menua didahulukan dari kelas lebih tinggi
+    AppMsgDrop,          // payload data untuk node ini tidak dapat slot task aplikasi
+    Count
+};
+static constexpr int STAT_COUNT = (int)Stat::Count;
+
+// Snapshot (little-endian):
+//   [magic 'L' 'S'][ver][count][node][uptime_s u32][counter u32 x count]
+static constexpr uint8_t STATS_MAGIC0 = 'L', STATS_MAGIC1 = 'S';
+static constexpr uint8_t STATS_VERSION = 1;
+static constexpr size_t  STATS_HDR_LEN = 9;
+static constexpr size_t  STATS_SNAPSHOT_LEN = STATS_HDR_LEN + 4 * STAT_COUNT;
+
+extern std::atomic<uint32_t> g_stats[STAT_COUNT];
+
+inline void statInc(Stat s, uint32_t n = 1) {
+    g_stats[(int)s].fetch_add(n, std::memory_order_relaxed);
+}
+
+inline uint32_t statGet(Stat s) {
+    return g_stats[(int)s].load(std::memory_order_relaxed);
+}
+
+// counter "maksimum" (mis. BfMaxUs)
+void        statMax(Stat s, uint32_t v);
+const char* statName(Stat s);
+void        statsReset();
+
+// tulis snapshot ke out; 0 jika cap < STATS_SNAPSHOT_LEN
+size_t      statsSnapshot(uint8_t* out, size_t cap, int nodeId);
+
+// Snapshot yang sudah didekode. Counter yang tidak dikenal (firmware lebih
+// baru) diabaikan; yang tidak ada (firmware lebih lama) bernilai 0.
+struct StatsReport {
+    int      node;
+    uint32_t uptimeS;
+    uint32_t v[STAT_COUNT];
+
+    uint32_t get(Stat s) const { return v[(int)s]; }
+};
+bool        statsDecode(const uint8_t* in, size_t len, StatsReport& out);
+
+// ringkasan satu baris (ESP_LOGI) + counter yang tidak nol (ESP_LOGD)
+void        statsLog(const StatsReport& r);
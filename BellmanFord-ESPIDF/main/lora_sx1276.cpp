@@ -1,12 +1,18 @@
 #include "lora_sx1276.h"
 #include "board.h"
+#include "lora_stats.h"
+#include "spsc_notify.h"
 
 #include "driver/spi_master.h"
 #include "driver/gpio.h"
 #include "esp_timer.h"
 #include "esp_log.h"
+#include "esp_random.h"
+#include "esp_attr.h"            // IRAM_ATTR
 #include "freertos/FreeRTOS.h"   // [PATCH] vTaskDelay
 #include "freertos/task.h"       // [PATCH] vTaskDelay
+#include "freertos/queue.h"
+#include <atomic>
 #include <cstring>
 #include <cmath>
 
@@ -17,6 +23,31 @@ static const char* TAG = "SX1276";
 #define LORA_SPI_HOST SPI2_HOST
 #endif
 
+// Prioritas task radio: di atas task routing (5) supaya FIFO cepat dikuras
+#ifndef LORA_RADIO_TASK_PRIO
+#define LORA_RADIO_TASK_PRIO 6
+#endif
+
+// Core task radio: sendirian di APP_CPU, jadi Bellman-Ford / log di task
+// routing (PRO_CPU, lihat pipeline.h) tidak pernah menunda servis DIO0
+#ifndef LORA_RADIO_CORE
+#define LORA_RADIO_CORE (portNUM_PROCESSORS > 1 ? 1 : 0)
+#endif
+
+// Transaksi SPI sampai byte data sebanyak ini (setelah alamat) dijalankan
+// polling: tanpa antrean driver, interrupt, dan ganti konteks. Burst FIFO
+// yang lebih panjang tetap lewat spi_device_transmit (core boleh tidur).
+#ifndef LORA_SPI_POLL_MAX
+#define LORA_SPI_POLL_MAX 32
+#endif
+
+// 1 = bus SPI dipegang permanen oleh SX1276 sejak sx1276_begin() (hanya
+// task radio yang bicara ke chip), jadi tiap transaksi tidak lagi
+// mengunci/melepas bus. 0 bila ada device lain di LORA_SPI_HOST.
+#ifndef LORA_SPI_HOLD_BUS
+#define LORA_SPI_HOLD_BUS 1
+#endif
+
 // ====== Register & konstanta penting ======
 static constexpr uint8_t REG_FIFO              = 0x00;
 static constexpr uint8_t REG_OP_MODE           = 0x01;
@@ -30,14 +61,21 @@ static constexpr uint8_t REG_FIFO_ADDR_PTR     = 0x0D;
 static constexpr uint8_t REG_FIFO_TX_BASE_ADDR = 0x0E;
 static constexpr uint8_t REG_FIFO_RX_BASE_ADDR = 0x0F;
 static constexpr uint8_t REG_FIFO_RX_CURRENT   = 0x10;
+static constexpr uint8_t REG_IRQ_FLAGS_MASK    = 0x11;
 static constexpr uint8_t REG_IRQ_FLAGS         = 0x12;
 static constexpr uint8_t REG_RX_NB_BYTES       = 0x13;
+static constexpr uint8_t REG_MODEM_STAT        = 0x18;
 static constexpr uint8_t REG_MODEM_CONFIG1     = 0x1D;
 static constexpr uint8_t REG_MODEM_CONFIG2     = 0x1E;
+static constexpr uint8_t REG_SYMB_TIMEOUT_LSB  = 0x1F;
 static constexpr uint8_t REG_PREAMBLE_MSB      = 0x20;
 static constexpr uint8_t REG_PREAMBLE_LSB      = 0x21;
 static constexpr uint8_t REG_PAYLOAD_LENGTH    = 0x22;
+static constexpr uint8_t REG_MAX_PAYLOAD_LENGTH = 0x23;
+static constexpr uint8_t REG_HOP_PERIOD        = 0x24;
+static constexpr uint8_t REG_FIFO_RX_BYTE_ADDR = 0x25;
 static constexpr uint8_t REG_MODEM_CONFIG3     = 0x26;
+static constexpr uint8_t REG_PKT_SNR_VALUE     = 0x19;
 static constexpr uint8_t REG_PKT_RSSI_VALUE    = 0x1A;
 static constexpr uint8_t REG_DIO_MAPPING1      = 0x40;
 static constexpr uint8_t REG_VERSION           = 0x42;
@@ -47,74 +85,184 @@ static constexpr uint8_t MODE_SLEEP            = 0x00;
 static constexpr uint8_t MODE_STDBY            = 0x01;
 static constexpr uint8_t MODE_TX               = 0x03;
 static constexpr uint8_t MODE_RX_CONTINUOUS    = 0x05;
+static constexpr uint8_t MODE_RX_SINGLE        = 0x06;
+static constexpr uint8_t MODE_CAD              = 0x07;
 
 static constexpr uint8_t IRQ_TX_DONE_MASK      = 0x08;
 static constexpr uint8_t IRQ_RX_DONE_MASK      = 0x40;
 static constexpr uint8_t IRQ_PAYLOAD_CRC_ERR   = 0x20;
+static constexpr uint8_t IRQ_RX_TIMEOUT_MASK   = 0x80;
+static constexpr uint8_t IRQ_VALID_HEADER_MASK = 0x10;
+static constexpr uint8_t IRQ_CAD_DONE_MASK     = 0x04;
+static constexpr uint8_t IRQ_CAD_DETECTED_MASK = 0x01;
+
+// DIO0 di REG_DIO_MAPPING1 bit 7..6
+static constexpr uint8_t DIO0_RX_DONE          = 0x00;
+static constexpr uint8_t DIO0_TX_DONE          = 0x40;
+static constexpr uint8_t DIO0_CAD_DONE         = 0x80;
+
+// base FIFO: TX di separuh atas, RX di separuh bawah (tetap sejak begin)
+static constexpr uint8_t FIFO_TX_BASE          = 0x80;
+static constexpr uint8_t FIFO_RX_BASE          = 0x00;
 
 static constexpr double  F_XOSC = 32e6;
 static constexpr double  FSTEP  = F_XOSC / (1 << 19); // 61.03515625 Hz
 
 // ====== SPI handle ======
 static spi_device_handle_t s_spi;
-static uint8_t s_rx_buf[256];
-static int     s_rx_len = 0;
-static int     s_rx_idx = 0;
-static int     s_last_rssi = -127;
+
+// ====== RX: ISR DIO0 -> task radio -> antrean paket ======
+// DMA SPI menulis FIFO langsung ke slot pool; antrean hanya membawa indeks
+// slot, jadi payload tidak disalin sama sekali sampai parser membacanya
+// lewat sx1276_rx_view(). Satu slot ekstra = paket yang sedang dipegang
+// aplikasi.
+struct RxPacket {
+  int64_t  time_us;     // saat RxDone (diambil di ISR)
+  int16_t  rssi;
+  int8_t   snr_x4;      // REG_PKT_SNR_VALUE (0.25 dB)
+  uint8_t  dr;          // DR tempat paket diterima
+  uint16_t len;
+  alignas(4) uint8_t data[256];   // buffer DMA RX: word-aligned, 4 x 64
+};
+
+static constexpr int RX_POOL_LEN = LORA_RX_QUEUE_LEN + 1;
+static_assert(RX_POOL_LEN <= 255, "indeks slot RX dikirim sebagai uint8_t");
+
+// ====== TX: antrean per kelas -> task radio (TxDone via DIO0) ======
+// Frame disimpan di pool slot; antrean kelas (dan s_tx_free) hanya memuat
+// indeks slot, jadi memilih kelas cukup mengintip 1 byte. Frame disusun
+// langsung di slot (sx1276_write) dan slot itu pula yang diserahkan ke DMA
+// SPI saat TX. Pool = total kedalaman kelas + 1 (frame yang sedang menunggu
+// kanal) + 1 (frame yang sedang disusun), jadi kelas yang belum penuh
+// selalu mendapat slot.
+struct TxFrame {
+  uint8_t  dr;
+  uint8_t  prio;
+  uint16_t len;
+  int64_t  queued_us;   // masuk antrean (HOL aging)
+  alignas(4) uint8_t data[256];   // buffer DMA TX
+};
+
+static constexpr int TX_POOL_LEN = LORA_TX_QUEUE_LEN + 2;
+
+// cadangan bila edge DIO0 terlewat (mis. flag belum di-clear saat paket berikutnya)
+static constexpr uint32_t RADIO_IRQ_SAFETY_MS = 1000;
+static constexpr int64_t  TX_TIMEOUT_US       = 3 * 1000 * 1000;
+
+// Semua akses register setelah sx1276_begin() hanya dari task radio,
+// jadi SPI tidak perlu mutex.
+// RX: deskriptor = indeks slot s_rx_pool. Masing-masing ring punya tepat
+// satu produsen dan satu konsumen (task radio <-> task pemanggil
+// sx1276_wait_packet), jadi tanpa lock; pemanggil sx1276_wait_packet tidur
+// di notifikasi task sampai task radio mengisi s_rx_ready.
+static SpscNotifyRing<uint8_t, spscCapacityFor(RX_POOL_LEN)> s_rx_ready;   // task radio -> task routing
+static SpscRing<uint8_t, spscCapacityFor(RX_POOL_LEN)>       s_rx_free;    // task routing -> task radio
+static bool                       s_rx_started = false;
+static QueueHandle_t     s_tx_class[TX_PRIO_COUNT] = {};   // indeks slot per kelas
+static QueueHandle_t     s_tx_free    = nullptr;   // indeks slot TX kosong
+static TaskHandle_t      s_radio_task = nullptr;
+static volatile int64_t  s_irq_time_us = 0;
+
+static bool                  s_tx_active = false;   // radio sedang TX (milik task radio)
+static int64_t               s_tx_start_us = 0;
+static std::atomic<uint32_t> s_tx_pending{0};       // di antrean + sedang TX
+DMA_ATTR static TxFrame      s_tx_pool[TX_POOL_LEN];
+static int                   s_tx_build = -1;       // slot yang sedang disusun (task aplikasi)
+static sx1276_tx_done_cb_t   s_tx_done_cb = nullptr;
+static void*                 s_tx_done_arg = nullptr;
+
+DMA_ATTR static RxPacket s_rx_pool[RX_POOL_LEN];
+
+// paket yang sedang dibaca aplikasi (sx1276_rx_view / sx1276_read_byte)
+static int      s_rx_cur = -1;
+static int      s_rx_idx = 0;
 
 static inline void delay_ms(uint32_t ms) {
   vTaskDelay(pdMS_TO_TICKS(ms));
 }
 
+// ====== Akses register ======
+// Byte alamat dikirim di fase address transaksi (device address_bits = 8;
+// bit7: 1 = tulis, 0 = baca), jadi fase data langsung memakai buffer
+// pemanggil: tanpa buffer perantara di stack dan tanpa memcpy. Burst:
+// alamat naik otomatis tiap byte, kecuali REG_FIFO (tetap di FIFO).
+// Buffer burst harus DMA-capable dan word-aligned (slot pool, s_reg_buf,
+// s_modem_img); panjang baca kelipatan 4 supaya driver SPI tidak
+// mengalokasikan buffer bayangan. Akses 1 byte memakai buffer inline
+// spi_transaction_t.
+static inline void spi_run(spi_transaction_t& t) {
+  if (t.length <= LORA_SPI_POLL_MAX * 8) spi_device_polling_transmit(s_spi, &t);
+  else                                   spi_device_transmit(s_spi, &t);
+}
+
+// scratch DMA untuk urutan register / status (hanya task radio, dan
+// sx1276_begin sebelum task itu jalan)
+DMA_ATTR static uint8_t s_reg_buf[16];
+
 static void write_reg(uint8_t addr, uint8_t value) {
-  uint8_t tx[2] = { (uint8_t)(addr | 0x80), value };
   spi_transaction_t t{};
-  t.length = 16;
-  t.tx_buffer = tx;
-  spi_device_transmit(s_spi, &t);
+  t.flags      = SPI_TRANS_USE_TXDATA;
+  t.addr       = (uint8_t)(addr | 0x80);
+  t.length     = 8;
+  t.tx_data[0] = value;
+  spi_run(t);
 }
 
 static uint8_t read_reg(uint8_t addr) {
-  uint8_t tx[2] = { (uint8_t)(addr & 0x7F), 0x00 };
-  uint8_t rx[2] = { 0, 0 };
   spi_transaction_t t{};
-  t.length = 16;
-  t.tx_buffer = tx;
-  t.rx_buffer = rx;
-  spi_device_transmit(s_spi, &t);
-  return rx[1];
+  t.flags  = SPI_TRANS_USE_RXDATA;
+  t.addr   = (uint8_t)(addr & 0x7F);
+  t.length = 8;
+  spi_run(t);
+  return t.rx_data[0];
 }
 
-// GANTI seluruh burst_write & burst_read dengan ini:
-
 static void burst_write(uint8_t addr, const uint8_t* data, size_t len) {
+  if (!data || len == 0) return;
   if (len > 256) len = 256;
-  uint8_t buf[1 + 256];
-  buf[0] = (uint8_t)(addr | 0x80);     // bit7=1 -> write
-  if (len && data) memcpy(&buf[1], data, len);
-
   spi_transaction_t t{};
-  t.length   = (1 + len) * 8;          // alamat + payload
-  t.tx_buffer = buf;
-  spi_device_transmit(s_spi, &t);
+  t.addr      = (uint8_t)(addr | 0x80);   // bit7=1 -> write
+  t.length    = len * 8;
+  t.tx_buffer = data;
+  spi_run(t);
 }
 
+// MOSI di fase data diabaikan chip saat baca: cukup rx_buffer
 static void burst_read(uint8_t addr, uint8_t* data, size_t len) {
+  if (!data || len == 0) return;
   if (len > 256) len = 256;
-  uint8_t tx[1 + 256] = {0};
-  uint8_t rx[1 + 256] = {0};
-
-  tx[0] = (uint8_t)(addr & 0x7F);      // bit7=0 -> read
-
   spi_transaction_t t{};
-  t.length    = (1 + len) * 8;         // alamat + dummy untuk clocking data
-  t.tx_buffer = tx;
-  t.rx_buffer = rx;
-  spi_device_transmit(s_spi, &t);
+  t.addr      = (uint8_t)(addr & 0x7F);   // bit7=0 -> read
+  t.length    = len * 8;
+  t.rx_buffer = data;
+  spi_run(t);
+}
 
-  if (len && data) memcpy(data, &rx[1], len);  // lewati byte alamat
+// -------------------- Urutan register --------------------
+// Daftar (alamat, nilai) ditulis berurutan; alamat yang bersambung
+// (addr, addr+1, ...) digabung jadi satu transaksi burst.
+struct RegWrite {
+  uint8_t addr;
+  uint8_t value;
+};
+
+static void write_seq(const RegWrite* seq, size_t n) {
+  size_t i = 0;
+  while (i < n) {
+    size_t k = 0;
+    s_reg_buf[k++] = seq[i].value;
+    while (i + k < n && k < sizeof(s_reg_buf) && seq[i + k].addr == (uint8_t)(seq[i].addr + k)) {
+      s_reg_buf[k] = seq[i + k].value;
+      k++;
+    }
+    if (k == 1) write_reg(seq[i].addr, s_reg_buf[0]);
+    else        burst_write(seq[i].addr, s_reg_buf, k);
+    i += k;
+  }
 }
 
+template <size_t N>
+static inline void write_seq(const RegWrite (&seq)[N]) { write_seq(seq, N); }
 
 static void reset_chip() {
   gpio_set_direction((gpio_num_t)LORA_RST, GPIO_MODE_OUTPUT);
@@ -130,9 +278,12 @@ static void set_opmode(uint8_t mode) {
 
 static void set_frequency(uint32_t hz) {
   uint32_t frf = (uint32_t)std::llround((double)hz / FSTEP);
-  write_reg(REG_FRF_MSB, (uint8_t)(frf >> 16));
-  write_reg(REG_FRF_MID, (uint8_t)(frf >> 8));
-  write_reg(REG_FRF_LSB, (uint8_t)(frf));
+  const RegWrite seq[] = {
+    { REG_FRF_MSB, (uint8_t)(frf >> 16) },
+    { REG_FRF_MID, (uint8_t)(frf >> 8) },
+    { REG_FRF_LSB, (uint8_t)(frf) },
+  };
+  write_seq(seq);
 }
 
 static void set_tx_power(int dbm) {
@@ -143,30 +294,370 @@ static void set_tx_power(int dbm) {
   write_reg(REG_PA_CONFIG, (uint8_t)(0x80 | (p - 2))); // PA_BOOST + power
 }
 
-static void set_modem(uint8_t sf, uint32_t bw_hz) {
-  // BW map (approx): 7=125k, 8=250k, 9=500k (bit 7..4)
-  uint8_t bw;
-  if (bw_hz >= 500000) bw = 9;
-  else if (bw_hz >= 250000) bw = 8;
-  else bw = 7; // 125k default
+// konfigurasi modem DR 0 (sumber time-on-air, lihat lora_airtime.h)
+static LoraModemConfig s_modem = loraModemConfigForDr(0);
+static uint8_t         s_dr_count = 1;    // loraDrCount()
+static uint8_t         s_modem_dr = 0xFF; // DR yang sedang terpasang di register (0xFF = belum)
+
+// Register modem satu DR, 0x1D..0x26 bersambung: satu burst per ganti DR.
+// PayloadLength ikut ditulis (diisi start_tx sebelum TX); FifoRxByteAddr
+// read-only, tulisannya diabaikan chip.
+static constexpr size_t MODEM_IMG_LEN = REG_MODEM_CONFIG3 - REG_MODEM_CONFIG1 + 1;
+static constexpr size_t MODEM_IMG_PAYLOAD = REG_PAYLOAD_LENGTH - REG_MODEM_CONFIG1;
+static_assert(MODEM_IMG_LEN <= sizeof(s_reg_buf), "image modem muat scratch register");
+DMA_ATTR static uint8_t s_modem_img[LORA_DR_MAX][MODEM_IMG_LEN + 2];   // baris word-aligned
 
-  // CodingRate 4/5 (001), Header explicit, CRC on (later)
-  uint8_t mc1 = (bw << 4) | (1 << 1) | (0x00);
-  write_reg(REG_MODEM_CONFIG1, mc1);
+static void build_modem_img(const LoraModemConfig& cfg, uint8_t* img) {
+  // BW map: 7=125k, 8=250k, 9=500k (bit 7..4)
+  uint8_t bw = cfg.bw_hz >= 500000 ? 9 : (cfg.bw_hz >= 250000 ? 8 : 7);
 
-  if (sf < 6) sf = 6;
-  if (sf > 12) sf = 12;
+  // CodingRate bit 3..1 (1 = 4/5), ImplicitHeader bit 0
+  uint8_t mc1 = (uint8_t)((bw << 4) | (cfg.cr << 1) | (cfg.implicit_header ? 1 : 0));
 
-  // >>> CRC OFF: hapus (1<<2)
-  uint8_t mc2 = ((sf << 4) | 0x03);
-  write_reg(REG_MODEM_CONFIG2, mc2);
+  // SF bit 7..4, RxPayloadCrcOn bit 2, SymbTimeout bit 1..0 (MSB) + LSB.
+  // SymbTimeout hanya berlaku di RX single (pindai CAD): preamble harus
+  // terkunci dalam LORA_PREAMBLE_LEN simbol setelah CadDetected.
+  uint16_t symbTimeout = LORA_PREAMBLE_LEN + 4;
+  uint8_t mc2 = (uint8_t)((cfg.sf << 4) | (cfg.crc_on ? (1 << 2) : 0) | ((symbTimeout >> 8) & 0x03));
 
-  // LowDataRateOptimize untuk SF11/12 @BW125
   uint8_t mc3 = 0;
-  bool ldo = (bw_hz == 125000) && (sf >= 11);
-  if (ldo) mc3 |= (1 << 3); // LowDataRateOptimize
+  if (cfg.ldro) mc3 |= (1 << 3); // LowDataRateOptimize (Tsym > 16 ms)
   mc3 |= (1 << 2); // AgcAutoOn
-  write_reg(REG_MODEM_CONFIG3, mc3);
+
+  img[REG_MODEM_CONFIG1 - REG_MODEM_CONFIG1]      = mc1;
+  img[REG_MODEM_CONFIG2 - REG_MODEM_CONFIG1]      = mc2;
+  img[REG_SYMB_TIMEOUT_LSB - REG_MODEM_CONFIG1]   = (uint8_t)symbTimeout;
+  img[REG_PREAMBLE_MSB - REG_MODEM_CONFIG1]       = (uint8_t)(cfg.preamble >> 8);
+  img[REG_PREAMBLE_LSB - REG_MODEM_CONFIG1]       = (uint8_t)(cfg.preamble);
+  img[REG_PAYLOAD_LENGTH - REG_MODEM_CONFIG1]     = 0x01;   // default reset
+  img[REG_MAX_PAYLOAD_LENGTH - REG_MODEM_CONFIG1] = 0xFF;   // default reset
+  img[REG_HOP_PERIOD - REG_MODEM_CONFIG1]         = 0x00;   // FHSS mati
+  img[REG_FIFO_RX_BYTE_ADDR - REG_MODEM_CONFIG1]  = 0x00;   // read-only
+  img[REG_MODEM_CONFIG3 - REG_MODEM_CONFIG1]      = mc3;
+}
+
+// pasang DR lain (radio harus standby); payload_len >= 0 ikut mengisi
+// PayloadLength di burst yang sama. Tidak menulis register bila DR sudah
+// terpasang (kembali false).
+static bool use_dr(uint8_t dr, int payload_len = -1) {
+  if (dr == s_modem_dr) return false;
+  const uint8_t* img = s_modem_img[dr];
+  if (payload_len >= 0) {
+    memcpy(s_reg_buf, img, MODEM_IMG_LEN);
+    s_reg_buf[MODEM_IMG_PAYLOAD] = (uint8_t)payload_len;
+    img = s_reg_buf;
+  }
+  burst_write(REG_MODEM_CONFIG1, img, MODEM_IMG_LEN);
+  s_modem_dr = dr;
+  return true;
+}
+
+const LoraModemConfig& sx1276_modem_config() {
+  return s_modem;
+}
+
+// ========== Interrupt DIO0 & task radio ==========
+static void IRAM_ATTR dio0_isr(void*) {
+  s_irq_time_us = esp_timer_get_time();
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(s_radio_task, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+// Pindahkan paket dari FIFO ke antrean (flags = REG_IRQ_FLAGS yang sudah dibaca)
+static void drain_rx(uint8_t flags) {
+  if (!(flags & IRQ_RX_DONE_MASK)) return;
+
+  static constexpr uint8_t clear = IRQ_RX_DONE_MASK | IRQ_PAYLOAD_CRC_ERR;
+  uint8_t slot;
+  if (flags & IRQ_PAYLOAD_CRC_ERR) {
+    write_reg(REG_IRQ_FLAGS, clear);
+    statInc(Stat::RxCrcError);
+    return;
+  }
+  if (!s_rx_free.pop(slot)) {
+    write_reg(REG_IRQ_FLAGS, clear);
+    statInc(Stat::RxOverrun);
+    ESP_LOGW(TAG, "RX queue full, packet dropped");
+    return;
+  }
+  RxPacket& pkt = s_rx_pool[slot];
+  pkt.time_us = s_irq_time_us;
+  pkt.dr      = s_modem_dr;
+
+  // satu burst 0x10..0x1B (12 byte, kelipatan 4): alamat FIFO current,
+  // panjang, SNR (0.25 dB, signed), RSSI (HF band: -157 + pktRSSI)
+  burst_read(REG_FIFO_RX_CURRENT, s_reg_buf, 12);
+  const uint8_t* st = s_reg_buf;
+  const uint8_t cur = st[0];
+  pkt.len    = st[REG_RX_NB_BYTES - REG_FIFO_RX_CURRENT];
+  pkt.snr_x4 = (int8_t)st[REG_PKT_SNR_VALUE - REG_FIFO_RX_CURRENT];
+  pkt.rssi   = (int16_t)((int)st[REG_PKT_RSSI_VALUE - REG_FIFO_RX_CURRENT] - 157);
+
+  // satu burst 0x0D..0x12: FifoAddrPtr = awal paket, base TX/RX tetap,
+  // IrqFlagsMask 0, clear RxDone (RxCurrentAddr read-only, diabaikan)
+  const RegWrite seq[] = {
+    { REG_FIFO_ADDR_PTR,     cur },
+    { REG_FIFO_TX_BASE_ADDR, FIFO_TX_BASE },
+    { REG_FIFO_RX_BASE_ADDR, FIFO_RX_BASE },
+    { REG_FIFO_RX_CURRENT,   0x00 },
+    { REG_IRQ_FLAGS_MASK,    0x00 },
+    { REG_IRQ_FLAGS,         clear },
+  };
+  write_seq(seq);
+  // DMA langsung ke slot; dibulatkan ke kelipatan 4 (byte lebih dari FIFO
+  // tidak dipakai, pointer FIFO diset ulang tiap paket)
+  burst_read(REG_FIFO, pkt.data, (pkt.len + 3u) & ~3u);
+
+  // ring muat seluruh pool: push tidak pernah gagal (dan membangunkan
+  // task yang menunggu di sx1276_wait_packet)
+  s_rx_ready.push(slot);
+}
+
+// ====== RX multi-DR: pindai CAD (lihat ADR di lora_airtime.h) ======
+// Idle -> CAD di s_scan_dr -> (CadDetected) RX single di DR itu -> Idle.
+// CAD tanpa deteksi lanjut ke DR berikutnya; TX hanya dimulai saat Idle,
+// jadi paket yang sedang masuk tidak pernah dipotong frame sendiri.
+enum class ScanState : uint8_t { Idle, Cad, Rx };
+static ScanState s_scan       = ScanState::Idle;
+static uint8_t   s_scan_dr    = 0;
+static int64_t   s_scan_until = 0;   // batas RX single (tanpa RxTimeout di DIO0)
+
+static void start_cad() {
+  set_opmode(MODE_STDBY);
+  use_dr(s_scan_dr);
+  write_reg(REG_IRQ_FLAGS, 0xFF);
+  write_reg(REG_DIO_MAPPING1, DIO0_CAD_DONE);
+  set_opmode(MODE_CAD);
+  s_scan = ScanState::Cad;
+}
+
+static void scan_next() {
+  s_scan_dr = (uint8_t)((s_scan_dr + 1) % s_dr_count);
+  s_scan = ScanState::Idle;
+}
+
+// RX single di DR dr yang sudah terpasang (RxDone via DIO0, RxTimeout dipoll)
+static void rx_single(uint8_t dr) {
+  write_reg(REG_IRQ_FLAGS, 0xFF);
+  write_reg(REG_DIO_MAPPING1, DIO0_RX_DONE);
+  set_opmode(MODE_RX_SINGLE);
+  uint32_t tsym = loraSymbolTimeUs(loraModemConfigForDr(dr));
+  s_scan_dr    = dr;
+  s_scan_until = esp_timer_get_time() + (int64_t)(LORA_PREAMBLE_LEN + 4) * tsym + 1000;
+  s_scan       = ScanState::Rx;
+}
+
+static void scan_rx(uint8_t flags) {
+  const int64_t now = esp_timer_get_time();
+  if (s_scan == ScanState::Cad) {
+    if (!(flags & IRQ_CAD_DONE_MASK)) return;
+    if (!(flags & IRQ_CAD_DETECTED_MASK)) { scan_next(); return; }
+    rx_single(s_scan_dr);   // preamble terdeteksi: terima di DR ini
+  } else if (s_scan == ScanState::Rx) {
+    if (flags & IRQ_RX_DONE_MASK) {
+      drain_rx(flags);
+      scan_next();
+    } else if (flags & IRQ_RX_TIMEOUT_MASK) {
+      write_reg(REG_IRQ_FLAGS, IRQ_RX_TIMEOUT_MASK);   // deteksi palsu
+      scan_next();
+    } else if (flags & IRQ_VALID_HEADER_MASK) {
+      // paket sedang masuk: tunggu RxDone paling lama sepanjang frame terbesar
+      write_reg(REG_IRQ_FLAGS, IRQ_VALID_HEADER_MASK);
+      s_scan_until = now + loraTimeOnAirUs(loraModemConfigForDr(s_scan_dr), 255) + 1000;
+    } else if (now >= s_scan_until) {
+      set_opmode(MODE_STDBY);
+      scan_next();
+    }
+  }
+}
+
+// kembali menerima: RX continuous di DR 0 (map DIO0 ke RxDone); dengan
+// pindai CAD task radio memulai putaran berikutnya sendiri
+static void rx_resume() {
+  if (s_dr_count > 1) return;
+  use_dr(0);
+  write_reg(REG_DIO_MAPPING1, DIO0_RX_DONE);
+  set_opmode(MODE_RX_CONTINUOUS);
+}
+
+// ====== TX + listen-before-talk (lihat lora_sx1276.h) ======
+// Frame keluar dari antrean kelasnya saat radio idle, lalu CAD di DR
+// frame itu -> (bebas) TX, atau (sibuk) backoff sambil tetap menerima.
+static uint8_t s_tx_slot   = 0;       // slot pool frame yang dipegang task radio
+static bool    s_tx_held   = false;   // s_tx_slot menunggu kanal
+static uint8_t s_lbt_tries = 0;
+static int64_t s_lbt_until = 0;       // akhir backoff
+static bool    s_lbt_cad   = false;   // CAD LBT sedang berjalan
+
+// REG_MODEM_STAT: signal detected / synchronized / header valid
+static constexpr uint8_t MODEM_STAT_BUSY = 0x0B;
+
+static inline TxFrame& tx_frame() { return s_tx_pool[s_tx_slot]; }
+
+// frame yang dipegang sudah di FIFO / dibuang: slot kembali ke pool
+static void tx_release() {
+  s_tx_held = false;
+  xQueueSend(s_tx_free, &s_tx_slot, 0);
+}
+
+// Urutan tetap sebelum tiap TX, 0x0D..0x12 bersambung -> satu burst.
+// Base FIFO tidak pernah berubah setelah sx1276_begin(), jadi FifoAddrPtr
+// tidak perlu membaca REG_FIFO_TX_BASE_ADDR dulu.
+static constexpr RegWrite kTxSetup[] = {
+  { REG_FIFO_ADDR_PTR,     FIFO_TX_BASE },
+  { REG_FIFO_TX_BASE_ADDR, FIFO_TX_BASE },
+  { REG_FIFO_RX_BASE_ADDR, FIFO_RX_BASE },
+  { REG_FIFO_RX_CURRENT,   0x00 },        // read-only, diabaikan chip
+  { REG_IRQ_FLAGS_MASK,    0x00 },
+  { REG_IRQ_FLAGS,         0xFF },        // clear semua IRQ
+};
+
+// Mulai kirim frame yang dipegang (tidak menunggu TxDone)
+static void start_tx() {
+  const TxFrame& f = tx_frame();
+
+  // standby dulu (membatalkan RX continuous), lalu modem DR frame ini +
+  // PayloadLength dalam satu burst (atau PayloadLength saja bila DR sama)
+  set_opmode(MODE_STDBY);
+  if (!use_dr(f.dr, f.len)) write_reg(REG_PAYLOAD_LENGTH, (uint8_t)f.len);
+  // FifoAddrPtr = base TX + clear semua IRQ: satu burst (lihat kTxSetup)
+  write_seq(kTxSetup);
+  // payload ke FIFO: DMA langsung dari slot pool
+  burst_write(REG_FIFO, f.data, f.len);
+  tx_release();
+
+  // set DIO0=TxDone (01 on bits 7..6)
+  write_reg(REG_DIO_MAPPING1, DIO0_TX_DONE);
+
+  // trigger TX
+  set_opmode(MODE_TX);
+  s_tx_active = true;
+  s_tx_start_us = esp_timer_get_time();
+}
+
+// TxDone (ok) atau timeout: kembali RX dan laporkan ke aplikasi
+static void finish_tx(bool ok) {
+  if (ok) write_reg(REG_IRQ_FLAGS, IRQ_TX_DONE_MASK); // clear
+  else {
+    statInc(Stat::TxTimeout);
+    ESP_LOGW(TAG, "Tx timeout");
+  }
+
+  s_tx_active = false;
+  s_tx_pending--;
+  rx_resume();
+
+  if (s_tx_done_cb) s_tx_done_cb(ok, s_tx_done_arg);
+}
+
+// kanal sibuk: backoff, atau buang frame setelah LORA_LBT_MAX_TRIES
+static void lbt_busy() {
+  statInc(Stat::TxLbtBusy);
+  if (++s_lbt_tries <= LORA_LBT_MAX_TRIES) {
+    s_lbt_until = esp_timer_get_time() +
+                  sx1276_lbt_backoff_us(loraModemConfigForDr(tx_frame().dr), s_lbt_tries, esp_random());
+    return;
+  }
+  statInc(Stat::TxLbtDrop);
+  ESP_LOGW(TAG, "Channel busy %d times, frame dropped", LORA_LBT_MAX_TRIES);
+  tx_release();
+  s_tx_pending--;
+  if (s_tx_done_cb) s_tx_done_cb(false, s_tx_done_arg);
+}
+
+// Kelas berikutnya: kelas tertinggi yang berisi, kecuali ada kepala antrean
+// yang menunggu > LORA_TXQ_AGE_MS (yang terlama didahulukan)
+static bool tx_dequeue() {
+  const int64_t now = esp_timer_get_time();
+  int pick = -1, aged = -1;
+  int64_t aged_at = 0;
+  for (int p = 0; p < TX_PRIO_COUNT; p++) {
+    uint8_t slot;
+    if (xQueuePeek(s_tx_class[p], &slot, 0) != pdTRUE) continue;
+    if (pick < 0) pick = p;
+    int64_t at = s_tx_pool[slot].queued_us;
+    if (now - at > (int64_t)LORA_TXQ_AGE_MS * 1000 && (aged < 0 || at < aged_at)) {
+      aged    = p;
+      aged_at = at;
+    }
+  }
+  if (pick < 0) return false;
+  if (aged >= 0 && aged != pick) {
+    pick = aged;
+    statInc(Stat::TxAgedFirst);
+  }
+  // kepala beacon bisa saja baru digusur task aplikasi: ambil yang ada
+  return xQueueReceive(s_tx_class[pick], &s_tx_slot, 0) == pdTRUE;
+}
+
+// Radio idle (tidak TX / menerima): ambil frame berikutnya, lalu CAD bila
+// backoff sudah lewat
+static void tx_step() {
+  if (!s_tx_held) {
+    if (!tx_dequeue()) return;
+    s_tx_held   = true;
+    s_lbt_tries = 0;
+    s_lbt_until = 0;
+  }
+  if (!LORA_LBT_ENABLE) { start_tx(); return; }
+  if (esp_timer_get_time() < s_lbt_until) return;
+
+  // RX continuous: paket yang sedang masuk tidak boleh dipotong
+  if (s_dr_count == 1 && (read_reg(REG_MODEM_STAT) & MODEM_STAT_BUSY)) {
+    lbt_busy();
+    return;
+  }
+  set_opmode(MODE_STDBY);
+  use_dr(tx_frame().dr);
+  write_reg(REG_IRQ_FLAGS, 0xFF);
+  write_reg(REG_DIO_MAPPING1, DIO0_CAD_DONE);
+  set_opmode(MODE_CAD);
+  s_lbt_cad = true;
+}
+
+static void lbt_cad_done(uint8_t flags) {
+  if (!(flags & IRQ_CAD_DONE_MASK)) return;
+  s_lbt_cad = false;
+  if (!(flags & IRQ_CAD_DETECTED_MASK)) { start_tx(); return; }
+  lbt_busy();
+  // frame yang menduduki kanal: terima (RX single di DR ini, atau RX continuous)
+  if (s_dr_count > 1) rx_single(tx_frame().dr);
+  else                rx_resume();
+}
+
+// Satu-satunya pemilik radio: RxDone -> antrean RX, antrean TX -> TX,
+// TxDone -> kembali RX. Dibangunkan oleh ISR DIO0 atau sx1276_end_packet().
+static void radio_task(void*) {
+  while (true) {
+    uint32_t wait_ms = RADIO_IRQ_SAFETY_MS;
+    if (s_tx_active) {
+      int64_t left = s_tx_start_us + TX_TIMEOUT_US - esp_timer_get_time();
+      wait_ms = left > 0 ? (uint32_t)(left / 1000) + 1 : 0;
+    } else if (s_scan == ScanState::Rx) {
+      int64_t left = s_scan_until - esp_timer_get_time();
+      wait_ms = left > 0 ? (uint32_t)(left / 1000) + 1 : 0;
+    } else if (s_tx_held && !s_lbt_cad) {
+      int64_t left = s_lbt_until - esp_timer_get_time();
+      wait_ms = left > 0 ? (uint32_t)(left / 1000) + 1 : 0;
+    }
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms));
+
+    uint8_t flags = read_reg(REG_IRQ_FLAGS);
+    if (s_tx_active) {
+      if (flags & IRQ_TX_DONE_MASK) finish_tx(true);
+      else if (esp_timer_get_time() - s_tx_start_us > TX_TIMEOUT_US) finish_tx(false);
+    } else if (s_lbt_cad) {
+      lbt_cad_done(flags);
+    } else if (s_dr_count > 1) {
+      scan_rx(flags);
+    } else {
+      drain_rx(flags);
+    }
+
+    if (!s_tx_active && !s_lbt_cad && s_scan == ScanState::Idle) tx_step();
+    if (!s_tx_active && !s_lbt_cad && s_dr_count > 1 && s_scan == ScanState::Idle) start_cad();
+  }
 }
 
 bool sx1276_begin() {
@@ -185,7 +676,11 @@ bool sx1276_begin() {
   dev.clock_speed_hz = 8 * 1000 * 1000; // 8 MHz
   dev.spics_io_num = LORA_SS;           // [PATCH] contoh JUMA: 18 (CS otomatis)
   dev.queue_size = 4;
+  dev.address_bits = 8;                 // alamat register di fase address
   ESP_ERROR_CHECK(spi_bus_add_device(LORA_SPI_HOST, &dev, &s_spi));            // [PATCH]
+#if LORA_SPI_HOLD_BUS
+  ESP_ERROR_CHECK(spi_device_acquire_bus(s_spi, portMAX_DELAY));
+#endif
 
   // DIO0 (RxDone) sebagai input
   gpio_set_direction((gpio_num_t)LORA_DIO0, GPIO_MODE_INPUT);
@@ -204,120 +699,197 @@ bool sx1276_begin() {
   set_opmode(MODE_STDBY);
 
   // base address FIFO
-  write_reg(REG_FIFO_TX_BASE_ADDR, 0x80);
-  write_reg(REG_FIFO_RX_BASE_ADDR, 0x00);
+  const RegWrite base[] = {
+    { REG_FIFO_TX_BASE_ADDR, FIFO_TX_BASE },
+    { REG_FIFO_RX_BASE_ADDR, FIFO_RX_BASE },
+  };
+  write_seq(base);
 
   set_frequency((uint32_t)LORA_FREQ_HZ);
   set_tx_power(LORA_TX_POWER_DBM);
-  set_modem(LORA_SF, (uint32_t)LORA_BW);
-
-  // preamble default
-  write_reg(REG_PREAMBLE_MSB, 0x00);
-  write_reg(REG_PREAMBLE_LSB, 0x08);
-
-  // map DIO0: RxDone(00) / TxDone(01) di bit 7..6
-  write_reg(REG_DIO_MAPPING1, 0x00); // default RxDone pada RX
+  // register modem semua DR dihitung sekali; pasang DR 0, termasuk
+  // preamble (default 8 + putaran pindai CAD bila ADR aktif)
+  s_dr_count = loraDrCount();
+  s_modem    = loraModemConfigForDr(0);
+  for (uint8_t dr = 0; dr < s_dr_count; dr++) build_modem_img(loraModemConfigForDr(dr), s_modem_img[dr]);
+  use_dr(0);
+
+  // map DIO0: RxDone(00) / TxDone(01) / CadDone(10) di bit 7..6
+  write_reg(REG_DIO_MAPPING1, DIO0_RX_DONE); // default RxDone pada RX
+
+  // antrean RX/TX + task radio + ISR DIO0 (RxDone/TxDone)
+  // slot RX kosong sebelum task radio jalan
+  for (int i = 0; i < RX_POOL_LEN; i++) s_rx_free.push((uint8_t)i);
+  s_tx_free  = xQueueCreate(TX_POOL_LEN, sizeof(uint8_t));
+  bool tx_ok = s_tx_free != nullptr;
+  for (int p = 0; p < TX_PRIO_COUNT; p++) {
+    s_tx_class[p] = xQueueCreate(sx1276_tx_depth((TxPrio)p), sizeof(uint8_t));
+    tx_ok = tx_ok && s_tx_class[p];
+  }
+  if (!tx_ok ||
+      xTaskCreatePinnedToCore(radio_task, "sx1276", 3072, nullptr, LORA_RADIO_TASK_PRIO,
+                              &s_radio_task, LORA_RADIO_CORE) != pdPASS) {
+    ESP_LOGE(TAG, "radio task/queue alloc failed");
+    return false;
+  }
+  s_rx_started = true;
+  for (int i = 0; i < TX_POOL_LEN; i++) {
+    uint8_t slot = (uint8_t)i;
+    xQueueSend(s_tx_free, &slot, 0);
+  }
+  gpio_set_intr_type((gpio_num_t)LORA_DIO0, GPIO_INTR_POSEDGE);
+  esp_err_t err = gpio_install_isr_service(0);
+  if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {   // INVALID_STATE = sudah terpasang
+    ESP_LOGE(TAG, "gpio_install_isr_service: %s", esp_err_to_name(err));
+    return false;
+  }
+  ESP_ERROR_CHECK(gpio_isr_handler_add((gpio_num_t)LORA_DIO0, dio0_isr, nullptr));
 
-  // Masuk RX continuous
-  set_opmode(MODE_RX_CONTINUOUS);
+  // Masuk RX continuous (satu DR) atau mulai pindai CAD dari task radio
+  if (s_dr_count == 1) set_opmode(MODE_RX_CONTINUOUS);
+  else xTaskNotifyGive(s_radio_task);
+  ESP_LOGI(TAG, "%u data rate(s), preamble %u, CAD scan cycle %u us", (unsigned)s_dr_count,
+           (unsigned)s_modem.preamble, (unsigned)loraScanCycleUs());
   return true;
 }
 
 // ========== TX API ==========
-static uint8_t s_txbuf[256];
-static size_t  s_txlen = 0;
+// Frame disusun langsung di slot pool (task aplikasi) yang nanti dibaca DMA
+// SPI; slot diambil di sx1276_begin_packet dan tetap dipegang sampai frame
+// diantrekan (frame yang ditolak: slot dipakai ulang frame berikutnya).
+static inline TxFrame* tx_build() {
+  return s_tx_build >= 0 ? &s_tx_pool[s_tx_build] : nullptr;
+}
 
-void sx1276_begin_packet() {
-  s_txlen = 0;
+void sx1276_begin_packet(uint8_t dr, TxPrio prio) {
+  if (s_tx_build < 0) {
+    uint8_t slot;
+    if (!s_tx_free || xQueueReceive(s_tx_free, &slot, 0) != pdTRUE) return;   // pool > total kedalaman + 1
+    s_tx_build = slot;
+  }
+  TxFrame& f = *tx_build();
+  f.dr   = dr < s_dr_count ? dr : 0;
+  f.prio = (uint8_t)prio < TX_PRIO_COUNT ? (uint8_t)prio : (uint8_t)TxPrio::Local;
+  f.len  = 0;
 }
 
 void sx1276_write(const char* data, size_t len) {
-  if (!data || len == 0) return;
-  size_t space = sizeof(s_txbuf) - s_txlen;
+  TxFrame* f = tx_build();
+  if (!f || !data || len == 0) return;
+  size_t space = sizeof(f->data) - f->len;
   if (len > space) len = space;
-  memcpy(&s_txbuf[s_txlen], data, len);
-  s_txlen += len;
+  memcpy(&f->data[f->len], data, len);
+  f->len += len;
 }
 
-void sx1276_end_packet() {
-  // standby dulu
-  set_opmode(MODE_STDBY);
-  // Tambah: clear semua IRQ biar status bersih
-  write_reg(REG_IRQ_FLAGS, 0xFF);
-  // set FIFO addr TX
-  write_reg(REG_FIFO_ADDR_PTR, read_reg(REG_FIFO_TX_BASE_ADDR));
-  // tulis payload ke FIFO
-  burst_write(REG_FIFO, s_txbuf, s_txlen);
-  write_reg(REG_PAYLOAD_LENGTH, (uint8_t)s_txlen);
-
-  // set DIO0=TxDone (01 on bits 7..6)
-  write_reg(REG_DIO_MAPPING1, 0x40);
-
-  // trigger TX
-  set_opmode(MODE_TX);
-
-  // tunggu TxDone
-  uint64_t t0 = esp_timer_get_time();
-  while (true) {
-    uint8_t flags = read_reg(REG_IRQ_FLAGS);
-    if (flags & IRQ_TX_DONE_MASK) {
-      write_reg(REG_IRQ_FLAGS, IRQ_TX_DONE_MASK); // clear
-      break;
-    }
-    if ((esp_timer_get_time() - t0) > 3 * 1000 * 1000ULL) { // timeout 3s
-      ESP_LOGW(TAG, "Tx timeout");
-      break;
+// Hanya task aplikasi yang mengisi antrean kelas, jadi ruang yang dibuat
+// penggusuran tidak bisa diambil produsen lain sebelum send kedua; task
+// radio hanya mengosongkan.
+bool sx1276_end_packet() {
+  TxFrame* f = tx_build();
+  if (!f || f->len == 0) return false;
+  const TxPrio prio = (TxPrio)f->prio;
+  QueueHandle_t q = s_tx_class[f->prio];
+  uint8_t slot = (uint8_t)s_tx_build;
+  f->queued_us = esp_timer_get_time();
+  s_tx_pending++;   // sebelum kirim: task radio bisa selesai lebih dulu
+  bool queued = xQueueSend(q, &slot, 0) == pdTRUE;
+  if (!queued && sx1276_tx_drop_oldest(prio)) {
+    // benar-benar penuh: gusur beacon terlama (basi) lalu coba lagi. Bila
+    // task radio baru saja mengambil kepala antrean, receive mengambil
+    // frame berikutnya -- antrean memang penuh saat send gagal.
+    uint8_t old;
+    if (xQueueReceive(q, &old, 0) == pdTRUE) {
+      s_tx_pending--;
+      xQueueSend(s_tx_free, &old, 0);
+      statInc(Stat::TxQueueEvicted);
     }
-    vTaskDelay(pdMS_TO_TICKS(2));
+    queued = xQueueSend(q, &slot, 0) == pdTRUE;
   }
-
-  // kembali RX continuous (map DIO0 ke RxDone)
-  write_reg(REG_DIO_MAPPING1, 0x00);
-  set_opmode(MODE_RX_CONTINUOUS);
+  if (!queued) {
+    s_tx_pending--;   // slot tetap dipegang untuk frame berikutnya
+    ESP_LOGW(TAG, "TX queue %u full, frame dropped", (unsigned)f->prio);
+    return false;
+  }
+  s_tx_build = -1;
+  xTaskNotifyGive(s_radio_task);
+  return true;
 }
 
-// ========== RX API ==========
-int sx1276_parse_packet() {
-  // cek RxDone
-  uint8_t flags = read_reg(REG_IRQ_FLAGS);
-  if (!(flags & IRQ_RX_DONE_MASK)) {
-    return 0; // tidak ada paket baru
-  }
+uint32_t sx1276_tx_room(TxPrio prio) {
+  if ((int)prio >= TX_PRIO_COUNT || !s_tx_class[(int)prio]) return 0;
+  if (sx1276_tx_drop_oldest(prio)) return sx1276_tx_depth(prio);
+  return uxQueueSpacesAvailable(s_tx_class[(int)prio]);
+}
 
-  // clear RxDone
-  write_reg(REG_IRQ_FLAGS, IRQ_RX_DONE_MASK);
+uint32_t sx1276_tx_free(TxPrio prio) {
+  if ((int)prio >= TX_PRIO_COUNT || !s_tx_class[(int)prio]) return 0;
+  return uxQueueSpacesAvailable(s_tx_class[(int)prio]);
+}
 
-  // cek CRC error
-  if (flags & IRQ_PAYLOAD_CRC_ERR) {
-    // clear CRC error
-    write_reg(REG_IRQ_FLAGS, IRQ_PAYLOAD_CRC_ERR);
-    return 0;
-  }
+void sx1276_on_tx_done(sx1276_tx_done_cb_t cb, void* arg) {
+  s_tx_done_cb  = cb;
+  s_tx_done_arg = arg;
+}
 
-  // baca alamat FIFO current
-  uint8_t cur = read_reg(REG_FIFO_RX_CURRENT);
-  write_reg(REG_FIFO_ADDR_PTR, cur);
+uint32_t sx1276_tx_pending() {
+  return s_tx_pending;
+}
 
-  // panjang paket
-  uint8_t len = read_reg(REG_RX_NB_BYTES);
-  if (len > sizeof(s_rx_buf)) len = sizeof(s_rx_buf);
+// ========== RX API ==========
+static inline const RxPacket* rx_cur() {
+  return s_rx_cur >= 0 ? &s_rx_pool[s_rx_cur] : nullptr;
+}
 
-  burst_read(REG_FIFO, s_rx_buf, len);
-  s_rx_len = len;
+int sx1276_wait_packet(uint32_t timeout_ms) {
+  if (!s_rx_started) return 0;
+  // paket sebelumnya selesai diproses: slot kembali ke pool
+  if (s_rx_cur >= 0) {
+    uint8_t done = (uint8_t)s_rx_cur;
+    s_rx_cur = -1;
+    s_rx_free.push(done);
+  }
+  uint8_t slot;
+  TickType_t ticks = (timeout_ms == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+  if (!s_rx_ready.wait(slot, ticks)) return 0;   // timeout / dibangunkan task lain
+  s_rx_cur = slot;
   s_rx_idx = 0;
+  return s_rx_pool[slot].len;
+}
 
-  // RSSI (HF band: -157 + pktRSSI)
-  int pkt = (int)read_reg(REG_PKT_RSSI_VALUE);
-  s_last_rssi = pkt - 157;
+int sx1276_parse_packet() {
+  return sx1276_wait_packet(0);
+}
 
-  return s_rx_len;
+Sx1276RxView sx1276_rx_view() {
+  Sx1276RxView v{};
+  if (s_rx_cur < 0) return v;
+  RxPacket& p = s_rx_pool[s_rx_cur];
+  v.data    = p.data;
+  v.len     = p.len;
+  v.rssi    = p.rssi;
+  v.snr_x4  = p.snr_x4;
+  v.time_us = p.time_us;
+  v.dr      = p.dr;
+  return v;
 }
 
 int sx1276_read_byte() {
-  if (s_rx_idx >= s_rx_len) return -1;
-  return (int)s_rx_buf[s_rx_idx++];
+  const RxPacket* p = rx_cur();
+  if (!p || s_rx_idx >= p->len) return -1;
+  return (int)p->data[s_rx_idx++];
 }
 
 int sx1276_packet_rssi() {
-  return s_last_rssi;
+  const RxPacket* p = rx_cur();
+  return p ? p->rssi : -127;
+}
+
+int64_t sx1276_packet_time_us() {
+  const RxPacket* p = rx_cur();
+  return p ? p->time_us : 0;
+}
+
+uint32_t sx1276_rx_dropped() {
+  return statGet(Stat::RxOverrun);
 }
@@ -2,6 +2,8 @@
 #include <cstdint>
 #include <cstddef>
 
+#include "lora_airtime.h"
+
 // Konfigurasi diambil dari board.h:
 //  - LORA_SS   (CS/NSS)
 //  - LORA_RST  (reset pin)
@@ -11,16 +13,165 @@
 // Inisialisasi radio -> true jika sukses
 bool sx1276_begin();
 
-// TX buffer API sederhana (meniru Arduino LoRa)
-void sx1276_begin_packet();
+// ====== Antrean TX berprioritas ======
+// Satu antrean terbatas per kelas; task radio mengambil kepala kelas
+// tertinggi yang berisi:
+//  - Urgent: iklan triggered (penarikan rute), resync, ACK
+//  - Relay:  frame data milik node lain, termasuk kirim ulang ARQ
+//  - Local:  frame data yang berasal dari node ini
+//  - Beacon: Hello dan iklan periodik (yang berikutnya datang sendiri)
+// Kelas penuh: Beacon menggusur frame terlamanya (isinya sudah basi,
+// Stat::TxQueueEvicted), kelas lain menolak frame baru. Kepala antrean yang
+// sudah menunggu lebih dari LORA_TXQ_AGE_MS didahulukan (yang terlama
+// lebih dulu), jadi beacon tidak kelaparan di belakang trafik data.
+enum class TxPrio : uint8_t { Urgent = 0, Relay, Local, Beacon };
+static constexpr int TX_PRIO_COUNT = 4;
+
+#ifndef LORA_TXQ_LEN_URGENT
+#define LORA_TXQ_LEN_URGENT 4
+#endif
+#ifndef LORA_TXQ_LEN_RELAY
+#define LORA_TXQ_LEN_RELAY  6
+#endif
+#ifndef LORA_TXQ_LEN_LOCAL
+#define LORA_TXQ_LEN_LOCAL  4
+#endif
+#ifndef LORA_TXQ_LEN_BEACON
+#define LORA_TXQ_LEN_BEACON 4
+#endif
+#ifndef LORA_TXQ_AGE_MS
+#define LORA_TXQ_AGE_MS     5000
+#endif
+
+// total frame di semua kelas
+#define LORA_TX_QUEUE_LEN \
+  (LORA_TXQ_LEN_URGENT + LORA_TXQ_LEN_RELAY + LORA_TXQ_LEN_LOCAL + LORA_TXQ_LEN_BEACON)
+
+static_assert(LORA_TXQ_LEN_URGENT > 0 && LORA_TXQ_LEN_RELAY > 0 && LORA_TXQ_LEN_LOCAL > 0 &&
+              LORA_TXQ_LEN_BEACON > 0 && LORA_TX_QUEUE_LEN < 255, "kedalaman antrean TX");
+
+// kedalaman kelas prio
+static inline uint32_t sx1276_tx_depth(TxPrio prio) {
+  static constexpr uint32_t kDepth[TX_PRIO_COUNT] = {
+    LORA_TXQ_LEN_URGENT, LORA_TXQ_LEN_RELAY, LORA_TXQ_LEN_LOCAL, LORA_TXQ_LEN_BEACON
+  };
+  return kDepth[(int)prio];
+}
+
+// kelas yang menggusur frame terlamanya saat penuh (selain itu tail-drop)
+static inline bool sx1276_tx_drop_oldest(TxPrio prio) {
+  return prio == TxPrio::Beacon;
+}
+
+// TX buffer API sederhana (meniru Arduino LoRa). dr = data rate frame ini
+// (loraModemConfigForDr); task radio memasang modem DR itu hanya selama TX.
+// prio = kelas antrean frame ini.
+void sx1276_begin_packet(uint8_t dr = 0, TxPrio prio = TxPrio::Local);
 void sx1276_write(const char* data, size_t len);
-void sx1276_end_packet(); // blocking sampai TxDone
 
-// RX polling: kembalikan payload size jika paket baru tersedia, 0 kalau tidak ada
+// ====== TX asinkron ======
+// Frame disusun langsung di buffer DMA driver; sx1276_end_packet() hanya
+// mengantrekan slot itu ke kelasnya lalu kembali; task radio mengirim frame
+// satu per satu, menunggu TxDone (DIO0) dan otomatis kembali ke RX
+// continuous. false jika kelas penuh / frame kosong.
+bool sx1276_end_packet();
+
+// Frame yang masih diterima kelas prio tanpa ditolak (kelas drop-oldest:
+// selalu kedalaman penuh)
+uint32_t sx1276_tx_room(TxPrio prio);
+// Slot kosong kelas prio: frame yang masuk tanpa menggusur frame lain
+uint32_t sx1276_tx_free(TxPrio prio);
+
+// ====== Listen-before-talk (CAD) ======
+// Sebelum tiap frame task radio menjalankan CAD di DR frame itu; di RX
+// continuous paket yang sedang masuk (REG_MODEM_STAT) juga dihitung sibuk.
+// Kanal sibuk -> tunda acak dengan backoff eksponensial biner: 0..2^BE - 1
+// slot, BE mulai LORA_LBT_MIN_BE dan naik tiap kali sibuk sampai
+// LORA_LBT_MAX_BE; satu slot = time-on-air frame LORA_LBT_SLOT_BYTES byte di
+// DR itu. Selama menunda radio tetap menerima (frame yang membuat kanal
+// sibuk biasanya untuk kita). Setelah LORA_LBT_MAX_TRIES kali sibuk frame
+// dibuang (Stat::TxLbtDrop, callback TxDone ok=false).
+#ifndef LORA_LBT_ENABLE
+#define LORA_LBT_ENABLE     1
+#endif
+#ifndef LORA_LBT_MIN_BE
+#define LORA_LBT_MIN_BE     1
+#endif
+#ifndef LORA_LBT_MAX_BE
+#define LORA_LBT_MAX_BE     5
+#endif
+#ifndef LORA_LBT_MAX_TRIES
+#define LORA_LBT_MAX_TRIES  6
+#endif
+#ifndef LORA_LBT_SLOT_BYTES
+#define LORA_LBT_SLOT_BYTES 16
+#endif
+
+static_assert(LORA_LBT_MIN_BE <= LORA_LBT_MAX_BE && LORA_LBT_MAX_BE < 16, "LBT backoff exponent");
+
+// tunda setelah CAD sibuk ke-tries (1..) untuk frame di modem cfg (us);
+// rnd = bilangan acak (esp_random)
+static inline uint32_t sx1276_lbt_backoff_us(const LoraModemConfig& cfg, unsigned tries, uint32_t rnd) {
+  unsigned be = LORA_LBT_MIN_BE + (tries ? tries - 1 : 0);
+  if (be > LORA_LBT_MAX_BE) be = LORA_LBT_MAX_BE;
+  return (rnd & ((1u << be) - 1)) * loraTimeOnAirUs(cfg, LORA_LBT_SLOT_BYTES);
+}
+
+// Dipanggil dari task radio setiap frame selesai (ok=false: timeout TxDone,
+// atau dibuang LBT). Frame beacon yang digusur dari antrean tidak dilaporkan.
+// Callback harus singkat dan tidak boleh menyusun frame baru (buffer TX
+// milik task aplikasi).
+typedef void (*sx1276_tx_done_cb_t)(bool ok, void* arg);
+void sx1276_on_tx_done(sx1276_tx_done_cb_t cb, void* arg);
+
+// Frame di semua antrean TX + yang sedang dikirim
+uint32_t sx1276_tx_pending();
+
+// ====== RX berbasis interrupt ======
+// DIO0 (RxDone) memicu ISR -> task radio menguras FIFO ke antrean paket
+// (payload + RSSI + timestamp). Tidak ada polling REG_IRQ_FLAGS saat kanal diam.
+// Antrean = ring SPSC lock-free (spsc_ring.h): paket hanya boleh diambil
+// dari satu task (task routing).
+#ifndef LORA_RX_QUEUE_LEN
+#define LORA_RX_QUEUE_LEN 8
+#endif
+
+// Tunggu paket dari antrean maksimal timeout_ms (0 = tidak menunggu).
+// Kembalikan payload size, 0 jika timeout. Paket sebelumnya dilepas
+// (slot buffer RX kembali ke driver). Penantian memakai notifikasi task
+// pemanggil: xTaskNotifyGive() dari task lain membangunkannya lebih awal
+// (kembali 0), mis. permintaan kirim dari task aplikasi (pipeline.h).
+int  sx1276_wait_packet(uint32_t timeout_ms);
+
+// RX non-blocking (kompatibel dengan API polling lama) = sx1276_wait_packet(0)
 int  sx1276_parse_packet();
 
-// Baca byte dari buffer RX (dipanggil berulang sampai habis)
+// View paket terakhir langsung di buffer RX driver (tanpa salinan), valid
+// sampai sx1276_wait_packet()/sx1276_parse_packet() berikutnya. len = 0 jika
+// tidak ada paket. Parser memperlakukan data sebagai read-only; pemegang
+// paket boleh menulis ulang header di tempat sebelum meneruskannya (relay).
+struct Sx1276RxView {
+  uint8_t* data;
+  size_t   len;
+  int      rssi;      // dBm
+  int      snr_x4;    // SNR dalam 0.25 dB
+  int64_t  time_us;   // RxDone, esp_timer_get_time()
+  uint8_t  dr;        // data rate frame (lihat lora_airtime.h)
+};
+Sx1276RxView sx1276_rx_view();
+
+// Baca byte dari buffer RX (API lama; dipanggil berulang sampai habis)
 int  sx1276_read_byte();
 
 // RSSI paket terakhir (dBm, integer)
 int  sx1276_packet_rssi();
+
+// Waktu RxDone paket terakhir (esp_timer_get_time(), us)
+int64_t sx1276_packet_time_us();
+
+// Jumlah paket yang dibuang karena antrean RX penuh
+uint32_t sx1276_rx_dropped();
+
+// Konfigurasi modem DR 0 (SF/BW/CR/preamble/header/CRC/LDRO): RX dan frame
+// broadcast; dasar perhitungan time-on-air
+const LoraModemConfig& sx1276_modem_config();
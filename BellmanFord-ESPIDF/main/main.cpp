@@ -15,6 +15,7 @@
 #include "board.h"
 #include "LoRaRouting.h"   // deklarasi initLoRa, onDataRecv, runBellmanFord, dll.
 #include "node.h"          // deklarasi initNodes, NODE_ID, dll.
+#include "pipeline.h"      // task routing + aplikasi
 
 // ====== Helper: millis()/random() versi ESP-IDF ======
 static inline uint32_t millis() {
@@ -23,9 +24,6 @@ static inline uint32_t millis() {
 static inline void randomSeed(uint32_t seed) {
   srand(seed);
 }
-static inline uint32_t urand(uint32_t max_exclusive) {
-  return (uint32_t)(esp_random() % (max_exclusive ? max_exclusive : 1));
-}
 
 // [PATCH] — Hapus stub parser RX lama (lora_parse_packet):
 // (Dihapus seluruh fungsi yang sebelumnya mengembalikan 0 terus-menerus)
@@ -44,45 +42,15 @@ static void setup_port() {
   sendHelloMessages();
 }
 
-// ====== Port dari loop() → task FreeRTOS ======
-static void loop_task(void *arg) {
-  uint32_t tHello = 0, tRoute = 0, tBF = 0, tAging = 0;
-
-  while (true) {
-    uint32_t now = millis();
-
-    // [PATCH] — Gunakan parser RX nyata dari LoRaRouting.cpp (wrapper ke driver SX1276)
-    int packetSize = LoRa_ParsePacket();
-    if (packetSize > 0) {
-      onDataRecv(packetSize);
-    }
-
-    if (now - tHello > (uint32_t)(10000u + urand(300))) {
-      sendHelloMessages();
-      tHello = now;
-    }
-
-    if (now - tRoute > (uint32_t)(9000u + urand(3000))) {
-      sendRoutingTableId();
-      tRoute = now;
-    }
-
-    if (now - tBF > 15000u) {
-      runBellmanFord();
-      tBF = now;
-    }
-
-    if (now - tAging > 2000u) {
-      checkRoutingTableTimeout();
-      tAging = now;
-    }
-
-    vTaskDelay(pdMS_TO_TICKS(10));
-  }
+// ====== Port dari loop() → task routing + aplikasi (pipeline.h) ======
+// Konteks task aplikasi: payload data yang tujuannya node ini
+static void on_app_data(const AppMsg& msg, void* arg) {
+  (void)arg;
+  ESP_LOGI("APP", "Payload from NODE_%d: %u B", msg.peer, (unsigned)msg.len);
 }
 
 // ====== Titik masuk ESP-IDF ======
 extern "C" void app_main(void) {
   setup_port();
-  xTaskCreate(loop_task, "loop", 4096, nullptr, 5, nullptr);
+  if (!pipelineStart(on_app_data, nullptr)) abort();
 }
@@ -1,5 +1,6 @@
 #include "node.h"
 #include "LoRaRouting.h"   // untuk sendHelloMessages() & macToString()/getMacAddress() bila dibutuhkan
+#include "node_registry.h"
 #include <string>
 #include <cstdio>
 #include <cctype>
@@ -8,7 +9,7 @@
 static const char* TAG = "node";
 
 // ===============================
-//  MAC address definitions
+//  MAC address definitions (tabel bawaan registry)
 // ===============================
 const uint8_t NODE_0[6] = {0x0C, 0xB8, 0x15, 0xC3, 0x5F, 0x18};
 const uint8_t NODE_1[6] = {0xD0, 0xEF, 0x76, 0x57, 0x03, 0x40};
@@ -24,7 +25,7 @@ const uint8_t NODE_9[6] = {0x78, 0x21, 0x84, 0xDD, 0x1A, 0x64};
 // ===============================
 //  Node identity
 // ===============================
-int NODE_ID = 0;            // Ubah per-node (bisa nanti via menuconfig)
+int NODE_ID = 0;            // fallback; di-override registry dari MAC perangkat
 int DESTINATION_NODE = -1;  // Default: tidak ada tujuan
 
 // ===============================
@@ -39,9 +40,13 @@ static std::string macBytesToString(const uint8_t* mac) {
     return std::string(buf);
 }
 
-// "AA:BB:CC:DD:EE:FF" (UPPER) -> 6 byte; return false jika format salah
-static bool parseMac(const std::string& macUpper, uint8_t out[6]) {
-    if (macUpper.size() != 17) return false;
+// ===============================
+//  Mapping node_id <-> MAC (via registry, O(1))
+// ===============================
+
+// "AA:BB:CC:DD:EE:FF" (huruf besar/kecil) -> 6 byte; false jika format salah
+bool parseMac(const char* s, size_t len, uint8_t out[6]) {
+    if (len != 17) return false;
     auto hex = [](char c) -> int {
         if (c >= '0' && c <= '9') return c - '0';
         char u = (char)std::toupper((unsigned char)c);
@@ -49,9 +54,9 @@ static bool parseMac(const std::string& macUpper, uint8_t out[6]) {
         return -1;
     };
     for (int i = 0; i < 6; ++i) {
-        char hi = macUpper[i*3 + 0];
-        char lo = macUpper[i*3 + 1];
-        if (i < 5 && macUpper[i*3 + 2] != ':') return false;
+        char hi = s[i*3 + 0];
+        char lo = s[i*3 + 1];
+        if (i < 5 && s[i*3 + 2] != ':') return false;
         int h = hex(hi), l = hex(lo);
         if (h < 0 || l < 0) return false;
         out[i] = (uint8_t)((h << 4) | l);
@@ -59,50 +64,19 @@ static bool parseMac(const std::string& macUpper, uint8_t out[6]) {
     return true;
 }
 
-static bool macEqual(const uint8_t* a, const uint8_t* b) {
-    for (int i = 0; i < 6; ++i) if (a[i] != b[i]) return false;
-    return true;
+std::string nodeIdToMac(int nodeId) {
+    const uint8_t* mac = registryMac(nodeId);
+    return mac ? macBytesToString(mac) : std::string();
 }
 
-// ===============================
-//  Mapping node_id <-> MAC (string)
-// ===============================
-std::string nodeIdToMac(int nodeId) {
-    switch (nodeId) {
-        case 0: return macBytesToString(NODE_0);
-        case 1: return macBytesToString(NODE_1);
-        case 2: return macBytesToString(NODE_2);
-        case 3: return macBytesToString(NODE_3);
-        case 4: return macBytesToString(NODE_4);
-        case 5: return macBytesToString(NODE_5);
-        case 6: return macBytesToString(NODE_6);
-        case 7: return macBytesToString(NODE_7);
-        case 8: return macBytesToString(NODE_8);
-        case 9: return macBytesToString(NODE_9);
-        default: return std::string();
-    }
+int macToNodeId(const uint8_t mac[6]) {
+    return registryFind(mac);
 }
 
 int macToNodeId(const std::string& macStr) {
-    // uppercase input
-    std::string m = macStr;
-    for (auto &c : m) c = (char)std::toupper((unsigned char)c);
-
     uint8_t x[6];
-    if (!parseMac(m, x)) return -1;
-
-    if (macEqual(x, NODE_0)) return 0;
-    if (macEqual(x, NODE_1)) return 1;
-    if (macEqual(x, NODE_2)) return 2;
-    if (macEqual(x, NODE_3)) return 3;
-    if (macEqual(x, NODE_4)) return 4;
-    if (macEqual(x, NODE_5)) return 5;
-    if (macEqual(x, NODE_6)) return 6;
-    if (macEqual(x, NODE_7)) return 7;
-    if (macEqual(x, NODE_8)) return 8;
-    if (macEqual(x, NODE_9)) return 9;
-
-    return -1;
+    if (!parseMac(macStr.data(), macStr.size(), x)) return -1;
+    return registryFind(x);
 }
 
 // ===============================
@@ -110,6 +84,16 @@ int macToNodeId(const std::string& macStr) {
 // ===============================
 void initNodes() {
     ESP_LOGI(TAG, "Initializing node...");
+    registryLoad();
+
+    // identitas dari registry bila MAC perangkat terdaftar
+    int self = macToNodeId(getMacAddress());
+    if (self >= 0) {
+        NODE_ID = self;
+    } else {
+        ESP_LOGW(TAG, "Own MAC %s not in registry, keeping NODE_ID=%d",
+                 macToString(getMacAddress()).c_str(), NODE_ID);
+    }
     ESP_LOGI(TAG, "Node ID: %d", NODE_ID);
 
     // Kirim Hello awal (diimplementasi di LoRaRouting.cpp)
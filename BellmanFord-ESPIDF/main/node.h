@@ -1,8 +1,9 @@
 #pragma once
 #include <cstdint>
 #include <string>
+#include <cstddef>
 
-// ====== MAC address declarations (read-only) ======
+// ====== MAC address declarations (read-only, tabel bawaan registry) ======
 extern const uint8_t NODE_0[6];
 extern const uint8_t NODE_1[6];
 extern const uint8_t NODE_2[6];
@@ -15,7 +16,7 @@ extern const uint8_t NODE_8[6];
 extern const uint8_t NODE_9[6];
 
 // ====== Node identity ======
-extern int NODE_ID;            // set per perangkat (0..9)
+extern int NODE_ID;            // dari registry (MAC perangkat) saat initNodes()
 extern int DESTINATION_NODE;   // tujuan (opsional)
 
 // ====== Lifecycle / config ======
@@ -23,8 +24,11 @@ void initNodes();
 void setDestinationNode(int nodeId);
 
 // ====== Mapping helpers (payload berbasis node_id) ======
-int         macToNodeId(const std::string& macUpper); // "AA:BB:..." -> node_id, -1 jika tak dikenal
-std::string nodeIdToMac(int nodeId);                  // node_id -> "AA:BB:..."
+// Lookup O(1) lewat node_registry.{h,cpp}
+int         macToNodeId(const std::string& macStr);   // "AA:BB:..." -> node_id, -1 jika tak dikenal
+int         macToNodeId(const uint8_t mac[6]);        // 6 byte -> node_id, -1 jika tak dikenal
+std::string nodeIdToMac(int nodeId);                  // node_id -> "AA:BB:..." ("" jika tak dikenal)
+bool        parseMac(const char* s, size_t len, uint8_t out[6]); // teks MAC -> 6 byte
 
 // ====== Hello (diimplementasi di LoRaRouting.cpp) ======
 void sendHelloMessages();
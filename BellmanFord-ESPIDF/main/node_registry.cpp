@@ -0,0 +1,195 @@
+#include "node_registry.h"
+#include "node.h"
+
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+
+#include "esp_log.h"
+
+#if defined(ESP_PLATFORM)
+#include "nvs_flash.h"
+#include "nvs.h"
+#endif
+
+static const char* TAG = "registry";
+
+static_assert(NODE_REGISTRY_MAX <= 256, "node_id dikirim sebagai 1 byte");
+
+// ===============================
+//  Storage
+// ===============================
+// s_macs punya layout yang sama dengan blob ringkas (id * 6 byte)
+static uint8_t s_macs[NODE_REGISTRY_MAX][6];
+static bool    s_used[NODE_REGISTRY_MAX];
+static int     s_count = 0;
+
+// MAC -> id: open addressing, linear probing, ukuran 2^k >= 2x kapasitas.
+// Slot menyimpan id+1 (0 = kosong) supaya tabel valid sejak zero-init.
+static constexpr size_t INDEX_SIZE = 2 * 256;
+static constexpr size_t INDEX_MASK = INDEX_SIZE - 1;
+static uint16_t s_index[INDEX_SIZE];
+
+static inline uint32_t macHash(const uint8_t* m) {
+    uint32_t h = 2166136261u;            // FNV-1a
+    for (int i = 0; i < 6; ++i) { h ^= m[i]; h *= 16777619u; }
+    return h;
+}
+
+static inline bool macIsZero(const uint8_t* m) {
+    return (m[0] | m[1] | m[2] | m[3] | m[4] | m[5]) == 0;
+}
+
+static void indexInsert(int id) {
+    size_t slot = macHash(s_macs[id]) & INDEX_MASK;
+    while (s_index[slot] != 0) slot = (slot + 1) & INDEX_MASK;
+    s_index[slot] = (uint16_t)(id + 1);
+    s_count++;
+}
+
+static void rebuildIndex() {
+    std::memset(s_index, 0, sizeof(s_index));
+    s_count = 0;
+    for (int id = 0; id < NODE_REGISTRY_MAX; ++id) {
+        if (s_used[id]) indexInsert(id);
+    }
+}
+
+// ===============================
+//  Lookup
+// ===============================
+const uint8_t* registryMac(int id) {
+    if (id < 0 || id >= NODE_REGISTRY_MAX || !s_used[id]) return nullptr;
+    return s_macs[id];
+}
+
+int registryFind(const uint8_t mac[6]) {
+    size_t slot = macHash(mac) & INDEX_MASK;
+    while (true) {
+        int id = (int)s_index[slot] - 1;
+        if (id < 0) return -1;
+        if (std::memcmp(s_macs[id], mac, 6) == 0) return id;
+        slot = (slot + 1) & INDEX_MASK;
+    }
+}
+
+int registryCount() {
+    return s_count;
+}
+
+// ===============================
+//  Mutasi
+// ===============================
+void registryClear() {
+    std::memset(s_macs, 0, sizeof(s_macs));
+    std::memset(s_used, 0, sizeof(s_used));
+    rebuildIndex();
+}
+
+bool registrySet(int id, const uint8_t mac[6]) {
+    if (id < 0 || id >= NODE_REGISTRY_MAX || macIsZero(mac)) return false;
+    int other = registryFind(mac);
+    if (other >= 0 && other != id) return false;   // MAC ganda
+    bool replaced = s_used[id];
+    std::memcpy(s_macs[id], mac, 6);
+    s_used[id] = true;
+    if (replaced) rebuildIndex();   // MAC lama masih ada di indeks
+    else          indexInsert(id);
+    return true;
+}
+
+bool registryLoadBlob(const uint8_t* blob, size_t len) {
+    if (len % NODE_REGISTRY_BLOB_ENTRY != 0 ||
+        len > (size_t)NODE_REGISTRY_MAX * NODE_REGISTRY_BLOB_ENTRY) return false;
+    registryClear();
+    std::memcpy(s_macs, blob, len);
+    for (size_t id = 0; id < len / NODE_REGISTRY_BLOB_ENTRY; ++id) {
+        s_used[id] = !macIsZero(s_macs[id]);
+    }
+    rebuildIndex();
+    return true;
+}
+
+// ===============================
+//  Sumber tabel
+// ===============================
+static void loadDefaults() {
+    const uint8_t* defaults[] = { NODE_0, NODE_1, NODE_2, NODE_3, NODE_4,
+                                  NODE_5, NODE_6, NODE_7, NODE_8, NODE_9 };
+    registryClear();
+    for (int id = 0; id < (int)(sizeof(defaults) / sizeof(defaults[0])); ++id) {
+        registrySet(id, defaults[id]);
+    }
+}
+
+#if defined(ESP_PLATFORM)
+// blob NVS dibaca langsung ke s_macs (layout sama)
+static bool loadFromStorage() {
+    esp_err_t err = nvs_flash_init();
+    if (err != ESP_OK) {
+        // jangan erase partisi otomatis; cukup pakai tabel bawaan
+        ESP_LOGW(TAG, "nvs_flash_init: %s", esp_err_to_name(err));
+        return false;
+    }
+    nvs_handle_t h;
+    if (nvs_open("lora", NVS_READONLY, &h) != ESP_OK) return false;
+
+    registryClear();
+    size_t len = sizeof(s_macs);
+    err = nvs_get_blob(h, "registry", s_macs, &len);
+    nvs_close(h);
+    if (err != ESP_OK || len == 0 || len % NODE_REGISTRY_BLOB_ENTRY != 0) {
+        if (err != ESP_ERR_NVS_NOT_FOUND) ESP_LOGW(TAG, "NVS registry blob invalid (%s)", esp_err_to_name(err));
+        registryClear();
+        return false;
+    }
+    for (size_t id = 0; id < len / NODE_REGISTRY_BLOB_ENTRY; ++id) {
+        s_used[id] = !macIsZero(s_macs[id]);
+    }
+    rebuildIndex();
+    return true;
+}
+#else
+// host: file teks "<id> AA:BB:CC:DD:EE:FF"
+static bool loadFromStorage() {
+    const char* path = std::getenv("LORA_NODE_REGISTRY");
+    if (!path || !*path) return false;
+    FILE* f = std::fopen(path, "r");
+    if (!f) {
+        ESP_LOGW(TAG, "cannot open %s", path);
+        return false;
+    }
+    registryClear();
+    char line[128];
+    int lineNo = 0;
+    while (std::fgets(line, sizeof(line), f)) {
+        lineNo++;
+        char* p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') continue;
+
+        int id;
+        unsigned m[6];
+        if (std::sscanf(p, "%d %2x:%2x:%2x:%2x:%2x:%2x", &id,
+                        &m[0], &m[1], &m[2], &m[3], &m[4], &m[5]) != 7) {
+            ESP_LOGW(TAG, "%s:%d: malformed line", path, lineNo);
+            continue;
+        }
+        uint8_t mac[6];
+        for (int i = 0; i < 6; ++i) mac[i] = (uint8_t)m[i];
+        if (!registrySet(id, mac)) ESP_LOGW(TAG, "%s:%d: invalid/duplicate entry", path, lineNo);
+    }
+    std::fclose(f);
+    return true;
+}
+#endif
+
+int registryLoad() {
+    if (loadFromStorage() && s_count > 0) {
+        ESP_LOGI(TAG, "Node registry loaded: %d nodes", s_count);
+    } else {
+        loadDefaults();
+        ESP_LOGI(TAG, "Node registry: built-in table (%d nodes)", s_count);
+    }
+    return s_count;
+}
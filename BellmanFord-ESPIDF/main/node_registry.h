@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// ====== Registry node_id <-> MAC ======
+//
+// Pengganti tabel NODE_0..NODE_9 yang di-hardcode: dimuat saat boot dari
+// tabel ringkas, lookup O(1) dua arah (id -> MAC: array, MAC -> id: hash
+// open-addressing). Menambah node cukup dengan mengganti tabelnya.
+//
+// Format tabel ringkas (blob): MAC 6 byte berurutan, indeks = node_id,
+// MAC 00:00:00:00:00:00 = id tidak dipakai.
+//  - ESP32 : blob NVS namespace "lora", key "registry"
+//  - host  : file teks, satu node per baris "<id> AA:BB:CC:DD:EE:FF"
+//            ('#' = komentar), path dari env LORA_NODE_REGISTRY
+// Bila tidak ada tabel tersimpan, dipakai tabel bawaan NODE_0..NODE_9.
+
+#ifndef NODE_REGISTRY_MAX
+#define NODE_REGISTRY_MAX 256
+#endif
+
+static constexpr size_t NODE_REGISTRY_BLOB_ENTRY = 6;
+
+// muat tabel dari penyimpanan (NVS / file) atau tabel bawaan; kembalikan
+// jumlah node terdaftar
+int  registryLoad();
+
+// isi dari blob ringkas (lihat format di atas); registry lama dikosongkan
+bool registryLoadBlob(const uint8_t* blob, size_t len);
+
+void registryClear();
+bool registrySet(int id, const uint8_t mac[6]);   // false jika id/MAC bentrok
+
+const uint8_t* registryMac(int id);               // nullptr jika tidak terdaftar
+int            registryFind(const uint8_t mac[6]); // -1 jika tidak terdaftar
+int            registryCount();
@@ -0,0 +1,120 @@
+#include "pipeline.h"
+#include "spsc_ring.h"
+#include "LoRaRouting.h"
+#include "lora_stats.h"
+
+#include <cstring>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+
+static const char* TAG = "Pipeline";
+
+// Satu arah = pool AppMsg + ring slot terisi (produsen -> konsumen) + ring
+// slot kosong (konsumen -> produsen). Ring muat seluruh pool, jadi push
+// tidak pernah gagal; yang bisa habis hanya slot kosong.
+struct AppChannel {
+    using Ring = SpscRing<uint8_t, spscCapacityFor(APP_MSG_SLOTS)>;
+    AppMsg msg[APP_MSG_SLOTS];
+    Ring   ready;
+    Ring   free;
+
+    void init() {
+        for (int i = 0; i < APP_MSG_SLOTS; i++) free.push((uint8_t)i);
+    }
+};
+
+static AppChannel     s_toApp;     // routing -> aplikasi (data diterima)
+static AppChannel     s_toRoute;   // aplikasi -> routing (permintaan kirim)
+static TaskHandle_t   s_routeTask = nullptr;
+static TaskHandle_t   s_appTask   = nullptr;
+static AppRecvHandler s_onRecv    = nullptr;
+static void*          s_onRecvArg = nullptr;
+
+// -------------------- Task routing --------------------
+// konteks task routing (handler data LoRaRouting)
+static void deliverToApp(int srcId, const uint8_t* payload, size_t len, void*) {
+    uint8_t slot;
+    if (len > APP_MSG_MAX || !s_toApp.free.pop(slot)) {
+        statInc(Stat::AppMsgDrop);
+        ESP_LOGW(TAG, "Data from NODE_%d (%u B) dropped: app busy / too long", srcId, (unsigned)len);
+        return;
+    }
+    AppMsg& m = s_toApp.msg[slot];
+    m.peer = (int16_t)srcId;
+    m.len  = (uint16_t)len;
+    if (len) memcpy(m.data, payload, len);
+    s_toApp.ready.push(slot);
+    xTaskNotifyGive(s_appTask);
+}
+
+static void runAppSends() {
+    uint8_t slot;
+    while (s_toRoute.ready.pop(slot)) {
+        const AppMsg& m = s_toRoute.msg[slot];
+        sendData(m.peer, m.data, m.len);
+        s_toRoute.free.push(slot);
+    }
+}
+
+// Tidak ada polling 10 ms: task tidur di antrean RX (diisi task radio dari
+// ISR DIO0) sampai paket masuk, timer periodik berikutnya jatuh tempo, atau
+// task aplikasi meminta kirim.
+static void routing_task(void*) {
+    while (true) {
+        uint32_t waitMs = runPeriodicTasks();
+        runAppSends();
+
+        int packetSize = LoRa_WaitPacket(waitMs);
+        if (packetSize > 0) onDataRecv(packetSize);
+    }
+}
+
+// -------------------- Task aplikasi --------------------
+static void app_task(void*) {
+    uint8_t slot;
+    while (true) {
+        if (!s_toApp.ready.pop(slot)) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        if (s_onRecv) s_onRecv(s_toApp.msg[slot], s_onRecvArg);
+        s_toApp.free.push(slot);
+    }
+}
+
+bool appSend(int destId, const void* payload, size_t len) {
+    uint8_t slot;
+    if (len > APP_MSG_MAX || !s_routeTask || !s_toRoute.free.pop(slot)) return false;
+    AppMsg& m = s_toRoute.msg[slot];
+    m.peer = (int16_t)destId;
+    m.len  = (uint16_t)len;
+    if (len) memcpy(m.data, payload, len);
+    s_toRoute.ready.push(slot);
+    xTaskNotifyGive(s_routeTask);
+    return true;
+}
+
+bool pipelineStart(AppRecvHandler onRecv, void* arg) {
+    s_onRecv    = onRecv;
+    s_onRecvArg = arg;
+    s_toApp.init();
+    s_toRoute.init();
+
+    // task aplikasi dulu: handler data sudah punya tujuan saat routing jalan
+    if (xTaskCreatePinnedToCore(app_task, "app", APP_TASK_STACK, nullptr, APP_TASK_PRIO,
+                                &s_appTask, APP_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "app task alloc failed");
+        return false;
+    }
+    setDataRecvHandler(deliverToApp, nullptr);
+    if (xTaskCreatePinnedToCore(routing_task, "routing", ROUTING_TASK_STACK, nullptr, ROUTING_TASK_PRIO,
+                                &s_routeTask, ROUTING_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "routing task alloc failed");
+        return false;
+    }
+    ESP_LOGI(TAG, "routing task on core %d (prio %d), app task on core %d (prio %d)",
+             ROUTING_TASK_CORE, ROUTING_TASK_PRIO, APP_TASK_CORE, APP_TASK_PRIO);
+    return true;
+}
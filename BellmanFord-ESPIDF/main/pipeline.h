@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// ====== Pipeline task: radio / routing / aplikasi ======
+//
+//  APP_CPU (1): task radio (lora_sx1276.cpp, LORA_RADIO_CORE) sendirian:
+//               servis DIO0, FIFO, CAD/LBT, TX
+//  PRO_CPU (0): task routing: parse RX, Bellman-Ford, timer Trickle, ARQ,
+//               log routing -- satu-satunya task yang menyentuh state
+//               LoRaRouting.cpp
+//               task aplikasi (prioritas lebih rendah): payload data untuk
+//               node ini + permintaan kirim
+//
+// Antar task hanya ring SPSC lock-free (spsc_ring.h) berisi indeks slot
+// pool berukuran tetap: radio <-> routing di driver (slot RX), routing <->
+// aplikasi di sini (AppMsg). Tidak ada mutex; task yang menunggu tidur di
+// notifikasi task (xTaskNotifyGive setelah push).
+
+#ifndef ROUTING_TASK_PRIO
+#define ROUTING_TASK_PRIO   5
+#endif
+#ifndef ROUTING_TASK_CORE
+#define ROUTING_TASK_CORE   0
+#endif
+#ifndef ROUTING_TASK_STACK
+#define ROUTING_TASK_STACK  4096
+#endif
+
+#ifndef APP_TASK_PRIO
+#define APP_TASK_PRIO       4
+#endif
+#ifndef APP_TASK_CORE
+#define APP_TASK_CORE       0
+#endif
+#ifndef APP_TASK_STACK
+#define APP_TASK_STACK      3072
+#endif
+
+// slot pesan per arah (routing -> aplikasi, aplikasi -> routing)
+#ifndef APP_MSG_SLOTS
+#define APP_MSG_SLOTS       4
+#endif
+// payload terpanjang satu pesan
+#ifndef APP_MSG_MAX
+#define APP_MSG_MAX         256
+#endif
+
+static_assert(APP_MSG_SLOTS > 0 && APP_MSG_SLOTS < 255, "indeks slot dikirim sebagai uint8_t");
+
+struct AppMsg {
+    int16_t  peer;              // sumber (diterima) / tujuan (dikirim)
+    uint16_t len;
+    uint8_t  data[APP_MSG_MAX];
+};
+
+// Dipanggil di task aplikasi untuk tiap payload data yang tujuannya node
+// ini; msg valid sampai handler kembali.
+typedef void (*AppRecvHandler)(const AppMsg& msg, void* arg);
+
+// Buat task routing dan aplikasi (setelah initLoRa()). false = alokasi gagal.
+bool pipelineStart(AppRecvHandler onRecv, void* arg);
+
+// Hanya dari task aplikasi (produsen tunggal ring): antrekan payload ke
+// destId, task routing mengirimnya lewat sendData(). false = payload >
+// APP_MSG_MAX atau semua slot masih menunggu. Hasil sendData() (rute,
+// jatah airtime) hanya tercatat di log / counter.
+bool appSend(int destId, const void* payload, size_t len);
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// ====== Tabel routing berukuran tetap, diindeks langsung oleh node_id ======
+//
+// Tidak ada std::string / alokasi heap: entri POD, lookup O(1) tanpa
+// perbandingan string. Ukuran ditentukan saat compile (ROUTING_MAX_NODES),
+// node_id harus < ROUTING_MAX_NODES.
+
+#ifndef ROUTING_MAX_NODES
+#define ROUTING_MAX_NODES 64
+#endif
+
+static_assert(ROUTING_MAX_NODES > 0 && ROUTING_MAX_NODES <= 256,
+              "node_id dikirim sebagai 1 byte di wire format");
+
+static constexpr int ROUTE_COST_INF = 10000;   // biaya default "tak terjangkau"
+static constexpr int LINK_SNR_UNKNOWN = -32768; // SNR paket tidak tersedia (snr_x4)
+
+struct RoutingEntry {
+    int16_t  destination = -1;            // node_id tujuan (-1 = slot kosong)
+    int16_t  nextHopId   = -1;            // node_id next hop
+    int16_t  rssi        = 0;
+    int32_t  cost        = ROUTE_COST_INF;
+    uint32_t lastUpdated = 0;             // ms
+    uint8_t  seqNo       = 0;             // nomor urut tujuan (DSDV, lihat routing_wire.h)
+    bool     feasible    = true;          // false = jalur cadangan, diiklankan sebagai ditarik
+
+    bool used() const { return destination >= 0; }
+};
+
+template <size_t MaxNodes>
+class RoutingTable {
+public:
+    static constexpr size_t kCapacity = MaxNodes;
+
+    static constexpr bool inRange(int id) { return id >= 0 && (size_t)id < MaxNodes; }
+
+    // entri yang sedang dipakai, atau nullptr
+    RoutingEntry* find(int id) {
+        return (inRange(id) && e_[id].used()) ? &e_[id] : nullptr;
+    }
+    const RoutingEntry* find(int id) const {
+        return (inRange(id) && e_[id].used()) ? &e_[id] : nullptr;
+    }
+
+    // entri untuk id (dibuat bila belum ada); nullptr jika id di luar kapasitas
+    RoutingEntry* upsert(int id) {
+        if (!inRange(id)) return nullptr;
+        if (!e_[id].used()) {
+            e_[id] = RoutingEntry{};
+            e_[id].destination = (int16_t)id;
+        }
+        return &e_[id];
+    }
+
+    void erase(int id) {
+        if (inRange(id)) e_[id] = RoutingEntry{};
+    }
+
+    // iterasi semua slot (termasuk yang kosong; cek used())
+    RoutingEntry*       begin()       { return e_; }
+    RoutingEntry*       end()         { return e_ + MaxNodes; }
+    const RoutingEntry* begin() const { return e_; }
+    const RoutingEntry* end()   const { return e_ + MaxNodes; }
+
+private:
+    RoutingEntry e_[MaxNodes];
+};
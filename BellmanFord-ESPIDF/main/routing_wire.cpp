@@ -0,0 +1,179 @@
+#include "routing_wire.h"
+
+// next hop -1 (tidak diketahui) dikodekan sebagai WIRE_NODE_NONE; penerima
+// hanya memakai next hop untuk deteksi filler, jadi ambiguitas dengan
+// node_id 255 tidak berpengaruh.
+static inline uint8_t idToWire(int id) {
+    return (id >= 0 && id <= 0xFF) ? (uint8_t)id : WIRE_NODE_NONE;
+}
+
+static inline int wireToId(uint8_t b) {
+    return b == WIRE_NODE_NONE ? -1 : (int)b;
+}
+
+WireRouteEntry WireRoutingView::entry(size_t i) const {
+    const uint8_t* p = entries + i * WIRE_ROUTING_ENTRY_LEN;
+    WireRouteEntry e;
+    e.dest    = p[0];
+    e.nextHop = wireToId(p[1]);
+    e.cost    = (int)((uint16_t)p[2] | ((uint16_t)p[3] << 8));
+    if (sequenced) {
+        e.rssi = 0;
+        e.seq  = p[4];
+    } else {
+        e.rssi = (int)(int8_t)p[4];
+    }
+    return e;
+}
+
+static inline uint16_t rdU16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline void wrU16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+bool wireDecodeRouting(const uint8_t* buf, size_t len, WireRoutingView& out) {
+    if (len < WIRE_ROUTING_HDR_LEN) return false;
+    size_t hdr;
+    switch (buf[0]) {
+        case WIRE_TYPE_ROUTING_V1:    hdr = WIRE_ROUTING_HDR_LEN; break;
+        case WIRE_TYPE_ROUTING_FULL:
+        case WIRE_TYPE_ROUTING_DELTA: hdr = WIRE_ROUTING_V2_HDR_LEN; break;
+        default:                      return false;
+    }
+    if (len < hdr || (len - hdr) % WIRE_ROUTING_ENTRY_LEN != 0) return false;
+
+    out.type      = buf[0];
+    out.sender    = buf[1];
+    out.sequenced = (hdr == WIRE_ROUTING_V2_HDR_LEN);
+    if (out.sequenced) {
+        out.seq   = rdU16(buf + 2);
+        out.base  = rdU16(buf + 4);
+        out.flags = buf[6];
+    }
+    out.entries = buf + hdr;
+    out.count   = (len - hdr) / WIRE_ROUTING_ENTRY_LEN;
+    return true;
+}
+
+bool wireDecodeResync(const uint8_t* buf, size_t len, WireResync& out) {
+    if (len != WIRE_RESYNC_LEN || buf[0] != WIRE_TYPE_ROUTING_RESYNC) return false;
+    out.requester = buf[1];
+    out.target    = buf[2];
+    out.have      = rdU16(buf + 3);
+    out.flags     = buf[5];
+    return true;
+}
+
+bool wireDecodeData(const uint8_t* buf, size_t len, WireDataView& out) {
+    if (len < WIRE_DATA_HDR_LEN || buf[0] != WIRE_TYPE_DATA) return false;
+    out.src     = buf[1];
+    out.dst     = buf[2];
+    out.nextHop = buf[WIRE_DATA_OFF_NEXT_HOP];
+    out.ttl     = buf[WIRE_DATA_OFF_TTL];
+    out.seq     = rdU16(buf + 5);
+    out.payload = buf + WIRE_DATA_HDR_LEN;
+    out.len     = len - WIRE_DATA_HDR_LEN;
+    return true;
+}
+
+bool wireDecodeFrag(const uint8_t* buf, size_t len, WireFragView& out) {
+    if (len <= WIRE_FRAG_HDR_LEN || buf[0] != WIRE_TYPE_FRAG) return false;
+    out.linkSrc = buf[1];
+    out.linkDst = wireToId(buf[2]);
+    out.id      = rdU16(buf + 3);
+    out.index   = buf[5];
+    out.count   = buf[6];
+    out.offset  = rdU16(buf + 7);
+    out.chunk   = buf + WIRE_FRAG_HDR_LEN;
+    out.len     = len - WIRE_FRAG_HDR_LEN;
+    return out.count > 0 && out.count <= WIRE_FRAG_MAX_COUNT && out.index < out.count;
+}
+
+bool wireDecodeAck(const uint8_t* buf, size_t len, WireAck& out) {
+    if (len != WIRE_ACK_LEN || buf[0] != WIRE_TYPE_ACK) return false;
+    out.from = buf[1];
+    out.src  = buf[2];
+    out.seq  = rdU16(buf + 3);
+    return true;
+}
+
+size_t wireEncodeRoutingHeader(uint8_t* out, size_t cap, int senderId) {
+    if (cap < WIRE_ROUTING_HDR_LEN || senderId < 0 || senderId > 0xFF) return 0;
+    out[0] = WIRE_TYPE_ROUTING_V1;
+    out[1] = (uint8_t)senderId;
+    return WIRE_ROUTING_HDR_LEN;
+}
+
+size_t wireEncodeRoutingHeaderV2(uint8_t* out, size_t cap, uint8_t type, int senderId,
+                                 uint16_t seq, uint16_t base, uint8_t flags) {
+    if (cap < WIRE_ROUTING_V2_HDR_LEN || senderId < 0 || senderId > 0xFF) return 0;
+    out[0] = type;
+    out[1] = (uint8_t)senderId;
+    wrU16(out + 2, seq);
+    wrU16(out + 4, base);
+    out[6] = flags;
+    return WIRE_ROUTING_V2_HDR_LEN;
+}
+
+size_t wireEncodeResync(uint8_t* out, size_t cap, const WireResync& r) {
+    if (cap < WIRE_RESYNC_LEN || r.requester < 0 || r.requester > 0xFF ||
+        r.target < 0 || r.target > 0xFF) return 0;
+    out[0] = WIRE_TYPE_ROUTING_RESYNC;
+    out[1] = (uint8_t)r.requester;
+    out[2] = (uint8_t)r.target;
+    wrU16(out + 3, r.have);
+    out[5] = r.flags;
+    return WIRE_RESYNC_LEN;
+}
+
+size_t wireEncodeDataHeader(uint8_t* out, size_t cap, int src, int dst, int nextHop,
+                            uint8_t ttl, uint16_t seq) {
+    if (cap < WIRE_DATA_HDR_LEN || src < 0 || src > 0xFF || dst < 0 || dst > 0xFF ||
+        nextHop < 0 || nextHop > 0xFF) return 0;
+    out[0] = WIRE_TYPE_DATA;
+    out[1] = (uint8_t)src;
+    out[2] = (uint8_t)dst;
+    out[WIRE_DATA_OFF_NEXT_HOP] = (uint8_t)nextHop;
+    out[WIRE_DATA_OFF_TTL]      = ttl;
+    wrU16(out + 5, seq);
+    return WIRE_DATA_HDR_LEN;
+}
+
+size_t wireEncodeFragHeader(uint8_t* out, size_t cap, int linkSrc, int linkDst, uint16_t id,
+                            uint8_t index, uint8_t count, uint16_t offset) {
+    if (cap < WIRE_FRAG_HDR_LEN || linkSrc < 0 || linkSrc > 0xFF) return 0;
+    out[0] = WIRE_TYPE_FRAG;
+    out[1] = (uint8_t)linkSrc;
+    out[2] = idToWire(linkDst);
+    wrU16(out + 3, id);
+    out[5] = index;
+    out[6] = count;
+    wrU16(out + 7, offset);
+    return WIRE_FRAG_HDR_LEN;
+}
+
+size_t wireEncodeAck(uint8_t* out, size_t cap, const WireAck& a) {
+    if (cap < WIRE_ACK_LEN || a.from < 0 || a.from > 0xFF || a.src < 0 || a.src > 0xFF) return 0;
+    out[0] = WIRE_TYPE_ACK;
+    out[1] = (uint8_t)a.from;
+    out[2] = (uint8_t)a.src;
+    wrU16(out + 3, a.seq);
+    return WIRE_ACK_LEN;
+}
+
+size_t wireEncodeRouteEntry(uint8_t* out, size_t cap, const WireRouteEntry& e) {
+    if (cap < WIRE_ROUTING_ENTRY_LEN || e.dest < 0 || e.dest > 0xFF) return 0;
+
+    int cost = e.cost < 0 ? 0 : (e.cost > 0xFFFF ? 0xFFFF : e.cost);
+    int rssi = e.rssi < -128 ? -128 : (e.rssi > 127 ? 127 : e.rssi);
+
+    out[0] = (uint8_t)e.dest;
+    out[1] = idToWire(e.nextHop);
+    wrU16(out + 2, (uint16_t)cost);
+    out[4] = e.seq >= 0 ? (uint8_t)e.seq : (uint8_t)(int8_t)rssi;
+    return WIRE_ROUTING_ENTRY_LEN;
+}
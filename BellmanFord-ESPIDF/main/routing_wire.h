@@ -0,0 +1,250 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// ====== Format biner iklan routing (pengganti teks ROUTINGID|...) ======
+//
+//  byte 0   : type  = WIRE_TYPE_ROUTING_V1 (bit7=1 -> tidak pernah ASCII)
+//  byte 1   : sender node_id
+//  byte 2.. : entri @5 byte
+//               [0] dest node_id
+//               [1] next hop node_id (WIRE_NODE_NONE = tidak diketahui)
+//               [2] cost  (u16 little-endian, dijenuhkan ke 0xFFFF)
+//               [4] rssi  (i8, dBm)
+//  node_id 0..255 (lihat NODE_REGISTRY_MAX)
+//
+// Contoh: 10 entri = 52 byte (teks ROUTINGID ~150 byte).
+// Mode teks tetap dipakai sebagai fallback selama masih terdengar tetangga
+// firmware lama (Hello tanpa token WIRE_HELLO_CAP).
+
+// 0 = selalu teks, 1 = auto (biner bila semua tetangga mendukung), 2 = selalu biner
+#ifndef ROUTING_WIRE_MODE
+#define ROUTING_WIRE_MODE 1
+#endif
+
+static constexpr uint8_t WIRE_TYPE_ROUTING_V1   = 0xA1;
+static constexpr size_t  WIRE_ROUTING_HDR_LEN   = 2;
+static constexpr size_t  WIRE_ROUTING_ENTRY_LEN = 5;
+static constexpr uint8_t WIRE_NODE_NONE         = 0xFF;
+
+// panjang frame maksimum yang diterima onDataRecv()
+static constexpr size_t  WIRE_MAX_FRAME_LEN     = 230;
+
+// ====== Iklan v2: nomor urut + delta ======
+//
+//  byte 0   : WIRE_TYPE_ROUTING_FULL / WIRE_TYPE_ROUTING_DELTA
+//  byte 1   : sender node_id
+//  byte 2-3 : seq  (u16 LE) nomor urut iklan pengirim, naik 1 per frame
+//  byte 4-5 : base (u16 LE) frame memuat SEMUA entri yang berubah dalam
+//             (base, seq]; penerima yang sudah sinkron sampai >= base boleh
+//             menerapkannya, selain itu minta resync
+//  byte 6   : flags (FIRST/LAST: batas iklan penuh yang dipecah beberapa frame)
+//  byte 7.. : entri @5 byte seperti v1, kecuali [4] = nomor urut tujuan
+//             (u8, lihat "Nomor urut tujuan" di bawah) menggantikan rssi;
+//             cost WIRE_COST_WITHDRAWN = rute ditarik
+//
+// Resync (minta pengirim mengulang perubahan sejak 'have', atau iklan penuh):
+//  [WIRE_TYPE_ROUTING_RESYNC][requester][target][have u16 LE][flags]
+static constexpr uint8_t  WIRE_TYPE_ROUTING_FULL   = 0xA2;
+static constexpr uint8_t  WIRE_TYPE_ROUTING_DELTA  = 0xA3;
+static constexpr uint8_t  WIRE_TYPE_ROUTING_RESYNC = 0xA4;
+static constexpr size_t   WIRE_ROUTING_V2_HDR_LEN  = 7;
+static constexpr size_t   WIRE_RESYNC_LEN          = 6;
+static constexpr uint8_t  WIRE_FLAG_FIRST          = 0x01;
+static constexpr uint8_t  WIRE_FLAG_LAST           = 0x02;
+static constexpr uint8_t  WIRE_RESYNC_FULL         = 0x01;   // tidak punya state: kirim penuh
+static constexpr uint16_t WIRE_COST_WITHDRAWN      = 0xFFFF;
+
+// ====== Nomor urut tujuan (DSDV) ======
+//
+// Tiap node menerbitkan nomor urut u8 GENAP untuk dirinya sendiri (token
+// Hello WIRE_HELLO_DSEQ). Iklan v2 membawa nomor urut rute per entri. Node
+// yang rutenya putus tanpa alternatif layak (distance_vector.h) menarik rute
+// dengan nomor urut GANJIL = terakhir + 1 (poisoning): lebih baru dari semua
+// rute lama, jadi penarikan menyebar ke seluruh jaringan. Tujuan yang
+// mendengar nomor urut ganjil untuk dirinya menaikkannya ke genap berikutnya.
+
+// entri maksimum per frame v2
+static constexpr size_t WIRE_V2_MAX_ENTRIES =
+    (WIRE_MAX_FRAME_LEN - WIRE_ROUTING_V2_HDR_LEN) / WIRE_ROUTING_ENTRY_LEN;
+
+// ====== Frame data multi-hop ======
+//
+//  byte 0   : WIRE_TYPE_DATA
+//  byte 1   : src      node_id pengirim asal
+//  byte 2   : dst      node_id tujuan akhir
+//  byte 3   : next hop node_id yang harus menerima / meneruskan frame ini
+//  byte 4   : ttl      dikurangi 1 tiap hop; frame dengan ttl <= 1 tidak
+//                      diteruskan lagi (pemutus loop saat rute belum konvergen)
+//  byte 5-6 : seq (u16 LE) nomor urut per src
+//  byte 7.. : payload aplikasi
+//
+// Relay hanya menulis ulang byte next hop dan ttl langsung di buffer RX
+// (wireDataRelay), payload tidak pernah disalin atau diserialisasi ulang.
+static constexpr uint8_t WIRE_TYPE_DATA          = 0xB0;
+static constexpr size_t  WIRE_DATA_HDR_LEN       = 7;
+static constexpr size_t  WIRE_DATA_OFF_NEXT_HOP  = 3;
+static constexpr size_t  WIRE_DATA_OFF_TTL       = 4;
+static constexpr size_t  WIRE_DATA_MAX_PAYLOAD   = WIRE_MAX_FRAME_LEN - WIRE_DATA_HDR_LEN;
+
+// ====== Fragmen (datagram > satu frame, lihat lora_frag.h) ======
+//
+//  byte 0   : WIRE_TYPE_FRAG
+//  byte 1   : link src  node_id pengirim frame ini (bukan originator)
+//  byte 2   : link dst  node_id penerima, WIRE_NODE_NONE = broadcast
+//  byte 3-4 : id (u16 LE) datagram, unik per link src
+//  byte 5   : index fragmen (0..count-1)
+//  byte 6   : count fragmen datagram ini
+//  byte 7-8 : offset (u16 LE) byte pertama fragmen di dalam datagram
+//  byte 9.. : potongan datagram (datagram = frame biasa: data, routing, ...)
+//
+// Fragmen berlaku per hop: penerima merakit ulang lalu memproses datagram
+// seperti frame tunggal; relay memecah ulang bila perlu.
+static constexpr uint8_t WIRE_TYPE_FRAG          = 0xB1;
+static constexpr size_t  WIRE_FRAG_HDR_LEN       = 9;
+static constexpr size_t  WIRE_FRAG_MAX_COUNT     = 64;
+
+// ====== ACK hop-by-hop (frame data unicast, lihat lora_arq.h) ======
+//
+//  byte 0   : WIRE_TYPE_ACK
+//  byte 1   : node_id pengirim ACK (next hop yang menerima frame data)
+//  byte 2   : src frame data yang di-ACK
+//  byte 3-4 : seq (u16 LE) frame data itu
+//
+// Tanpa alamat tujuan: hanya node yang menunggu ACK (pengirim, src, seq)
+// itu yang mencocokkannya; ACK selalu di DR dasar.
+static constexpr uint8_t WIRE_TYPE_ACK           = 0xB2;
+static constexpr size_t  WIRE_ACK_LEN            = 5;
+
+// token nomor urut iklan di Hello: "... WF1 AS:1234 MAC: ..." (sebelum "MAC:")
+static constexpr const char* WIRE_HELLO_SEQ = "AS:";
+
+// token nomor urut Hello itu sendiri: "... WF1 HS:17 MAC: ..." (sebelum "MAC:");
+// penerima menghitung Hello yang hilang untuk estimasi kualitas link (ETX)
+static constexpr const char* WIRE_HELLO_NUM = "HS:";
+
+// token nomor urut tujuan node pengirim: "... WF1 DS:42 MAC: ..." (sebelum "MAC:")
+static constexpr const char* WIRE_HELLO_DSEQ = "DS:";
+
+// token interval Hello pengirim (detik) selama timer Trickle-nya di atas Imin:
+// "... WF1 HI:40 MAC: ..." (sebelum "MAC:"); tanpa token = interval dasar.
+// Penerima menyesuaikan timeout tetangga (distance_vector.h)
+static constexpr const char* WIRE_HELLO_IVL = "HI:";
+
+// token data rate (ADR) yang diminta pengirim dari tetangganya untuk frame
+// unicast: "... WF1 DR:3.2,7.1 MAC: ..." (node_id.DR, sebelum "MAC:"); hanya
+// tetangga dengan DR > 0. Tetangga yang tidak tercantum memakai DR 0.
+static constexpr const char* WIRE_HELLO_DR = "DR:";
+
+// token kapabilitas ARQ di Hello: "... WF1 AK1 MAC: ..." (sebelum "MAC:");
+// frame data ke tetangga tanpa token ini dikirim sekali tanpa menunggu ACK
+static constexpr const char* WIRE_HELLO_ARQ = "AK1";
+
+// token kapabilitas di Hello: "Hello from NODE_3 WF1 MAC: ..."
+// (ditaruh sebelum "MAC:" supaya parser lama tetap membaca MAC dengan benar)
+static constexpr const char* WIRE_HELLO_CAP = "WF1";
+
+struct WireRouteEntry {
+    int dest;
+    int nextHop;   // -1 jika tidak diketahui
+    int cost;
+    int rssi;
+    int seq = -1;  // nomor urut tujuan (v2); -1 = tidak ada (v1 / teks)
+};
+
+// View read-only atas frame biner di buffer RX: tidak ada alokasi / copy,
+// entri didekode langsung dari byte aslinya.
+struct WireRoutingView {
+    uint8_t        type = 0;
+    int            sender = -1;
+    bool           sequenced = false;   // v2 (seq/base/flags valid)
+    uint16_t       seq = 0;
+    uint16_t       base = 0;
+    uint8_t        flags = 0;
+    const uint8_t* entries = nullptr;
+    size_t         count = 0;
+
+    WireRouteEntry entry(size_t i) const;
+};
+
+// View read-only atas frame data di buffer RX (payload menunjuk ke buffer)
+struct WireDataView {
+    int            src = -1;
+    int            dst = -1;
+    int            nextHop = -1;
+    uint8_t        ttl = 0;
+    uint16_t       seq = 0;
+    const uint8_t* payload = nullptr;
+    size_t         len = 0;
+};
+
+struct WireFragView {
+    int            linkSrc = -1;
+    int            linkDst = -1;     // -1 = broadcast
+    uint16_t       id = 0;
+    uint8_t        index = 0;
+    uint8_t        count = 0;
+    uint16_t       offset = 0;
+    const uint8_t* chunk = nullptr;
+    size_t         len = 0;
+};
+
+struct WireAck {
+    int      from;
+    int      src;
+    uint16_t seq;
+};
+
+struct WireResync {
+    int      requester;
+    int      target;
+    uint16_t have;
+    uint8_t  flags;
+};
+
+// frame diawali byte dengan bit7=1 -> frame biner (bukan teks)
+static inline bool wireIsBinary(const uint8_t* buf, size_t len) {
+    return len > 0 && (buf[0] & 0x80);
+}
+
+// semua tipe frame kontrol routing biner
+static inline bool wireIsRoutingType(uint8_t type) {
+    return type == WIRE_TYPE_ROUTING_V1 || type == WIRE_TYPE_ROUTING_FULL ||
+           type == WIRE_TYPE_ROUTING_DELTA || type == WIRE_TYPE_ROUTING_RESYNC;
+}
+
+// a "lebih baru" dari b (aritmetika nomor urut 16-bit, RFC 1982)
+static inline bool wireSeqAfter(uint16_t a, uint16_t b) {
+    return (int16_t)(uint16_t)(a - b) > 0;
+}
+
+// sama untuk nomor urut tujuan 8-bit
+static inline bool wireSeq8After(uint8_t a, uint8_t b) {
+    return (int8_t)(uint8_t)(a - b) > 0;
+}
+
+// true jika buf adalah iklan routing biner (v1 / v2 full / v2 delta) yang valid
+bool   wireDecodeRouting(const uint8_t* buf, size_t len, WireRoutingView& out);
+bool   wireDecodeResync(const uint8_t* buf, size_t len, WireResync& out);
+bool   wireDecodeData(const uint8_t* buf, size_t len, WireDataView& out);
+bool   wireDecodeFrag(const uint8_t* buf, size_t len, WireFragView& out);
+bool   wireDecodeAck(const uint8_t* buf, size_t len, WireAck& out);
+
+// tulis header / satu entri; kembalikan jumlah byte (0 jika tidak muat).
+// Entri dengan seq >= 0 ditulis dalam format v2 (seq menggantikan rssi).
+size_t wireEncodeRoutingHeader(uint8_t* out, size_t cap, int senderId);
+size_t wireEncodeRoutingHeaderV2(uint8_t* out, size_t cap, uint8_t type, int senderId,
+                                 uint16_t seq, uint16_t base, uint8_t flags);
+size_t wireEncodeRouteEntry(uint8_t* out, size_t cap, const WireRouteEntry& e);
+size_t wireEncodeResync(uint8_t* out, size_t cap, const WireResync& r);
+size_t wireEncodeDataHeader(uint8_t* out, size_t cap, int src, int dst, int nextHop,
+                            uint8_t ttl, uint16_t seq);
+size_t wireEncodeFragHeader(uint8_t* out, size_t cap, int linkSrc, int linkDst, uint16_t id,
+                            uint8_t index, uint8_t count, uint16_t offset);
+size_t wireEncodeAck(uint8_t* out, size_t cap, const WireAck& a);
+
+// siapkan frame data yang diterima untuk hop berikutnya, di tempat
+static inline void wireDataRelay(uint8_t* frame, int nextHop) {
+    frame[WIRE_DATA_OFF_NEXT_HOP] = (uint8_t)nextHop;
+    frame[WIRE_DATA_OFF_TTL]--;
+}
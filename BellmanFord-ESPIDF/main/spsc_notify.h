@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "spsc_ring.h"
+
+// ====== Ring SPSC dengan konsumen yang bisa tidur ======
+//
+// SpscRing + notifikasi task: konsumen yang mendapati ring kosong
+// mendaftar sebagai penunggu lalu tidur di ulTaskNotifyTake; produsen
+// memberi xTaskNotifyGive setelah push. Urutan daftar -> fence -> cek ulang
+// (konsumen) dan push -> fence -> baca penunggu (produsen) menjamin elemen
+// yang masuk saat konsumen hendak tidur tidak pernah terlewat.
+//
+// Notifikasi adalah milik task, bukan ring: task lain yang memberi
+// xTaskNotifyGive ke konsumen (mis. permintaan kirim dari task aplikasi)
+// juga membangunkannya, dan wait() kembali false tanpa elemen.
+
+template <typename T, size_t N>
+class SpscNotifyRing {
+public:
+    static constexpr size_t kCapacity = N;
+
+    // produsen: false jika penuh
+    bool push(const T& v) {
+        if (!ring_.push(v)) return false;
+        // push terlihat sebelum waiter_ dibaca (pasangan fence di wait)
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        TaskHandle_t waiter = waiter_.load(std::memory_order_relaxed);
+        if (waiter) xTaskNotifyGive(waiter);
+        return true;
+    }
+
+    // konsumen: tanpa menunggu
+    bool pop(T& out) { return ring_.pop(out); }
+
+    // konsumen: tunggu elemen maks ticks (0 = tidak menunggu). false =
+    // timeout / dibangunkan notifikasi lain.
+    bool wait(T& out, TickType_t ticks) {
+        if (ring_.pop(out)) return true;
+        if (ticks == 0) return false;
+        waiter_.store(xTaskGetCurrentTaskHandle(), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ring_.pop(out)) return true;
+        ulTaskNotifyTake(pdTRUE, ticks);
+        return ring_.pop(out);
+    }
+
+    size_t size() const { return ring_.size(); }
+    bool   empty() const { return ring_.empty(); }
+
+private:
+    SpscRing<T, N>            ring_;
+    std::atomic<TaskHandle_t> waiter_{nullptr};
+};
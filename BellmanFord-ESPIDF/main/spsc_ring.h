@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// ====== Ring buffer lock-free satu produsen / satu konsumen ======
+//
+// Penghubung antar task (atau antar pthread di host) tanpa mutex, critical
+// section, atau syscall: hanya produsen yang menulis head_, hanya konsumen
+// yang menulis tail_. Store release setelah slot ditulis / dibaca, load
+// acquire di sisi lawan, jadi isi slot selalu terlihat sebelum indeksnya.
+// Counter 32-bit boleh wrap; kapasitas N harus pangkat dua (indeks = counter
+// & mask). Elemen disalin utuh: pakai deskriptor kecil berukuran tetap
+// (mis. indeks slot pool), bukan payload.
+//
+// Tidak ada blocking di sini: konsumen yang mau tidur menunggu notifikasi
+// task (xTaskNotifyGive dari produsen setelah push).
+
+// pangkat dua terkecil >= n (kapasitas ring untuk n elemen)
+static constexpr size_t spscCapacityFor(size_t n) {
+    size_t c = 2;
+    while (c < n) c <<= 1;
+    return c;
+}
+
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "kapasitas ring harus pangkat dua");
+
+public:
+    static constexpr size_t kCapacity = N;
+
+    // produsen: false jika penuh
+    bool push(const T& v) {
+        uint32_t h = head_.load(std::memory_order_relaxed);
+        if (h - tail_.load(std::memory_order_acquire) >= N) return false;
+        buf_[h & (N - 1)] = v;
+        head_.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // konsumen: false jika kosong
+    bool pop(T& out) {
+        uint32_t t = tail_.load(std::memory_order_relaxed);
+        if (head_.load(std::memory_order_acquire) == t) return false;
+        out = buf_[t & (N - 1)];
+        tail_.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // perkiraan isi (tepat bila dipanggil produsen atau konsumen sendiri)
+    size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+
+private:
+    // head_ dan tail_ tidak berbagi baris cache: tulisan satu sisi tidak
+    // membatalkan cache sisi lain (core lain / host)
+    alignas(32) std::atomic<uint32_t> head_{0};
+    alignas(32) std::atomic<uint32_t> tail_{0};
+    T buf_[N];
+};
@@ -0,0 +1,53 @@
+#include "trickle.h"
+
+#include "esp_random.h"
+
+static void beginInterval(Trickle& t, uint32_t now) {
+    uint32_t half = t.interval / 2;
+    t.start  = now;
+    t.fireAt = now + half + (half ? esp_random() % half : 0);
+    t.heard  = 0;
+    t.fired  = false;
+}
+
+void trickleStart(Trickle& t, uint32_t now) {
+    t.interval = t.imin;
+    beginInterval(t, now);
+}
+
+void trickleReset(Trickle& t, uint32_t now) {
+    if (t.interval <= t.imin) return;
+    t.interval = t.imin;
+    beginInterval(t, now);
+}
+
+void trickleHeard(Trickle& t) {
+    if (t.heard < 0xFF) t.heard++;
+}
+
+void trickleFireBy(Trickle& t, uint32_t due) {
+    if (!t.fired && (int32_t)(due - t.fireAt) >= 0) return;
+    t.fireAt = due;
+    t.fired  = false;
+    // titik kirim di luar interval berjalan: interval diperpanjang sampai ke sana
+    if ((int32_t)(due - (t.start + t.interval)) >= 0) t.interval = due - t.start + 1;
+}
+
+TrickleEvent trickleRun(Trickle& t, uint32_t now) {
+    if (!t.fired && (int32_t)(now - t.fireAt) >= 0) {
+        t.fired = true;
+        return (t.k == 0 || t.heard < t.k) ? TrickleEvent::Send : TrickleEvent::Suppressed;
+    }
+    if ((int32_t)(now - (t.start + t.interval)) >= 0) {
+        uint32_t imax = trickleImax(t);
+        t.interval = t.interval >= imax / 2 ? imax : t.interval * 2;
+        beginInterval(t, now);
+    }
+    return TrickleEvent::None;
+}
+
+uint32_t trickleWaitMs(const Trickle& t, uint32_t now) {
+    uint32_t due = t.fired ? t.start + t.interval : t.fireAt;
+    int32_t  w   = (int32_t)(due - now);
+    return w > 0 ? (uint32_t)w : 0;
+}
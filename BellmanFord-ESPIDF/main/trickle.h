@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+
+// ====== Timer Trickle (RFC 6206) ======
+//
+// Interval I mulai dari Imin dan berlipat dua di tiap akhir interval sampai
+// Imax = Imin << doublings, selama keadaan jaringan konsisten. Di tiap
+// interval satu titik kirim diundi di [I/2, I); di titik itu pesan dikirim
+// hanya bila jumlah pesan konsisten yang terdengar di interval ini (c)
+// masih < k (k = 0: tidak pernah ditekan). Inkonsistensi mengembalikan I ke
+// Imin dan memulai interval baru, jadi reaksi terhadap perubahan tetap
+// secepat timer tetap Imin, sementara jaringan yang stabil hampir diam.
+//
+// Semua waktu dalam ms (now_ms()); aman terhadap wrap-around u32.
+
+struct Trickle {
+    // konfigurasi
+    uint32_t imin;             // ms
+    uint8_t  doublings;        // Imax = imin << doublings
+    uint8_t  k;                // ambang supresi (0 = tidak pernah ditekan)
+
+    // state
+    uint32_t interval = 0;     // I sekarang (ms)
+    uint32_t start    = 0;     // awal interval
+    uint32_t fireAt   = 0;     // titik kirim interval ini
+    uint8_t  heard    = 0;     // c
+    bool     fired    = true;  // titik kirim interval ini sudah lewat
+};
+
+enum class TrickleEvent : uint8_t { None, Send, Suppressed };
+
+// interval pertama = Imin
+void         trickleStart(Trickle& t, uint32_t now);
+
+// inkonsistensi: kembali ke Imin (tidak berbuat apa-apa bila I sudah Imin)
+void         trickleReset(Trickle& t, uint32_t now);
+
+// pesan konsisten dari tetangga terdengar (c++)
+void         trickleHeard(Trickle& t);
+
+// titik kirim interval ini paling lambat 'due' (pesan perlu keluar lebih awal)
+void         trickleFireBy(Trickle& t, uint32_t due);
+
+// Majukan timer. Send = kirim sekarang; Suppressed = titik kirim lewat tetapi
+// ditekan (c >= k). Dipanggil dari loop sampai mengembalikan None.
+TrickleEvent trickleRun(Trickle& t, uint32_t now);
+
+// ms sampai event berikutnya (titik kirim / akhir interval), 0 = sekarang
+uint32_t     trickleWaitMs(const Trickle& t, uint32_t now);
+
+static inline uint32_t trickleImax(const Trickle& t) { return t.imin << t.doublings; }
+static inline bool     trickleAtMax(const Trickle& t) { return t.interval >= trickleImax(t); }